@@ -29,6 +29,10 @@ namespace Assets
 	const std::string TextVertexShader = BasePath + "Shaders/text.vert";
 	const std::string TextFragmentShader = BasePath + "Shaders/text.frag";
 
+	const std::string SpriteBatchShaderName = "SpriteBatchShader";
+	const std::string SpriteBatchVertexShader = BasePath + "Shaders/sprite_batch.vert";
+	const std::string SpriteBatchFragmentShader = BasePath + "Shaders/sprite_batch.frag";
+
 	const std::string ParticleShaderName = "ParticleShader";
 	const std::string ParticleVertexShader = BasePath + "Shaders/particle.vert";
 	const std::string ParticleFragmentShader = BasePath + "Shaders/particle.frag";
@@ -4,9 +4,10 @@ out vec2 TexCoords;
 
 uniform mat4 model;
 uniform mat4 projection;
+uniform vec4 uvRect; // <vec2 left bottom, vec2 right top> of the sprite in its texture
 
 void main()
 {
-    TexCoords = vertex.zw;
+    TexCoords = mix(uvRect.xy, uvRect.zw, vertex.zw);
     gl_Position = projection * model * vec4(vertex.xy, 0.0, 1.0);
 }
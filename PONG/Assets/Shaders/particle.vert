@@ -1,19 +1,19 @@
 #version 330 core
 layout (location = 0) in vec4 vertex; // <vec2 position, vec2 texCoords>
+layout (location = 1) in vec4 placement; // <vec3 position, float scale>, per particle
+layout (location = 2) in vec4 color; // per particle
 
 out vec2 TexCoords;
 out vec4 ParticleColor;
 
 uniform mat4 projection;
-uniform vec3 position;
-uniform vec4 color;
-uniform float scale = 5.0f;
+uniform vec4 uvRect; // <vec2 left bottom, vec2 right top> of the particle in its texture
 
 void main()
 {
-    TexCoords = vertex.zw;
+    TexCoords = mix(uvRect.xy, uvRect.zw, vertex.zw);
     ParticleColor = color;
 
-    vec3 model = vec3(vertex.xy * scale, 0.0) + position;
+    vec3 model = vec3(vertex.xy * placement.w, 0.0) + placement.xyz;
     gl_Position = projection * vec4(model, 1.0);
 }
\ No newline at end of file
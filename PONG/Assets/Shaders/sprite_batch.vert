@@ -0,0 +1,17 @@
+#version 330 core
+layout (location = 0) in vec4 vertex; // <vec2 position, vec2 texCoords>
+layout (location = 1) in vec4 bounds; // <vec2 center, vec2 size>, per sprite
+layout (location = 2) in vec3 tint; // per sprite
+layout (location = 3) in vec4 uvRect; // <vec2 left bottom, vec2 right top> in the texture, per sprite
+
+out vec2 TexCoords;
+out vec3 SpriteColor;
+
+uniform mat4 projection;
+
+void main()
+{
+    TexCoords = mix(uvRect.xy, uvRect.zw, vertex.zw);
+    SpriteColor = tint;
+    gl_Position = projection * vec4(bounds.xy + vertex.xy * bounds.zw, 0.0, 1.0);
+}
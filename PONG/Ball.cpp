@@ -5,21 +5,28 @@
 #include "Assets.h"
 #include "Game.h"
 #include "pk/AssetManager.h"
+#include "pk/Collision.h"
 #include "pk/Common.h"
 #include "pk/SoundEngine.h"
 
 using namespace ParticlePattern;
 
+namespace
+{
+    // Upper bound of walls and paddles touched within one simulation step
+    constexpr int MAX_CONTACTS_PER_STEP = 4;
+    // Keeps the ball off a surface it just bounced on, so the next sweep does not start on it
+    constexpr float CONTACT_SKIN = 0.01f;
+}
+
 Ball::Ball(const Transform& _Transform, const glm::vec3& _Direction, const float _Speed)
 	: GameActor(_Transform), Direction(_Direction), BaseSpeed(_Speed), Speed(_Speed), SpeedIncrement(_Speed / 10.f), MaxSpeed(500.f)
 {
-    Initialize();
 }
 
 Ball::Ball(const glm::vec3& _Location, const glm::vec3 _Size, const glm::vec3& _Direction, const float _Speed)
 	: GameActor(_Location, _Size), Direction(_Direction), BaseSpeed(_Speed), Speed(_Speed), SpeedIncrement(_Speed / 10.f), MaxSpeed(500.f)
 {
-    Initialize();
 }
 
 glm::vec3 Ball::GetDirection() const
@@ -37,6 +44,11 @@ void Ball::SetMaxSpeed(const float _MaxSpeed)
     MaxSpeed = _MaxSpeed;
 }
 
+void Ball::SetBaseSpeed(const float _BaseSpeed)
+{
+    BaseSpeed = _BaseSpeed;
+}
+
 float Ball::GetSpeedIncrement() const
 {
     return SpeedIncrement;
@@ -52,11 +64,11 @@ float Ball::GetSpeed() const
 	return Speed;
 }
 
-void Ball::Bounce(const GameActor& Paddle)
+void Ball::Bounce(const GameActor& Paddle, const glm::vec3& Contact)
 {
     PlayHitSound();
 
-    glm::vec3 Location = GetLocation();
+    glm::vec3 Location = Contact;
     const BoundingBox Box = Paddle.GetBoundingBox();
 
     const glm::vec3 Difference = Location - Paddle.GetLocation();
@@ -77,7 +89,83 @@ void Ball::Bounce(const GameActor& Paddle)
     SetLocation(Location);
     IncrementSpeed();
 
-    BounceEmitter->Spawn(GetLocation(), glm::vec3(Direction.x, 0.f, 0.f));
+    if (BounceEmitter != nullptr)
+    {
+        BounceEmitter->Spawn(GetLocation(), glm::vec3(Direction.x, 0.f, 0.f));
+    }
+}
+
+void Ball::Restart(const glm::vec3& Location, const glm::vec3& _Direction)
+{
+    Teleport(Location);
+    Direction = _Direction;
+    Speed = BaseSpeed;
+
+    const uint32_t Seed = GetGame()->GetSeed();
+    if (TrailEmitter != nullptr)
+    {
+        TrailEmitter->Reset();
+        TrailEmitter->SetSeed(Seed);
+    }
+
+    if (BounceEmitter != nullptr)
+    {
+        BounceEmitter->Reset();
+        BounceEmitter->SetSeed(Seed + 1);
+    }
+}
+
+void Ball::Restore(const glm::vec3& Location, const glm::vec3& _Direction, const float _Speed)
+{
+    Teleport(Location);
+    Direction = _Direction;
+    Speed = _Speed;
+}
+
+void Ball::GetRandomStates(uint32_t& TrailState, uint32_t& BounceState) const
+{
+    TrailState = (TrailEmitter != nullptr) ? TrailEmitter->GetRandomState() : 0;
+    BounceState = (BounceEmitter != nullptr) ? BounceEmitter->GetRandomState() : 0;
+}
+
+void Ball::SetRandomStates(const uint32_t TrailState, const uint32_t BounceState)
+{
+    if (TrailEmitter != nullptr)
+    {
+        TrailEmitter->SetRandomState(TrailState);
+    }
+
+    if (BounceEmitter != nullptr)
+    {
+        BounceEmitter->SetRandomState(BounceState);
+    }
+}
+
+void Ball::SaveParticles(BallParticles& Particles) const
+{
+    Particles.bEnabled = (TrailEmitter != nullptr && BounceEmitter != nullptr) ? 1 : 0;
+    if (Particles.bEnabled == 0)
+    {
+        return;
+    }
+
+    int LastInactive = 0;
+    TrailEmitter->SaveState(Particles.Trail, LastInactive);
+    Particles.TrailLastInactive = LastInactive;
+
+    BounceEmitter->SaveState(Particles.Bounce, LastInactive);
+    Particles.BounceLastInactive = LastInactive;
+}
+
+void Ball::RestoreParticles(const BallParticles& Particles)
+{
+    if (Particles.bEnabled == 0 || TrailEmitter == nullptr || BounceEmitter == nullptr)
+    {
+        return;
+    }
+
+    TrailEmitter->RestoreState(Particles.Trail, Particles.TrailLastInactive);
+    BounceEmitter->RestoreState(Particles.Bounce, Particles.BounceLastInactive);
 }
 
 void Ball::Begin()
@@ -87,99 +175,161 @@ void Ball::Begin()
     constexpr float BounceParticleSpeed = 150.f;
     constexpr float BounceParticleLife = 0.8f;
     constexpr int BounceSpawnAmount = 3;
-    constexpr int BouncePoolCapacity = BounceSpawnAmount * 4;
+    constexpr int BouncePoolCapacity = BallParticles::BOUNCE_CAPACITY;
     constexpr float BounceParticleScale = 7.f;
 
     constexpr float TrailParticleSpeed = 0.1f;
     constexpr float TrailParticleLife = 0.5f;
     constexpr int TrailSpawnAmount = 2;
-    constexpr int TrailEmitterPoolCapacity = 1500;
+    constexpr int TrailEmitterPoolCapacity = BallParticles::TRAIL_CAPACITY;
+
+    // Headless games still simulate particles, they just never get a shader to draw them
+    Shader::SharedPtr ParticleShader = nullptr;
+    Texture::SharedPtr ParticleTexture = nullptr;
+    if (AssetManager* mAssetManager = GetGame()->GetAssetManager())
+    {
+        ParticleShader = mAssetManager->GetShader(Assets::ParticleShaderName);
+        ParticleTexture = mAssetManager->GetTexture(Assets::BallSpriteName);
+    }
+
+    if (SoundEngine* mSoundEngine = GetGame()->GetSoundEngine())
+    {
+        mSoundEngine->Load(Assets::PongSound);
+        mSoundEngine->Load(Assets::GoalSound);
+    }
 
-    AssetManager& mAssetManager = AssetManager::Get();
+    // Particles are purely cosmetic, simulations that never draw can skip them
+    if (!GetGame()->AreEffectsEnabled())
+    {
+        return;
+    }
 
     Base::SharedPtr LinearParticlePattern = std::make_shared<Linear>(TrailParticleSpeed, TrailParticleLife, TrailSpawnAmount);
-    TrailEmitter = std::make_unique<Emitter>(mAssetManager.GetShader(Assets::ParticleShaderName), mAssetManager.GetTexture(Assets::BallSpriteName),
+    TrailEmitter = std::make_unique<Emitter>(ParticleShader, ParticleTexture,
         TrailEmitterPoolCapacity, LinearParticlePattern, GetGame()->GetProjection()
     );
 
     Base::SharedPtr BouncePattern = std::make_shared<ParticlePattern::Bounce>(BounceParticleSpeed, BounceParticleLife, BounceSpawnAmount);
     BounceEmitter = std::make_unique<Emitter>(
-        mAssetManager.GetShader(Assets::ParticleShaderName), mAssetManager.GetTexture(Assets::BallSpriteName), BouncePoolCapacity, BouncePattern, GetGame()->GetProjection()
+        ParticleShader, ParticleTexture, BouncePoolCapacity, BouncePattern, GetGame()->GetProjection()
     );
     BounceEmitter->SetParticleScale(BounceParticleScale);
+
+    const uint32_t Seed = GetGame()->GetSeed();
+    TrailEmitter->SetSeed(Seed);
+    BounceEmitter->SetSeed(Seed + 1);
 }
 
 void Ball::Update(const float Delta)
 {
 	GameActor::Update(Delta);
 
-    bool bPlayerOneScored = false;
-
-    const BoundingBox Box(GetBoundingBox());
+    const BallKernel::Params Parameters = MakeKernelParams(Delta);
     glm::vec3 Location(GetLocation());
-    const float ScreenWidth = static_cast<float>(GetGame()->GetScreenWidth());
-    const float ScreenHeight = static_cast<float>(GetGame()->GetScreenHeight());
-    const glm::vec2 ScreenCenter = GetGame()->GetScreenCenter();
 
-    if ((Location.x - Box.ScaleOffset.x) <= 0.f || (Location.x + Box.ScaleOffset.x) >= ScreenWidth)
+    const uint8_t Goal = BallKernel::CheckGoal(Location.x, Location.y, Direction.x, Direction.y, Speed, Parameters);
+    if (Goal != BallKernel::NONE)
     {
-        if ((Location.x - Box.ScaleOffset.x) <= 0.f)
-            bPlayerOneScored = false;
-        if ((Location.x + Box.ScaleOffset.x) >= ScreenWidth)
-            bPlayerOneScored = true;
-
-        IncrementScore(bPlayerOneScored);
+        // Kernel already put the ball back in the middle with a fresh direction
+        IncrementScore((Goal & BallKernel::PLAYER_ONE_SCORED) != 0);
         Reset();
-        SoundEngine::Get().Play(Assets::GoalSound, 1.f);
-
-        const float x = (bPlayerOneScored) ? 1.f : -1.f;
-        Direction = glm::vec3(x, 0.8f, 0.f);
+        PlayGoalSound();
         return;
     }
 
-    // Position ball inside board and invert direction
-    const glm::vec3 Middle(ScreenCenter.x, ScreenCenter.y, 1.0f);
-    const glm::vec3 DirectionToCenter = glm::normalize(Middle - Location);
-    if ((Location.y - Box.ScaleOffset.y) <= 0.f || (Location.y + Box.ScaleOffset.y) >= ScreenHeight)
+    // Sweep the whole step, so a fast ball or a long tick can not tunnel through a paddle
+    const Player* Paddles[] = { &GetGame()->GetPlayerOne(), &GetGame()->GetPlayerTwo() };
+    const glm::vec2 HalfSize(Parameters.HalfWidth, Parameters.HalfHeight);
+
+    float Remaining = 1.f;
+    for (int Contacts = 0; Contacts < MAX_CONTACTS_PER_STEP && Remaining > 0.f; ++Contacts)
     {
-        const float Base = (Location.y - Box.ScaleOffset.y) <= 0.f ? 0.f : ScreenHeight;
-        Location.y = Base + (Box.ScaleOffset.y * glm::sign(DirectionToCenter.y));
+        const glm::vec2 Center(Location.x, Location.y);
+        const glm::vec2 Displacement = glm::vec2(glm::normalize(Direction)) * (Speed * Delta * Remaining);
+
+        Collision::SweepHit FirstHit = Collision::SweepHorizontalLine(Center, HalfSize, Displacement, 0.f, 1.f);
+        const Player* HitPaddle = nullptr;
+
+        const Collision::SweepHit BottomHit = Collision::SweepHorizontalLine(Center, HalfSize, Displacement, Parameters.ArenaHeight, -1.f);
+        if (BottomHit.bHit && (!FirstHit.bHit || BottomHit.Time < FirstHit.Time))
+        {
+            FirstHit = BottomHit;
+        }
+
+        for (const Player* Paddle : Paddles)
+        {
+            const BoundingBox Box(Paddle->GetBoundingBox());
+            const glm::vec2 PaddleCenter(Paddle->GetLocation().x, Paddle->GetLocation().y);
+            const Collision::SweepHit PaddleHit = Collision::SweepBox(Center, HalfSize, Displacement, PaddleCenter, Box.ScaleOffset);
+            if (PaddleHit.bHit && (!FirstHit.bHit || PaddleHit.Time < FirstHit.Time))
+            {
+                FirstHit = PaddleHit;
+                HitPaddle = Paddle;
+            }
+        }
+
+        if (!FirstHit.bHit)
+        {
+            Location += glm::vec3(Displacement, 0.f);
+            break;
+        }
+
+        Location += glm::vec3(Displacement * FirstHit.Time, 0.f);
+        Remaining *= (1.f - FirstHit.Time);
+
+        if (HitPaddle != nullptr && FirstHit.Normal.x != 0.f)
+        {
+            // Bounce decides the new direction from where the ball touched the paddle
+            Bounce(*HitPaddle, Location);
+            GetGame()->RegisterPaddleHit();
+            Location = GetLocation();
+            continue;
+        }
+
+        // Walls and paddle ends only flip the vertical direction
+        Location.y += FirstHit.Normal.y * CONTACT_SKIN;
         Direction.y = -Direction.y;
 
         PlayHitSound();
-        BounceEmitter->Spawn(GetLocation(), glm::vec3(0.f, Direction.y, 0.f));
+        if (BounceEmitter != nullptr)
+        {
+            BounceEmitter->Spawn(Location, glm::vec3(0.f, Direction.y, 0.f));
+        }
     }
 
-    const glm::vec3 BallVelocity = (glm::normalize(Direction) * Speed) * Delta;
-    Location += BallVelocity;
-
     SetLocation(Location);
 
-    TrailEmitter->Update(Delta, GetLocation(), -Direction);
-    BounceEmitter->Update(Delta, GetLocation(), Direction);
+    if (TrailEmitter != nullptr)
+    {
+        TrailEmitter->Update(Delta, GetLocation(), -Direction);
+        BounceEmitter->Update(Delta, GetLocation(), Direction);
+    }
 }
 
-void Ball::Render() const
+void Ball::Render(const float Alpha) const
 {
-	GameActor::Render();
-
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE);
-    TrailEmitter->Render();
-    BounceEmitter->Render();
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	GameActor::Render(Alpha);
+    RenderEffects();
 }
 
-void Ball::Initialize()
+void Ball::RenderEffects() const
 {
-    SoundEngine::Get().Load(Assets::PongSound);
-    SoundEngine::Get().Load(Assets::GoalSound);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE);
+    if (TrailEmitter != nullptr)
+    {
+        TrailEmitter->Render();
+        BounceEmitter->Render();
+    }
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 }
 
 void Ball::Reset()
 {
     const glm::vec2 ScreenCenter = GetGame()->GetScreenCenter();
 
+    // Teleport, nothing to interpolate from
     SetLocation(glm::vec3(ScreenCenter.x, ScreenCenter.y, 1.f));
+    CachePreviousLocation();
     Speed = BaseSpeed;
 
     if (TrailEmitter != nullptr)
@@ -200,10 +350,40 @@ void Ball::IncrementScore(bool bPlayerOne) const
 
 void Ball::IncrementSpeed()
 {
-    Speed = Math::Clamp(Speed + SpeedIncrement, BaseSpeed, MaxSpeed);
+    Speed = BallKernel::IncrementSpeed(Speed, MakeKernelParams(0.f));
+}
+
+BallKernel::Params Ball::MakeKernelParams(const float Delta) const
+{
+    const BoundingBox Box(GetBoundingBox());
+    const glm::vec2 ScreenCenter = GetGame()->GetScreenCenter();
+
+    BallKernel::Params Parameters;
+    Parameters.ArenaWidth = static_cast<float>(GetGame()->GetScreenWidth());
+    Parameters.ArenaHeight = static_cast<float>(GetGame()->GetScreenHeight());
+    Parameters.CenterX = ScreenCenter.x;
+    Parameters.CenterY = ScreenCenter.y;
+    Parameters.HalfWidth = Box.ScaleOffset.x;
+    Parameters.HalfHeight = Box.ScaleOffset.y;
+    Parameters.BaseSpeed = BaseSpeed;
+    Parameters.SpeedIncrement = SpeedIncrement;
+    Parameters.MaxSpeed = MaxSpeed;
+    Parameters.Delta = Delta;
+    return Parameters;
 }
 
 void Ball::PlayHitSound()
 {
-    const int Channel = SoundEngine::Get().Play(Assets::PongSound, 0.05f);
+    if (SoundEngine* mSoundEngine = GetGame()->GetSoundEngine())
+    {
+        mSoundEngine->Play(Assets::PongSound, 0.05f);
+    }
+}
+
+void Ball::PlayGoalSound()
+{
+    if (SoundEngine* mSoundEngine = GetGame()->GetSoundEngine())
+    {
+        mSoundEngine->Play(Assets::GoalSound, 1.f);
+    }
 }
@@ -1,8 +1,24 @@
 #pragma once
 
+#include "BallKernel.h"
 #include "GameActor.h"
 #include "pk/Emitter.h"
 
+// Both particle pools by value, in a fixed layout for Game::SaveState
+struct BallParticles
+{
+	static constexpr int TRAIL_CAPACITY = 1500;
+	static constexpr int BOUNCE_CAPACITY = 12;
+
+	// Zero when the ball has no emitters, the pools are then left untouched
+	int32_t bEnabled;
+	int32_t TrailLastInactive;
+	int32_t BounceLastInactive;
+	int32_t Padding;
+	Particle Trail[TRAIL_CAPACITY];
+	Particle Bounce[BOUNCE_CAPACITY];
+};
+
 class Ball : public GameActor
 {
 public:
@@ -13,25 +29,40 @@ public:
 
 	void SetSpeedIncrement(const float _Increment);
 	void SetMaxSpeed(const float _MaxSpeed);
+	// Serve speed, used from the next Restart
+	void SetBaseSpeed(const float _BaseSpeed);
 
 	float GetSpeedIncrement() const;
 	float GetMaxSpeed() const;
 	float GetSpeed() const;
 
-	void Bounce(const GameActor& Paddle);
+	// Contact is the ball location when it touched the paddle
+	void Bounce(const GameActor& Paddle, const glm::vec3& Contact);
+	void Restart(const glm::vec3& Location, const glm::vec3& _Direction);
+	// Puts the ball back in a recorded state, particles are left alone
+	void Restore(const glm::vec3& Location, const glm::vec3& _Direction, const float _Speed);
+
+	// Random generators of trail and bounce emitters, zero without effects
+	void GetRandomStates(uint32_t& TrailState, uint32_t& BounceState) const;
+	void SetRandomStates(const uint32_t TrailState, const uint32_t BounceState);
+
+	void SaveParticles(BallParticles& Particles) const;
+	void RestoreParticles(const BallParticles& Particles);
 
 	virtual void Begin() override;
 	virtual void Update(const float Delta) override;
-	virtual void Render() const override;
+	virtual void Render(const float Alpha) const override;
+	// Particles only, for when the sprite goes through a SpriteBatch
+	void RenderEffects() const;
 
 private:
-	void Initialize();
-
 	void Reset();
 	void IncrementScore(bool bPlayerOne) const;
 	void IncrementSpeed();
+	BallKernel::Params MakeKernelParams(const float Delta) const;
 
 	void PlayHitSound();
+	void PlayGoalSound();
 
 	glm::vec3 Direction;
 	float BaseSpeed;
@@ -0,0 +1,339 @@
+#include "BallKernel.h"
+
+#include <cmath>
+
+#include "pk/Common.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define PK_BALL_KERNEL_AVX2
+#elif defined(_M_X64) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define PK_BALL_KERNEL_SSE2
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define PK_BALL_KERNEL_NEON
+#endif
+
+// Scalar and SIMD paths must round the same way, a fused multiply-add would break bit equality
+#if defined(_MSC_VER) && !defined(__clang__)
+#pragma fp_contract(off)
+#elif defined(__clang__)
+#pragma STDC FP_CONTRACT OFF
+#elif defined(__GNUC__)
+#pragma GCC optimize("fp-contract=off")
+#endif
+
+namespace
+{
+	constexpr float GOAL_DIRECTION_Y = 0.8f;
+
+#if defined(PK_BALL_KERNEL_AVX2)
+	struct Lanes
+	{
+		typedef __m256 Vector;
+		static constexpr int Width = 8;
+		static constexpr const char* Name = "AVX2";
+
+		static Vector Load(const float* Data) { return _mm256_loadu_ps(Data); }
+		static void Store(float* Data, const Vector Value) { _mm256_storeu_ps(Data, Value); }
+		static Vector Set(const float Value) { return _mm256_set1_ps(Value); }
+		static Vector Add(const Vector A, const Vector B) { return _mm256_add_ps(A, B); }
+		static Vector Sub(const Vector A, const Vector B) { return _mm256_sub_ps(A, B); }
+		static Vector Mul(const Vector A, const Vector B) { return _mm256_mul_ps(A, B); }
+		static Vector Div(const Vector A, const Vector B) { return _mm256_div_ps(A, B); }
+		static Vector Sqrt(const Vector A) { return _mm256_sqrt_ps(A); }
+		static Vector Min(const Vector A, const Vector B) { return _mm256_min_ps(A, B); }
+		static Vector Max(const Vector A, const Vector B) { return _mm256_max_ps(A, B); }
+		static Vector Negate(const Vector A) { return _mm256_xor_ps(A, _mm256_set1_ps(-0.f)); }
+		static Vector LessEqual(const Vector A, const Vector B) { return _mm256_cmp_ps(A, B, _CMP_LE_OQ); }
+		static Vector GreaterEqual(const Vector A, const Vector B) { return _mm256_cmp_ps(A, B, _CMP_GE_OQ); }
+		static Vector Less(const Vector A, const Vector B) { return _mm256_cmp_ps(A, B, _CMP_LT_OQ); }
+		static Vector Greater(const Vector A, const Vector B) { return _mm256_cmp_ps(A, B, _CMP_GT_OQ); }
+		static Vector And(const Vector A, const Vector B) { return _mm256_and_ps(A, B); }
+		static Vector Or(const Vector A, const Vector B) { return _mm256_or_ps(A, B); }
+		static Vector AndNot(const Vector Mask, const Vector A) { return _mm256_andnot_ps(Mask, A); }
+		static Vector Select(const Vector Mask, const Vector A, const Vector B) { return _mm256_blendv_ps(B, A, Mask); }
+		static int Bits(const Vector Mask) { return _mm256_movemask_ps(Mask); }
+		static Vector FromBytes(const uint8_t* Data)
+		{
+			const __m256i Values = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(Data)));
+			return _mm256_castsi256_ps(_mm256_cmpgt_epi32(Values, _mm256_setzero_si256()));
+		}
+	};
+#elif defined(PK_BALL_KERNEL_SSE2)
+	struct Lanes
+	{
+		typedef __m128 Vector;
+		static constexpr int Width = 4;
+		static constexpr const char* Name = "SSE2";
+
+		static Vector Load(const float* Data) { return _mm_loadu_ps(Data); }
+		static void Store(float* Data, const Vector Value) { _mm_storeu_ps(Data, Value); }
+		static Vector Set(const float Value) { return _mm_set1_ps(Value); }
+		static Vector Add(const Vector A, const Vector B) { return _mm_add_ps(A, B); }
+		static Vector Sub(const Vector A, const Vector B) { return _mm_sub_ps(A, B); }
+		static Vector Mul(const Vector A, const Vector B) { return _mm_mul_ps(A, B); }
+		static Vector Div(const Vector A, const Vector B) { return _mm_div_ps(A, B); }
+		static Vector Sqrt(const Vector A) { return _mm_sqrt_ps(A); }
+		static Vector Min(const Vector A, const Vector B) { return _mm_min_ps(A, B); }
+		static Vector Max(const Vector A, const Vector B) { return _mm_max_ps(A, B); }
+		static Vector Negate(const Vector A) { return _mm_xor_ps(A, _mm_set1_ps(-0.f)); }
+		static Vector LessEqual(const Vector A, const Vector B) { return _mm_cmple_ps(A, B); }
+		static Vector GreaterEqual(const Vector A, const Vector B) { return _mm_cmpge_ps(A, B); }
+		static Vector Less(const Vector A, const Vector B) { return _mm_cmplt_ps(A, B); }
+		static Vector Greater(const Vector A, const Vector B) { return _mm_cmpgt_ps(A, B); }
+		static Vector And(const Vector A, const Vector B) { return _mm_and_ps(A, B); }
+		static Vector Or(const Vector A, const Vector B) { return _mm_or_ps(A, B); }
+		static Vector AndNot(const Vector Mask, const Vector A) { return _mm_andnot_ps(Mask, A); }
+		static Vector Select(const Vector Mask, const Vector A, const Vector B) { return _mm_or_ps(_mm_and_ps(Mask, A), _mm_andnot_ps(Mask, B)); }
+		static int Bits(const Vector Mask) { return _mm_movemask_ps(Mask); }
+		static Vector FromBytes(const uint8_t* Data)
+		{
+			const __m128i Values = _mm_set_epi32(Data[3], Data[2], Data[1], Data[0]);
+			return _mm_castsi128_ps(_mm_cmpgt_epi32(Values, _mm_setzero_si128()));
+		}
+	};
+#elif defined(PK_BALL_KERNEL_NEON)
+	struct Lanes
+	{
+		typedef float32x4_t Vector;
+		static constexpr int Width = 4;
+		static constexpr const char* Name = "NEON";
+
+		static Vector Load(const float* Data) { return vld1q_f32(Data); }
+		static void Store(float* Data, const Vector Value) { vst1q_f32(Data, Value); }
+		static Vector Set(const float Value) { return vdupq_n_f32(Value); }
+		static Vector Add(const Vector A, const Vector B) { return vaddq_f32(A, B); }
+		static Vector Sub(const Vector A, const Vector B) { return vsubq_f32(A, B); }
+		static Vector Mul(const Vector A, const Vector B) { return vmulq_f32(A, B); }
+		static Vector Div(const Vector A, const Vector B) { return vdivq_f32(A, B); }
+		static Vector Sqrt(const Vector A) { return vsqrtq_f32(A); }
+		static Vector Min(const Vector A, const Vector B) { return vbslq_f32(vcltq_f32(A, B), A, B); }
+		static Vector Max(const Vector A, const Vector B) { return vbslq_f32(vcgtq_f32(A, B), A, B); }
+		static Vector Negate(const Vector A) { return vnegq_f32(A); }
+		static Vector LessEqual(const Vector A, const Vector B) { return vreinterpretq_f32_u32(vcleq_f32(A, B)); }
+		static Vector GreaterEqual(const Vector A, const Vector B) { return vreinterpretq_f32_u32(vcgeq_f32(A, B)); }
+		static Vector Less(const Vector A, const Vector B) { return vreinterpretq_f32_u32(vcltq_f32(A, B)); }
+		static Vector Greater(const Vector A, const Vector B) { return vreinterpretq_f32_u32(vcgtq_f32(A, B)); }
+		static Vector And(const Vector A, const Vector B) { return vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(A), vreinterpretq_u32_f32(B))); }
+		static Vector Or(const Vector A, const Vector B) { return vreinterpretq_f32_u32(vorrq_u32(vreinterpretq_u32_f32(A), vreinterpretq_u32_f32(B))); }
+		static Vector AndNot(const Vector Mask, const Vector A) { return vreinterpretq_f32_u32(vbicq_u32(vreinterpretq_u32_f32(A), vreinterpretq_u32_f32(Mask))); }
+		static Vector Select(const Vector Mask, const Vector A, const Vector B) { return vbslq_f32(vreinterpretq_u32_f32(Mask), A, B); }
+		static int Bits(const Vector Mask)
+		{
+			const uint32x4_t Shift = { 0, 1, 2, 3 };
+			const uint32x4_t Ones = vshrq_n_u32(vreinterpretq_u32_f32(Mask), 31);
+			return static_cast<int>(vaddvq_u32(vshlq_u32(Ones, vreinterpretq_s32_u32(Shift))));
+		}
+		static Vector FromBytes(const uint8_t* Data)
+		{
+			const uint32x4_t Values = { Data[0], Data[1], Data[2], Data[3] };
+			return vreinterpretq_f32_u32(vcgtq_u32(Values, vdupq_n_u32(0)));
+		}
+	};
+#endif
+
+#if defined(PK_BALL_KERNEL_AVX2) || defined(PK_BALL_KERNEL_SSE2) || defined(PK_BALL_KERNEL_NEON)
+	// Same operations, in the same order, as BallKernel::Step. Branches become lane masks.
+	int UpdateLanes(const BallKernel::BallArrays& Balls, uint8_t* Events, const int Count, const BallKernel::Params& Parameters)
+	{
+		typedef Lanes::Vector Vector;
+
+		const Vector Zero = Lanes::Set(0.f);
+		const Vector One = Lanes::Set(1.f);
+		const Vector MinusOne = Lanes::Set(-1.f);
+		const Vector ArenaWidth = Lanes::Set(Parameters.ArenaWidth);
+		const Vector ArenaHeight = Lanes::Set(Parameters.ArenaHeight);
+		const Vector CenterX = Lanes::Set(Parameters.CenterX);
+		const Vector CenterY = Lanes::Set(Parameters.CenterY);
+		const Vector HalfWidth = Lanes::Set(Parameters.HalfWidth);
+		const Vector HalfHeight = Lanes::Set(Parameters.HalfHeight);
+		const Vector BaseSpeed = Lanes::Set(Parameters.BaseSpeed);
+		const Vector Delta = Lanes::Set(Parameters.Delta);
+		const Vector GoalDirectionY = Lanes::Set(GOAL_DIRECTION_Y);
+
+		int i = 0;
+		for (; i + Lanes::Width <= Count; i += Lanes::Width)
+		{
+			const Vector X = Lanes::Load(Balls.X + i);
+			const Vector Y = Lanes::Load(Balls.Y + i);
+			const Vector DirectionX = Lanes::Load(Balls.DirectionX + i);
+			const Vector DirectionY = Lanes::Load(Balls.DirectionY + i);
+			const Vector Speed = Lanes::Load(Balls.Speed + i);
+
+			const Vector PlayerOneScored = Lanes::GreaterEqual(Lanes::Add(X, HalfWidth), ArenaWidth);
+			const Vector Goal = Lanes::Or(Lanes::LessEqual(Lanes::Sub(X, HalfWidth), Zero), PlayerOneScored);
+
+			const Vector TopHit = Lanes::LessEqual(Lanes::Sub(Y, HalfHeight), Zero);
+			const Vector BottomHit = Lanes::GreaterEqual(Lanes::Add(Y, HalfHeight), ArenaHeight);
+			const Vector Wall = Lanes::AndNot(Goal, Lanes::Or(TopHit, BottomHit));
+
+			const Vector Base = Lanes::AndNot(TopHit, ArenaHeight);
+			const Vector ToCenter = Lanes::Sub(CenterY, Y);
+			const Vector Sign = Lanes::Or(Lanes::And(Lanes::Greater(ToCenter, Zero), One), Lanes::And(Lanes::Less(ToCenter, Zero), MinusOne));
+			const Vector WallY = Lanes::Add(Base, Lanes::Mul(HalfHeight, Sign));
+
+			const Vector BouncedY = Lanes::Select(Wall, WallY, Y);
+			const Vector BouncedDirectionY = Lanes::Select(Wall, Lanes::Negate(DirectionY), DirectionY);
+
+			const Vector LengthSquared = Lanes::Add(Lanes::Mul(DirectionX, DirectionX), Lanes::Mul(BouncedDirectionY, BouncedDirectionY));
+			const Vector InvLength = Lanes::Div(One, Lanes::Sqrt(LengthSquared));
+			const Vector MovedX = Lanes::Add(X, Lanes::Mul(Lanes::Mul(Lanes::Mul(DirectionX, InvLength), Speed), Delta));
+			const Vector MovedY = Lanes::Add(BouncedY, Lanes::Mul(Lanes::Mul(Lanes::Mul(BouncedDirectionY, InvLength), Speed), Delta));
+
+			Lanes::Store(Balls.X + i, Lanes::Select(Goal, CenterX, MovedX));
+			Lanes::Store(Balls.Y + i, Lanes::Select(Goal, CenterY, MovedY));
+			Lanes::Store(Balls.DirectionX + i, Lanes::Select(Goal, Lanes::Select(PlayerOneScored, One, MinusOne), DirectionX));
+			Lanes::Store(Balls.DirectionY + i, Lanes::Select(Goal, GoalDirectionY, BouncedDirectionY));
+			Lanes::Store(Balls.Speed + i, Lanes::Select(Goal, BaseSpeed, Speed));
+
+			const int WallBits = Lanes::Bits(Wall);
+			const int PlayerOneBits = Lanes::Bits(Lanes::And(Goal, PlayerOneScored));
+			const int PlayerTwoBits = Lanes::Bits(Lanes::AndNot(PlayerOneScored, Goal));
+			for (int Lane = 0; Lane < Lanes::Width; ++Lane)
+			{
+				uint8_t LaneEvent = BallKernel::NONE;
+				LaneEvent |= ((WallBits >> Lane) & 1) ? BallKernel::WALL_BOUNCE : 0;
+				LaneEvent |= ((PlayerOneBits >> Lane) & 1) ? BallKernel::PLAYER_ONE_SCORED : 0;
+				LaneEvent |= ((PlayerTwoBits >> Lane) & 1) ? BallKernel::PLAYER_TWO_SCORED : 0;
+				Events[i + Lane] = LaneEvent;
+			}
+		}
+
+		return i;
+	}
+
+	int IncrementSpeedLanes(float* Speeds, const uint8_t* Hits, const int Count, const BallKernel::Params& Parameters)
+	{
+		typedef Lanes::Vector Vector;
+
+		const Vector Increment = Lanes::Set(Parameters.SpeedIncrement);
+		const Vector BaseSpeed = Lanes::Set(Parameters.BaseSpeed);
+		const Vector MaxSpeed = Lanes::Set(Parameters.MaxSpeed);
+
+		int i = 0;
+		for (; i + Lanes::Width <= Count; i += Lanes::Width)
+		{
+			const Vector Speed = Lanes::Load(Speeds + i);
+			const Vector Clamped = Lanes::Min(Lanes::Max(Lanes::Add(Speed, Increment), BaseSpeed), MaxSpeed);
+			Lanes::Store(Speeds + i, Lanes::Select(Lanes::FromBytes(Hits + i), Clamped, Speed));
+		}
+
+		return i;
+	}
+#endif
+}
+
+uint8_t BallKernel::CheckGoal(float& X, float& Y, float& DirectionX, float& DirectionY, float& Speed, const Params& Parameters)
+{
+	const float Left = X - Parameters.HalfWidth;
+	const float Right = X + Parameters.HalfWidth;
+	if (Left > 0.f && Right < Parameters.ArenaWidth)
+	{
+		return NONE;
+	}
+
+	const bool bPlayerOneScored = Right >= Parameters.ArenaWidth;
+
+	X = Parameters.CenterX;
+	Y = Parameters.CenterY;
+	Speed = Parameters.BaseSpeed;
+	DirectionX = (bPlayerOneScored) ? 1.f : -1.f;
+	DirectionY = GOAL_DIRECTION_Y;
+
+	return (bPlayerOneScored) ? PLAYER_ONE_SCORED : PLAYER_TWO_SCORED;
+}
+
+uint8_t BallKernel::Step(float& X, float& Y, float& DirectionX, float& DirectionY, float& Speed, const Params& Parameters)
+{
+	const uint8_t Goal = CheckGoal(X, Y, DirectionX, DirectionY, Speed, Parameters);
+	if (Goal != NONE)
+	{
+		return Goal;
+	}
+
+	uint8_t Result = NONE;
+
+	// Position ball inside board and invert direction
+	const float Top = Y - Parameters.HalfHeight;
+	const float Bottom = Y + Parameters.HalfHeight;
+	if (Top <= 0.f || Bottom >= Parameters.ArenaHeight)
+	{
+		const float Base = (Top <= 0.f) ? 0.f : Parameters.ArenaHeight;
+		const float ToCenter = Parameters.CenterY - Y;
+		const float Sign = (ToCenter > 0.f) ? 1.f : ((ToCenter < 0.f) ? -1.f : 0.f);
+
+		Y = Base + Parameters.HalfHeight * Sign;
+		DirectionY = -DirectionY;
+		Result = WALL_BOUNCE;
+	}
+
+	const float InvLength = 1.f / std::sqrt(DirectionX * DirectionX + DirectionY * DirectionY);
+	X = X + ((DirectionX * InvLength) * Speed) * Parameters.Delta;
+	Y = Y + ((DirectionY * InvLength) * Speed) * Parameters.Delta;
+
+	return Result;
+}
+
+float BallKernel::IncrementSpeed(const float Speed, const Params& Parameters)
+{
+	return Math::Clamp(Speed + Parameters.SpeedIncrement, Parameters.BaseSpeed, Parameters.MaxSpeed);
+}
+
+void BallKernel::Update(const BallArrays& Balls, uint8_t* Events, const int Count, const Params& Parameters)
+{
+	int First = 0;
+#if defined(PK_BALL_KERNEL_AVX2) || defined(PK_BALL_KERNEL_SSE2) || defined(PK_BALL_KERNEL_NEON)
+	First = UpdateLanes(Balls, Events, Count, Parameters);
+#endif
+
+	for (int i = First; i < Count; ++i)
+	{
+		Events[i] = Step(Balls.X[i], Balls.Y[i], Balls.DirectionX[i], Balls.DirectionY[i], Balls.Speed[i], Parameters);
+	}
+}
+
+void BallKernel::UpdateScalar(const BallArrays& Balls, uint8_t* Events, const int Count, const Params& Parameters)
+{
+	for (int i = 0; i < Count; ++i)
+	{
+		Events[i] = Step(Balls.X[i], Balls.Y[i], Balls.DirectionX[i], Balls.DirectionY[i], Balls.Speed[i], Parameters);
+	}
+}
+
+void BallKernel::IncrementSpeed(float* Speeds, const uint8_t* Hits, const int Count, const Params& Parameters)
+{
+	int First = 0;
+#if defined(PK_BALL_KERNEL_AVX2) || defined(PK_BALL_KERNEL_SSE2) || defined(PK_BALL_KERNEL_NEON)
+	First = IncrementSpeedLanes(Speeds, Hits, Count, Parameters);
+#endif
+
+	for (int i = First; i < Count; ++i)
+	{
+		if (Hits[i] != 0)
+		{
+			Speeds[i] = IncrementSpeed(Speeds[i], Parameters);
+		}
+	}
+}
+
+void BallKernel::IncrementSpeedScalar(float* Speeds, const uint8_t* Hits, const int Count, const Params& Parameters)
+{
+	for (int i = 0; i < Count; ++i)
+	{
+		if (Hits[i] != 0)
+		{
+			Speeds[i] = IncrementSpeed(Speeds[i], Parameters);
+		}
+	}
+}
+
+const char* BallKernel::GetInstructionSet()
+{
+#if defined(PK_BALL_KERNEL_AVX2) || defined(PK_BALL_KERNEL_SSE2) || defined(PK_BALL_KERNEL_NEON)
+	return Lanes::Name;
+#else
+	return "Scalar";
+#endif
+}
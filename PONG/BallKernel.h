@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstdint>
+
+// Ball kinematics on structure-of-arrays data, to advance many balls in lockstep.
+// Step is the discrete reference (walls and goals, no paddles), the batched paths must match it bit for bit.
+// Ball::Update sweeps against paddles too, but shares the goal rule and the speed ramp.
+namespace BallKernel
+{
+	enum Event : uint8_t
+	{
+		NONE = 0,
+		WALL_BOUNCE = 1 << 0,
+		PLAYER_ONE_SCORED = 1 << 1,
+		PLAYER_TWO_SCORED = 1 << 2
+	};
+
+	struct Params
+	{
+		float ArenaWidth;
+		float ArenaHeight;
+		float CenterX;
+		float CenterY;
+		float HalfWidth;
+		float HalfHeight;
+		float BaseSpeed;
+		float SpeedIncrement;
+		float MaxSpeed;
+		float Delta;
+	};
+
+	struct BallArrays
+	{
+		float* X;
+		float* Y;
+		float* DirectionX;
+		float* DirectionY;
+		float* Speed;
+	};
+
+	// Puts the ball back in the middle if it reached a goal line
+	uint8_t CheckGoal(float& X, float& Y, float& DirectionX, float& DirectionY, float& Speed, const Params& Parameters);
+	uint8_t Step(float& X, float& Y, float& DirectionX, float& DirectionY, float& Speed, const Params& Parameters);
+	float IncrementSpeed(const float Speed, const Params& Parameters);
+
+	// Best instruction set available in this build, scalar leftovers for the tail
+	void Update(const BallArrays& Balls, uint8_t* Events, const int Count, const Params& Parameters);
+	void UpdateScalar(const BallArrays& Balls, uint8_t* Events, const int Count, const Params& Parameters);
+
+	// Only balls with a non zero Hits entry speed up
+	void IncrementSpeed(float* Speeds, const uint8_t* Hits, const int Count, const Params& Parameters);
+	void IncrementSpeedScalar(float* Speeds, const uint8_t* Hits, const int Count, const Params& Parameters);
+
+	const char* GetInstructionSet();
+}
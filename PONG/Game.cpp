@@ -1,7 +1,7 @@
 #include "Game.h"
 
+#include <algorithm>
 #include <iostream>
-#include <sstream>
 #include <GLFW/glfw3.h>
 #include <glm/gtc/matrix_transform.hpp>
 
@@ -12,13 +12,39 @@
 #include "pk/SoundEngine.h"
 #include "pk/AssetManager.h"
 #include "Assets.h"
+#include "Replay.h"
+#include "Rollback.h"
+#include "StateChecksum.h"
+
+namespace
+{
+	constexpr int DEFAULT_TICK_RATE = 240;
+	constexpr int DEFAULT_MAX_TICKS_PER_FRAME = 16;
+}
 
 Game::Game(Window* _Window, const Transform& PlayerOneTransform, const Transform& PlayerTwoTransform,
            const float PlayerSpeed, const Transform& BallTransform, const glm::vec3& BallDirection, const float BallSpeed,
            const float BallSpeedIncrement, const float BallMaxSpeed, const int _WinScore)
-		: PlayerOne(PlayerOneTransform, PlayerSpeed, GLFW_KEY_W, GLFW_KEY_S), PlayerTwo(PlayerTwoTransform, PlayerSpeed, GLFW_KEY_UP, GLFW_KEY_DOWN),
+		: Game(glm::ivec2(_Window->GetWidth(), _Window->GetHeight()), PlayerOneTransform, PlayerTwoTransform, PlayerSpeed,
+			BallTransform, BallDirection, BallSpeed, BallSpeedIncrement, BallMaxSpeed, _WinScore)
+{
+	WindowPtr = _Window;
+	SoundPtr = &SoundEngine::Get();
+	AssetsPtr = &AssetManager::Get();
+
+	PlayerOne.SetController(std::make_shared<KeyboardController>(WindowPtr, GLFW_KEY_W, GLFW_KEY_S));
+	PlayerTwo.SetController(std::make_shared<KeyboardController>(WindowPtr, GLFW_KEY_UP, GLFW_KEY_DOWN));
+}
+
+Game::Game(const glm::ivec2& _ArenaSize, const Transform& PlayerOneTransform, const Transform& PlayerTwoTransform,
+           const float PlayerSpeed, const Transform& BallTransform, const glm::vec3& BallDirection, const float BallSpeed,
+           const float BallSpeedIncrement, const float BallMaxSpeed, const int _WinScore)
+		: PlayerOne(PlayerOneTransform, PlayerSpeed), PlayerTwo(PlayerTwoTransform, PlayerSpeed),
 			Ball(BallTransform, BallDirection, BallSpeed),
-			WindowPtr(_Window), Projection(0.f), PlayerOneScore(0), PlayerTwoScore(0), WinScore(_WinScore), State(GameState::PAUSE)
+			PlayerOneStart(PlayerOneTransform.Location), PlayerTwoStart(PlayerTwoTransform.Location), BallStart(BallTransform.Location), BallStartDirection(BallDirection),
+			WindowPtr(nullptr), SoundPtr(nullptr), AssetsPtr(nullptr), Recorder(nullptr), Session(nullptr), ArenaSize(_ArenaSize), Seed(static_cast<uint32_t>(Clock::Now())), bEffectsEnabled(true), Projection(0.f),
+			TickDuration(Clock::NanosecondsPerSecond / DEFAULT_TICK_RATE), MaxTicksPerFrame(DEFAULT_MAX_TICKS_PER_FRAME), Accumulator(0), RenderAlpha(1.f),
+			PlayerOneScore(0), PlayerTwoScore(0), WinScore(_WinScore), Checksum(0), bScoreTextsDirty(true), State(GameState::PAUSE)
 {
 	Projection = glm::ortho(0.f, static_cast<float>(GetScreenWidth()), static_cast<float>(GetScreenHeight()), 0.f, -1.0f, 1.0f);
 
@@ -30,25 +56,52 @@ Game::Game(Window* _Window, const Transform& PlayerOneTransform, const Transform
 	Ball.SetMaxSpeed(BallMaxSpeed);
 }
 
+Game::Game(const MatchSettings& Settings)
+	: Game(Settings.ArenaSize, Settings.PlayerOne, Settings.PlayerTwo, Settings.PlayerSpeed, Settings.Ball, Settings.BallDirection,
+		Settings.BallSpeed, Settings.BallSpeedIncrement, Settings.BallMaxSpeed, Settings.WinScore)
+{
+}
+
 void Game::Begin()
 {
+	if (IsHeadless())
+	{
+		PlayerOne.Begin();
+		PlayerTwo.Begin();
+		Ball.Begin();
+		return;
+	}
+
 	LoadAssets();
-	AssetManager& mAssetManager = AssetManager::Get();
+	AssetManager& mAssetManager = *AssetsPtr;
 
 	MainShader = mAssetManager.GetShader(Assets::MainShaderName);
 	MainShader->Use();
 	MainShader->SetMatrix("projection", Projection);
 
+	Sprites = std::make_unique<SpriteBatch>(mAssetManager.GetShader(Assets::SpriteBatchShaderName), Projection);
+
 	MainFont = mAssetManager.GetFont(Assets::FontName);
 	MainFont->Load(36);
 
+	const glm::vec2 ScreenCenter(GetScreenCenter());
+	TitleText = std::make_unique<TextMesh>(MainFont);
+	TitleText->Set("PONG", glm::vec2(ScreenCenter.x - 35.f, ScreenCenter.y - 100.f), 1.0f);
+	PauseText = std::make_unique<TextMesh>(MainFont);
+	PauseText->Set("Press SPACE to START", glm::vec2(ScreenCenter.x - 205.f, ScreenCenter.y - 25.f), 1.0f);
+	ReplayText = std::make_unique<TextMesh>(MainFont);
+	ReplayText->Set("Press SPACE to play again", glm::vec2(ScreenCenter.x - 270.f, ScreenCenter.y - 25.f), 1.0f);
+	WinText = std::make_unique<TextMesh>(MainFont);
+	PlayerOneScoreText = std::make_unique<TextMesh>(MainFont);
+	PlayerTwoScoreText = std::make_unique<TextMesh>(MainFont);
+
 	PlayerOne.SetTexture(mAssetManager.GetTexture(Assets::FirstPaddleSpriteName));
 	PlayerTwo.SetTexture(mAssetManager.GetTexture(Assets::SecondPaddleSpriteName));
 	Ball.SetTexture(mAssetManager.GetTexture(Assets::BallSpriteName));
 
-	SoundEngine::Get().Load(Assets::WinSound);
+	SoundPtr->Load(Assets::WinSound);
 
-	OldTime = static_cast<float>(glfwGetTime());
+	GameClock.Start();
 
 	InitializeBricks();
 	PlayerOne.Begin();
@@ -58,18 +111,14 @@ void Game::Begin()
 
 void Game::Frame()
 {
-	UpdateDelta();
-	SoundEngine::Get().Update(Delta);
+	const Clock::Nanoseconds FrameDelta = GameClock.NewFrame();
+	SoundPtr->Update(Clock::ToSeconds(FrameDelta));
 
 	WindowPtr->ClearColor(Colors::LightBlack);
 	WindowPtr->ClearFlags(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-	Input(Delta);
-
-	if (State == GameState::MATCH)
-	{
-		Update(Delta);
-	}
+	HandleWindowInput();
+	AdvanceSimulation(FrameDelta);
 
 	RenderGame();
 
@@ -86,134 +135,441 @@ void Game::Frame()
 	WindowPtr->CloseFrame();
 }
 
-bool Game::ShouldClose() const
+void Game::Tick(const float Delta)
 {
-	return WindowPtr->ShouldClose();
-}
+	if (State != GameState::MATCH)
+	{
+		return;
+	}
 
-void Game::Update(const float Delta)
-{
-	PlayerOne.Update(Delta);
-	PlayerTwo.Update(Delta);
-	Ball.Update(Delta);
+	GameClock.CountTick();
 
-	CheckCollisions(Delta);
-}
+	if (Recorder != nullptr && Recorder->NeedsKeyframe())
+	{
+		GameKeyframe Keyframe;
+		CaptureKeyframe(Keyframe);
+		Recorder->RecordKeyframe(Keyframe);
+	}
 
-void Game::Input(const float Delta)
-{
-	if (WindowPtr->IsPressed(GLFW_KEY_ESCAPE))
+	PlayerOne.CachePreviousLocation();
+	PlayerTwo.CachePreviousLocation();
+	Ball.CachePreviousLocation();
+
+	PlayerOne.Input(Delta);
+	PlayerTwo.Input(Delta);
+
+	if (Recorder != nullptr)
 	{
-		WindowPtr->ShouldClose(true);
+		Recorder->Record(PlayerOne.GetLastCommand(), PlayerTwo.GetLastCommand());
 	}
 
-	if (WindowPtr->IsPressed(GLFW_KEY_ENTER))
+	Update(Delta);
+
+	Checksum = StateChecksum::Update(Checksum, *this);
+	if (Recorder != nullptr)
 	{
-		WindowPtr->Maximize();
+		Recorder->RecordChecksum(Checksum);
 	}
+}
+
+void Game::AdvanceSimulation(const Clock::Nanoseconds FrameDelta)
+{
+	// Clamp a long hitch so catching up never costs more than MaxTicksPerFrame ticks (spiral of death)
+	const Clock::Nanoseconds MaxFrameDelta = TickDuration * MaxTicksPerFrame;
+	Accumulator += std::min(FrameDelta, MaxFrameDelta);
 
-	if (WindowPtr->IsPressed(GLFW_KEY_SPACE))
+	const float TickDelta = GetTickDelta();
+	while (Accumulator >= TickDuration)
 	{
-		if (State == GameState::WIN)
+		if (Session != nullptr)
 		{
-			PlayerOneScore = 0;
-			PlayerTwoScore = 0;
-			State = GameState::MATCH;
+			Session->Advance();
 		}
-		else if (State == GameState::PAUSE)
+		else
 		{
-			State = GameState::MATCH;
+			Tick(TickDelta);
 		}
+		Accumulator -= TickDuration;
 	}
 
-	if (State == GameState::MATCH)
+	RenderAlpha = static_cast<float>(static_cast<double>(Accumulator) / TickDuration);
+}
+
+bool Game::ShouldClose() const
+{
+	if (IsHeadless())
 	{
-		PlayerOne.Input(*WindowPtr, Delta);
-		PlayerTwo.Input(*WindowPtr, Delta);
+		return false;
 	}
+
+	return WindowPtr->ShouldClose();
 }
 
-void Game::CheckCollisions(const float Delta)
+bool Game::IsHeadless() const
 {
-	if (Ball.Collide(PlayerOne))
+	return WindowPtr == nullptr;
+}
+
+void Game::SetTickRate(const int TicksPerSecond)
+{
+	TickDuration = Clock::NanosecondsPerSecond / std::max(TicksPerSecond, 1);
+}
+
+float Game::GetTickDelta() const
+{
+	return Clock::ToSeconds(TickDuration);
+}
+
+int Game::GetTickRate() const
+{
+	return static_cast<int>(Clock::NanosecondsPerSecond / TickDuration);
+}
+
+const Clock& Game::GetClock() const
+{
+	return GameClock;
+}
+
+void Game::SetTimeScale(const double NewScale)
+{
+	GameClock.SetTimeScale(NewScale);
+}
+
+void Game::SetMaxTicksPerFrame(const int MaxTicks)
+{
+	MaxTicksPerFrame = std::max(MaxTicks, 1);
+}
+
+void Game::StartMatch()
+{
+	if (State == GameState::WIN)
+	{
+		PlayerOneScore = 0;
+		PlayerTwoScore = 0;
+		Stats = MatchStats();
+		State = GameState::MATCH;
+		bScoreTextsDirty = true;
+	}
+	else if (State == GameState::PAUSE)
 	{
-		Ball.Bounce(PlayerOne);
+		State = GameState::MATCH;
 	}
+}
+
+void Game::Restart()
+{
+	PlayerOne.Teleport(PlayerOneStart);
+	PlayerTwo.Teleport(PlayerTwoStart);
+	Ball.Restart(BallStart, BallStartDirection);
+
+	PlayerOneScore = 0;
+	PlayerTwoScore = 0;
+	Stats = MatchStats();
+	Checksum = 0;
+	Accumulator = 0;
+	State = GameState::PAUSE;
+	bScoreTextsDirty = true;
+}
+
+void Game::ApplySettings(const MatchSettings& Settings)
+{
+	PlayerOne.SetSpeed(Settings.PlayerSpeed);
+	PlayerTwo.SetSpeed(Settings.PlayerSpeed);
+
+	Ball.SetBaseSpeed(Settings.BallSpeed);
+	Ball.SetSpeedIncrement(Settings.BallSpeedIncrement);
+	Ball.SetMaxSpeed(Settings.BallMaxSpeed);
 
-	if (Ball.Collide(PlayerTwo))
+	WinScore = Settings.WinScore;
+}
+
+void Game::SetController(bool bPlayerOne, const PaddleController::SharedPtr& Controller)
+{
+	if (bPlayerOne)
+	{
+		PlayerOne.SetController(Controller);
+	}
+	else
 	{
-		Ball.Bounce(PlayerTwo);
+		PlayerTwo.SetController(Controller);
+	}
+}
+
+uint64_t Game::GetChecksum() const
+{
+	return Checksum;
+}
+
+void Game::CaptureKeyframe(GameKeyframe& Keyframe) const
+{
+	const auto Copy = [](float* Destination, const glm::vec3& Source)
+	{
+		Destination[0] = Source.x;
+		Destination[1] = Source.y;
+		Destination[2] = Source.z;
+	};
+
+	Keyframe.State = static_cast<int32_t>(State);
+	Keyframe.PlayerOneScore = PlayerOneScore;
+	Keyframe.PlayerTwoScore = PlayerTwoScore;
+	Keyframe.Rallies = Stats.Rallies;
+	Keyframe.TotalHits = Stats.TotalHits;
+	Keyframe.LongestRally = Stats.LongestRally;
+	Keyframe.CurrentRally = Stats.CurrentRally;
+	Copy(Keyframe.PlayerOneLocation, PlayerOne.GetLocation());
+	Copy(Keyframe.PlayerTwoLocation, PlayerTwo.GetLocation());
+	Copy(Keyframe.BallLocation, Ball.GetLocation());
+	Copy(Keyframe.BallDirection, Ball.GetDirection());
+	Keyframe.BallSpeed = Ball.GetSpeed();
+	Ball.GetRandomStates(Keyframe.TrailRandom, Keyframe.BounceRandom);
+	Keyframe.Checksum = Checksum;
+}
+
+void Game::RestoreKeyframe(const GameKeyframe& Keyframe)
+{
+	const auto ToVector = [](const float* Source)
+	{
+		return glm::vec3(Source[0], Source[1], Source[2]);
+	};
+
+	State = static_cast<GameState>(Keyframe.State);
+	PlayerOneScore = Keyframe.PlayerOneScore;
+	PlayerTwoScore = Keyframe.PlayerTwoScore;
+	bScoreTextsDirty = true;
+	Stats.Rallies = Keyframe.Rallies;
+	Stats.TotalHits = Keyframe.TotalHits;
+	Stats.LongestRally = Keyframe.LongestRally;
+	Stats.CurrentRally = Keyframe.CurrentRally;
+	PlayerOne.Teleport(ToVector(Keyframe.PlayerOneLocation));
+	PlayerTwo.Teleport(ToVector(Keyframe.PlayerTwoLocation));
+	Ball.Restore(ToVector(Keyframe.BallLocation), ToVector(Keyframe.BallDirection), Keyframe.BallSpeed);
+	Ball.SetRandomStates(Keyframe.TrailRandom, Keyframe.BounceRandom);
+	Checksum = Keyframe.Checksum;
+	Accumulator = 0;
+}
+
+void Game::SaveState(GameSnapshot& Snapshot) const
+{
+	const auto Copy = [](float* Destination, const glm::vec3& Source)
+	{
+		Destination[0] = Source.x;
+		Destination[1] = Source.y;
+		Destination[2] = Source.z;
+	};
+
+	CaptureKeyframe(Snapshot.Match);
+	Copy(Snapshot.PlayerOnePreviousLocation, PlayerOne.GetPreviousLocation());
+	Copy(Snapshot.PlayerTwoPreviousLocation, PlayerTwo.GetPreviousLocation());
+	Copy(Snapshot.BallPreviousLocation, Ball.GetPreviousLocation());
+	Snapshot.Padding = 0;
+	Snapshot.Accumulator = Accumulator;
+	Ball.SaveParticles(Snapshot.Particles);
+}
+
+void Game::RestoreState(const GameSnapshot& Snapshot)
+{
+	const auto ToVector = [](const float* Source)
+	{
+		return glm::vec3(Source[0], Source[1], Source[2]);
+	};
+
+	RestoreKeyframe(Snapshot.Match);
+	PlayerOne.RestoreLocation(PlayerOne.GetLocation(), ToVector(Snapshot.PlayerOnePreviousLocation));
+	PlayerTwo.RestoreLocation(PlayerTwo.GetLocation(), ToVector(Snapshot.PlayerTwoPreviousLocation));
+	Ball.RestoreLocation(Ball.GetLocation(), ToVector(Snapshot.BallPreviousLocation));
+	Accumulator = Snapshot.Accumulator;
+	Ball.RestoreParticles(Snapshot.Particles);
+}
+
+void Game::SetRecorder(ReplayRecorder* NewRecorder)
+{
+	Recorder = NewRecorder;
+}
+
+void Game::SetSession(RollbackSession* NewSession)
+{
+	Session = NewSession;
+}
+
+void Game::SetSeed(const uint32_t NewSeed)
+{
+	Seed = NewSeed;
+}
+
+uint32_t Game::GetSeed() const
+{
+	return Seed;
+}
+
+void Game::SetServeDirection(const glm::vec3& Direction)
+{
+	BallStartDirection = Direction;
+}
+
+void Game::SetEffectsEnabled(const bool bEnabled)
+{
+	bEffectsEnabled = bEnabled;
+}
+
+bool Game::AreEffectsEnabled() const
+{
+	return bEffectsEnabled;
+}
+
+SoundEngine* Game::GetSoundEngine() const
+{
+	return SoundPtr;
+}
+
+AssetManager* Game::GetAssetManager() const
+{
+	return AssetsPtr;
+}
+
+GameState Game::GetState() const
+{
+	return State;
+}
+
+const MatchStats& Game::GetStats() const
+{
+	return Stats;
+}
+
+int Game::GetPlayerOneScore() const
+{
+	return PlayerOneScore;
+}
+
+int Game::GetPlayerTwoScore() const
+{
+	return PlayerTwoScore;
+}
+
+const Player& Game::GetPlayerOne() const
+{
+	return PlayerOne;
+}
+
+const Player& Game::GetPlayerTwo() const
+{
+	return PlayerTwo;
+}
+
+const Ball& Game::GetBall() const
+{
+	return Ball;
+}
+
+void Game::Update(const float Delta)
+{
+	PlayerOne.Update(Delta);
+	PlayerTwo.Update(Delta);
+	// Ball sweeps against the paddles where they are after this tick
+	Ball.Update(Delta);
+}
+
+void Game::HandleWindowInput()
+{
+	if (WindowPtr->IsPressed(GLFW_KEY_ESCAPE))
+	{
+		WindowPtr->ShouldClose(true);
+	}
+
+	if (WindowPtr->IsPressed(GLFW_KEY_ENTER))
+	{
+		WindowPtr->Maximize();
+	}
+
+	// Online matches start together on both machines
+	if (WindowPtr->IsPressed(GLFW_KEY_SPACE) && Session == nullptr)
+	{
+		StartMatch();
 	}
 }
 
 void Game::RenderGame() const
 {
-	PlayerOne.Render();
-	PlayerTwo.Render();
+	// Outside a match nothing moves, draw actors where the last tick left them
+	const float Alpha = (State == GameState::MATCH) ? RenderAlpha : 1.f;
+
+	// Bricks share a texture, their count does not change the number of draws
+	Sprites->Begin();
+	PlayerOne.QueueSprite(*Sprites, Alpha);
+	PlayerTwo.QueueSprite(*Sprites, Alpha);
 
 	if (State == GameState::MATCH)
 	{
-		Ball.Render();
+		Ball.QueueSprite(*Sprites, Alpha);
 
 		for (const GameActor& Brick : Bricks)
 		{
-			Brick.Render();
+			Brick.QueueSprite(*Sprites, Alpha);
 		}
 	}
+	Sprites->Flush();
+
+	if (State == GameState::MATCH)
+	{
+		Ball.RenderEffects();
+	}
 
 	RenderScore();
 }
 
 void Game::RenderScore() const
 {
-	const std::string OneScore(std::to_string(PlayerOneScore));
-	const std::string TwoScore(std::to_string(PlayerTwoScore));
-
-	const glm::vec2 ScreenCenter(GetScreenCenter());
+	UpdateScoreTexts();
 
 	const float* OneColor = (PlayerOneScore > PlayerTwoScore) ? Colors::Green : Colors::White;
 	const float* SecondColor = (PlayerTwoScore > PlayerOneScore) ? Colors::Green : Colors::White;
 
-	MainFont->Render(OneScore, glm::vec2(ScreenCenter.x - 100.f, 100.f), 1.0f, OneColor);
-	MainFont->Render(TwoScore, glm::vec2(ScreenCenter.x + 100.f, 100.f), 1.0f, SecondColor);
+	PlayerOneScoreText->Render(OneColor);
+	PlayerTwoScoreText->Render(SecondColor);
 }
 
 void Game::RenderWinScreen() const
 {
-	const std::string ReplayText = "Press SPACE to play again";
-	const std::string Winner = (PlayerOneScore > PlayerTwoScore) ? "One" : "Two";
-	std::ostringstream WinTextStream;
-	WinTextStream << "Player " << Winner << " WON";
-	const std::string WinText = WinTextStream.str();
+	UpdateScoreTexts();
 
-	const glm::vec2 ScreenCenter(GetScreenCenter());
-	MainFont->Render(WinText, glm::vec2(ScreenCenter.x - 170.f, ScreenCenter.y - 75.f), 1.0f, Colors::White);
-	MainFont->Render(ReplayText, glm::vec2(ScreenCenter.x - 270.f, ScreenCenter.y - 25.f), 1.0f, Colors::White);
+	WinText->Render(Colors::White);
+	ReplayText->Render(Colors::White);
 }
 
 void Game::RenderPauseScreen() const
 {
-	const std::string TitleText = "PONG";
-	const std::string PauseText = "Press SPACE to START";
+	TitleText->Render(Colors::White);
+	PauseText->Render(Colors::White);
+}
+
+void Game::UpdateScoreTexts() const
+{
+	if (!bScoreTextsDirty)
+	{
+		return;
+	}
+	bScoreTextsDirty = false;
 
 	const glm::vec2 ScreenCenter(GetScreenCenter());
-	MainFont->Render(TitleText, glm::vec2(ScreenCenter.x - 35.f, ScreenCenter.y - 100.f), 1.0f, Colors::White);
-	MainFont->Render(PauseText, glm::vec2(ScreenCenter.x - 205.f, ScreenCenter.y - 25.f), 1.0f, Colors::White);
+	PlayerOneScoreText->Set(std::to_string(PlayerOneScore), glm::vec2(ScreenCenter.x - 100.f, 100.f), 1.0f);
+	PlayerTwoScoreText->Set(std::to_string(PlayerTwoScore), glm::vec2(ScreenCenter.x + 100.f, 100.f), 1.0f);
+	WinText->Set((PlayerOneScore > PlayerTwoScore) ? "Player One WON" : "Player Two WON",
+		glm::vec2(ScreenCenter.x - 170.f, ScreenCenter.y - 75.f), 1.0f);
 }
 
 int Game::GetScreenWidth() const
 {
-	return WindowPtr->GetWidth();
+	return ArenaSize.x;
 }
 
 int Game::GetScreenHeight() const
 {
-	return WindowPtr->GetHeight();
+	return ArenaSize.y;
 }
 
 glm::vec2 Game::GetScreenCenter() const
 {
-	return WindowPtr->GetScreenCenter();
+	return {ArenaSize.x / 2, ArenaSize.y / 2};
 }
 
 glm::mat4 Game::GetProjection() const
@@ -221,8 +577,18 @@ glm::mat4 Game::GetProjection() const
 	return Projection;
 }
 
+void Game::RegisterPaddleHit()
+{
+	Stats.CurrentRally++;
+}
+
 void Game::IncrementScore(bool bPlayerOneScored)
 {
+	Stats.Rallies++;
+	Stats.TotalHits += Stats.CurrentRally;
+	Stats.LongestRally = std::max(Stats.LongestRally, Stats.CurrentRally);
+	Stats.CurrentRally = 0;
+
 	if (bPlayerOneScored)
 	{
 		PlayerOneScore++;
@@ -231,20 +597,26 @@ void Game::IncrementScore(bool bPlayerOneScored)
 	{
 		PlayerTwoScore++;
 	}
+	bScoreTextsDirty = true;
 
 	if (PlayerOneScore >= WinScore || PlayerTwoScore >= WinScore)
 	{
 		State = GameState::WIN;
-		SoundEngine::Get().Play(Assets::WinSound, 1.f);
+
+		if (SoundPtr != nullptr)
+		{
+			SoundPtr->Play(Assets::WinSound, 1.f);
+		}
 	}
 }
 
 void Game::LoadAssets() const
 {
-	AssetManager& mAssetManager = AssetManager::Get();
+	AssetManager& mAssetManager = *AssetsPtr;
 
 	mAssetManager.LoadShader(Assets::ParticleShaderName, Assets::ParticleVertexShader, Assets::ParticleFragmentShader);
 	mAssetManager.LoadShader(Assets::MainShaderName, Assets::MainVertexShader, Assets::MainFragmentShader);
+	mAssetManager.LoadShader(Assets::SpriteBatchShaderName, Assets::SpriteBatchVertexShader, Assets::SpriteBatchFragmentShader);
 	mAssetManager.LoadShader(Assets::TextShaderName, Assets::TextVertexShader, Assets::TextFragmentShader);
 	mAssetManager.LoadFont(Assets::FontName, Assets::FontPath, Assets::TextShaderName, Projection);
 	mAssetManager.LoadTexture(Assets::FirstPaddleSpriteName,
@@ -265,13 +637,6 @@ void Game::LoadAssets() const
 	);
 }
 
-void Game::UpdateDelta()
-{
-	CurrentTime = static_cast<float>(glfwGetTime());
-	Delta = CurrentTime - OldTime;
-	OldTime = CurrentTime;
-}
-
 void Game::InitializeBricks()
 {
 	const glm::vec2 ScreenCenter = GetScreenCenter();
@@ -287,7 +652,8 @@ void Game::InitializeBricks()
 		CurrentBrickPos.y += (i * BrickSize.y) + (i * BrickSpan);
 
 		GameActor Brick(CurrentBrickPos, BrickSize);
-		Brick.SetTexture(AssetManager::Get().GetTexture(Assets::BrickSpriteName));
+		Brick.SetGame(this);
+		Brick.SetTexture(AssetsPtr->GetTexture(Assets::BrickSpriteName));
 		Bricks.push_back(Brick);
 	}
 }
@@ -3,13 +3,22 @@
 #include <glm/glm.hpp>
 #include <vector>
 #include <memory>
+#include <type_traits>
 
 #include "Player.h"
 #include "Ball.h"
+#include "MatchSettings.h"
 #include "pk/Shader.h"
+#include "pk/Clock.h"
+#include "pk/SpriteBatch.h"
+#include "pk/TextMesh.h"
 
 class Window;
 class Font;
+class SoundEngine;
+class AssetManager;
+class ReplayRecorder;
+class RollbackSession;
 
 enum class GameState : uint8_t
 {
@@ -18,6 +27,52 @@ enum class GameState : uint8_t
 	PAUSE
 };
 
+struct MatchStats
+{
+	int Rallies = 0;
+	int TotalHits = 0;
+	int LongestRally = 0;
+	int CurrentRally = 0;
+};
+
+// Everything a match needs to continue from a given tick, in a fixed layout.
+// Particles are left out, they never change the outcome of a match.
+struct GameKeyframe
+{
+	int32_t State;
+	int32_t PlayerOneScore;
+	int32_t PlayerTwoScore;
+	int32_t Rallies;
+	int32_t TotalHits;
+	int32_t LongestRally;
+	int32_t CurrentRally;
+	float PlayerOneLocation[3];
+	float PlayerTwoLocation[3];
+	float BallLocation[3];
+	float BallDirection[3];
+	float BallSpeed;
+	uint32_t TrailRandom;
+	uint32_t BounceRandom;
+	// Checksum before the keyframe tick, so a restored game keeps rolling the same value
+	uint64_t Checksum;
+};
+
+// Complete simulation state in one flat block, a copy is all it takes to save or restore it.
+// Nothing points to the heap, so snapshots can live in rings and be sent as they are.
+// Controllers keep their own state, rollback must replay their commands instead.
+struct GameSnapshot
+{
+	GameKeyframe Match;
+	float PlayerOnePreviousLocation[3];
+	float PlayerTwoPreviousLocation[3];
+	float BallPreviousLocation[3];
+	int32_t Padding;
+	int64_t Accumulator;
+	BallParticles Particles;
+};
+
+static_assert(std::is_trivially_copyable<GameSnapshot>::value, "GameSnapshot must stay a flat copyable block");
+
 class Game
 {
 public:
@@ -33,9 +88,78 @@ public:
 		const int _WinScore
 	);
 
+	// Headless game, no window nor GL context: arena size comes from the caller
+	Game(const glm::ivec2& _ArenaSize,
+		const Transform& PlayerOneTransform,
+		const Transform& PlayerTwoTransform,
+		const float PlayerSpeed,
+		const Transform& BallTransform,
+		const glm::vec3& BallDirection,
+		const float BallSpeed,
+		const float BallSpeedIncrement,
+		const float BallMaxSpeed,
+		const int _WinScore
+	);
+
+	explicit Game(const MatchSettings& Settings);
+
 	void Begin();
 	void Frame();
+	void Tick(const float Delta);
 	bool ShouldClose() const;
+	bool IsHeadless() const;
+
+	// Simulation runs at a fixed rate, rendering interpolates between the last two ticks
+	void SetTickRate(const int TicksPerSecond);
+	float GetTickDelta() const;
+	int GetTickRate() const;
+	const Clock& GetClock() const;
+	// Slow motion below 1, fast forward above: frames feed scaled time to the fixed rate ticks
+	void SetTimeScale(const double NewScale);
+	void SetMaxTicksPerFrame(const int MaxTicks);
+
+	void StartMatch();
+	// Puts actors, scores and random generators back to their initial state without reallocating
+	void Restart();
+	// Speeds and win score of an existing game, arena and start transforms are kept. Takes effect on the next Restart.
+	void ApplySettings(const MatchSettings& Settings);
+	void SetController(bool bPlayerOne, const PaddleController::SharedPtr& Controller);
+
+	// Rolling StateChecksum of every tick simulated so far
+	uint64_t GetChecksum() const;
+
+	void CaptureKeyframe(GameKeyframe& Keyframe) const;
+	// Teleports actors, nothing is interpolated from before the restore
+	void RestoreKeyframe(const GameKeyframe& Keyframe);
+	// Keyframe plus particle pools and interpolation state, restoring it continues bit for bit
+	void SaveState(GameSnapshot& Snapshot) const;
+	void RestoreState(const GameSnapshot& Snapshot);
+	// Every tick's paddle commands go to the recorder, null stops recording. Not owned.
+	void SetRecorder(ReplayRecorder* NewRecorder);
+	// Frames advance the session instead of ticking directly, it starts the match when the peer joins. Not owned.
+	void SetSession(RollbackSession* NewSession);
+
+	// Seeds every random generator of the simulation, call before Begin
+	void SetSeed(const uint32_t NewSeed);
+	uint32_t GetSeed() const;
+	// Ball direction of the next Restart
+	void SetServeDirection(const glm::vec3& Direction);
+
+	// Particle effects are cosmetic, disable them before Begin for faster simulations
+	void SetEffectsEnabled(const bool bEnabled);
+	bool AreEffectsEnabled() const;
+
+	// Both are null in headless games, the simulation must never rely on them
+	SoundEngine* GetSoundEngine() const;
+	AssetManager* GetAssetManager() const;
+
+	GameState GetState() const;
+	const MatchStats& GetStats() const;
+	int GetPlayerOneScore() const;
+	int GetPlayerTwoScore() const;
+	const Player& GetPlayerOne() const;
+	const Player& GetPlayerTwo() const;
+	const ::Ball& GetBall() const;
 
 	int GetScreenWidth() const;
 	int GetScreenHeight() const;
@@ -44,40 +168,71 @@ public:
 	glm::mat4 GetProjection() const;
 
 	void IncrementScore(bool bPlayerOneScored);
+	void RegisterPaddleHit();
 
 private:
 	void LoadAssets() const;
-	void UpdateDelta();
 	void Update(const float Delta);
-	void Input(const float Delta);
-	void CheckCollisions(const float Delta);
+	void HandleWindowInput();
+
+	void AdvanceSimulation(const Clock::Nanoseconds FrameDelta);
 
 	void RenderGame() const;
 	void RenderScore() const;
 	void RenderWinScreen() const;
 	void RenderPauseScreen() const;
+	// Rebuilds the score and winner text meshes after the scores changed. Called while rendering,
+	// the simulation only marks them dirty so it never touches GL buffers.
+	void UpdateScoreTexts() const;
 
 	void InitializeBricks();
 
 	Player PlayerOne;
 	Player PlayerTwo;
 	Ball Ball;
+
+	glm::vec3 PlayerOneStart;
+	glm::vec3 PlayerTwoStart;
+	glm::vec3 BallStart;
+	glm::vec3 BallStartDirection;
 	std::vector<GameActor> Bricks;
 
 	Window* WindowPtr;
+	SoundEngine* SoundPtr;
+	AssetManager* AssetsPtr;
+	ReplayRecorder* Recorder;
+	RollbackSession* Session;
+	glm::ivec2 ArenaSize;
+	uint32_t Seed;
+	bool bEffectsEnabled;
 
 	glm::mat4 Projection;
 	std::shared_ptr<Shader> MainShader;
 
-	float CurrentTime;
-	float OldTime;
-	float Delta;
+	Clock GameClock;
+
+	Clock::Nanoseconds TickDuration;
+	int MaxTicksPerFrame;
+	Clock::Nanoseconds Accumulator;
+	float RenderAlpha;
 
 	int PlayerOneScore;
 	int PlayerTwoScore;
 	int WinScore;
+	MatchStats Stats;
+	uint64_t Checksum;
 
 	std::shared_ptr<Font> MainFont;
+	// Paddles, ball and bricks in a few instanced draws, windowed games only
+	SpriteBatch::UniquePtr Sprites;
+	// Tessellated once, scores and winner only when they change
+	TextMesh::UniquePtr TitleText;
+	TextMesh::UniquePtr PauseText;
+	TextMesh::UniquePtr WinText;
+	TextMesh::UniquePtr ReplayText;
+	TextMesh::UniquePtr PlayerOneScoreText;
+	TextMesh::UniquePtr PlayerTwoScoreText;
+	mutable bool bScoreTextsDirty;
 
 	GameState State;
 };
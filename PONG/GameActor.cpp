@@ -6,6 +6,7 @@
 #include "Assets.h"
 #include "pk/AssetManager.h"
 #include "pk/Renderer.h"
+#include "pk/SpriteBatch.h"
 #include "pk/Texture.h"
 
 Transform::Transform()
@@ -46,12 +47,12 @@ float BoundingBox::Left() const
 }
 
 GameActor::GameActor(const ::Transform& _Transform)
-	: mTransform(_Transform), Color(1.f, 1.f, 1.f)
+	: mTransform(_Transform), PreviousLocation(_Transform.Location), Color(1.f, 1.f, 1.f), mGame(nullptr)
 {
 }
 
 GameActor::GameActor(const glm::vec3& _Location, const glm::vec3 _Size)
-	: mTransform(_Location, _Size), Color(1.f, 1.f, 1.f)
+	: mTransform(_Location, _Size), PreviousLocation(_Location), Color(1.f, 1.f, 1.f), mGame(nullptr)
 {
 }
 
@@ -95,10 +96,34 @@ void GameActor::Move(const glm::vec3& Delta)
 	mTransform.Location += Delta;
 }
 
-glm::mat4 GameActor::GetRenderModel() const
+void GameActor::Teleport(const glm::vec3& NewLocation)
 {
+	mTransform.Location = NewLocation;
+	PreviousLocation = NewLocation;
+}
+
+void GameActor::RestoreLocation(const glm::vec3& NewLocation, const glm::vec3& NewPreviousLocation)
+{
+	mTransform.Location = NewLocation;
+	PreviousLocation = NewPreviousLocation;
+}
+
+glm::vec3 GameActor::GetPreviousLocation() const
+{
+	return PreviousLocation;
+}
+
+void GameActor::CachePreviousLocation()
+{
+	PreviousLocation = mTransform.Location;
+}
+
+glm::mat4 GameActor::GetRenderModel(const float Alpha) const
+{
+	const glm::vec3 RenderLocation = glm::mix(PreviousLocation, mTransform.Location, Alpha);
+
 	const glm::mat4 Identity(1.f);
-	glm::mat4 RenderModel = glm::translate(Identity, mTransform.Location);
+	glm::mat4 RenderModel = glm::translate(Identity, RenderLocation);
 	RenderModel = glm::scale(RenderModel, mTransform.Size);
 
 	return RenderModel;
@@ -145,20 +170,34 @@ void GameActor::Update(const float Delta)
 {
 }
 
-void GameActor::Input(const Window& Window, const float Delta)
+void GameActor::Input(const float Delta)
 {
 }
 
-void GameActor::Render() const
+void GameActor::Render(const float Alpha) const
 {
+	// Actors outside a game and headless games own no assets and have nothing to draw with
+	const Game* OwningGame = GetGame();
+	AssetManager* mAssetManager = (OwningGame != nullptr) ? OwningGame->GetAssetManager() : nullptr;
+	if (mAssetManager == nullptr)
+	{
+		return;
+	}
+
 	Renderer::Get().RenderSprite(
-		AssetManager::Get().GetShader(Assets::MainShaderName),
+		mAssetManager->GetShader(Assets::MainShaderName),
 		mTexture,
-		GetRenderModel(),
+		GetRenderModel(Alpha),
 		Color
 	);
 }
 
+void GameActor::QueueSprite(SpriteBatch& Batch, const float Alpha) const
+{
+	const glm::vec3 RenderLocation = glm::mix(PreviousLocation, mTransform.Location, Alpha);
+	Batch.Draw(mTexture, glm::vec2(RenderLocation), glm::vec2(mTransform.Size), Color);
+}
+
 Game* GameActor::GetGame() const
 {
 	return mGame;
@@ -6,8 +6,8 @@
 
 #include "pk/Texture.h"
 
-class Window;
 class Game;
+class SpriteBatch;
 
 struct Transform
 {
@@ -45,8 +45,16 @@ public:
 	void SetColor(const glm::vec3& _Color);
 	glm::vec3 GetColor() const;
 	void Move(const glm::vec3& Delta);
+	// Moves without leaving anything to interpolate from
+	void Teleport(const glm::vec3& NewLocation);
+	// Puts back both ends of the render interpolation, for snapshots
+	void RestoreLocation(const glm::vec3& NewLocation, const glm::vec3& NewPreviousLocation);
 
-	glm::mat4 GetRenderModel() const;
+	// Location at the start of the current simulation tick, used to interpolate rendering between ticks
+	glm::vec3 GetPreviousLocation() const;
+	void CachePreviousLocation();
+
+	glm::mat4 GetRenderModel(const float Alpha) const;
 	BoundingBox GetBoundingBox() const;
 	void BindTexture() const;
 	void UnBindTexture() const;
@@ -55,8 +63,10 @@ public:
 
 	virtual void Begin();
 	virtual void Update(const float Delta);
-	virtual void Input(const Window& Window, const float Delta);
-	virtual void Render() const;
+	virtual void Input(const float Delta);
+	virtual void Render(const float Alpha) const;
+	// Adds the sprite to a batch instead of drawing it right away
+	void QueueSprite(SpriteBatch& Batch, const float Alpha) const;
 
 	virtual ~GameActor() = default;
 
@@ -66,6 +76,7 @@ protected:
 
 private:
 	Transform mTransform;
+	glm::vec3 PreviousLocation;
 	glm::vec3 Color;
 	// Impossible to use std::unique_ptr because GameActor is used in vectors
 	// That would cause a copy/assignment and would violate the purpose of unique...
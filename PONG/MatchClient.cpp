@@ -0,0 +1,281 @@
+#include "MatchClient.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "Player.h"
+#include "pk/Common.h"
+
+namespace
+{
+	constexpr int INPUT_RING = 256;
+	constexpr int MAX_SNAPSHOTS = 16;
+	// Snapshot intervals the view stays in the past, one lost snapshot still leaves two to interpolate between
+	constexpr int INTERPOLATION_SNAPSHOTS = 2;
+	// Below this a correction is quantization, not a misprediction
+	constexpr float CORRECTION_EPSILON = SnapshotCodec::POSITION_TOLERANCE + 0.001f;
+
+	int Slot(const int Tick)
+	{
+		return Tick & (INPUT_RING - 1);
+	}
+
+	float Lerp(const float From, const float To, const float Alpha)
+	{
+		return From + (To - From) * Alpha;
+	}
+}
+
+MatchClient::MatchClient(UdpSocket& _Socket, const NetAddress& _Server, const MatchSettings& Settings, const PaddleController::SharedPtr& _Controller)
+	: Socket(_Socket), Server(_Server), Controller(_Controller), View(Settings),
+		bJoined(false), bPlayerOne(true), Match(0), TickRate(0), SnapshotInterval(1),
+		Inputs(INPUT_RING, PaddleCommand::HOLD), Predicted(INPUT_RING, 0.f), InputCount(0), Processed(0), PredictedY(0.f),
+		Codec(Settings), Acked(0), TicksSinceSnapshot(0)
+{
+	View.SetEffectsEnabled(false);
+	View.Begin();
+	TickRate = View.GetTickRate();
+}
+
+void MatchClient::Tick()
+{
+	Stats.Ticks++;
+	TicksSinceSnapshot++;
+
+	uint8_t Buffer[ServerProtocol::MAX_DATAGRAM];
+	NetAddress From;
+	int Size = 0;
+	while ((Size = Socket.Receive(Buffer, sizeof(Buffer), From)) >= 0)
+	{
+		if (From == Server)
+		{
+			Receive(Buffer, Size);
+		}
+	}
+
+	if (bJoined && !Snapshots.empty())
+	{
+		Interpolate();
+
+		if (Snapshots.back().State == static_cast<uint8_t>(GameState::MATCH))
+		{
+			const Player& Own = (bPlayerOne) ? View.GetPlayerOne() : View.GetPlayerTwo();
+			const PaddleCommand Command = (Controller != nullptr) ? Controller->Decide(Own, View, View.GetTickDelta()) : PaddleCommand::HOLD;
+
+			Inputs[Slot(InputCount)] = Command;
+			PredictedY = MoveOwnPaddle(PredictedY, Command);
+			Predicted[Slot(InputCount)] = PredictedY;
+			InputCount++;
+		}
+	}
+
+	Send();
+}
+
+void MatchClient::Receive(const uint8_t* Data, const int Size)
+{
+	ByteReader Reader(Data, Size);
+	ServerProtocol::Message Type;
+	if (!ServerProtocol::ReadHeader(Reader, Type))
+	{
+		return;
+	}
+
+	ServerProtocol::Welcome Welcome;
+	if (Type == ServerProtocol::Message::WELCOME && !bJoined && ServerProtocol::Read(Reader, Welcome))
+	{
+		bJoined = true;
+		bPlayerOne = Welcome.bPlayerOne != 0;
+		Match = Welcome.Match;
+		TickRate = Welcome.TickRate;
+		SnapshotInterval = Welcome.SnapshotInterval;
+		View.SetTickRate(TickRate);
+		PredictedY = ((bPlayerOne) ? View.GetPlayerOne() : View.GetPlayerTwo()).GetLocation().y;
+		return;
+	}
+
+	if (Type != ServerProtocol::Message::SNAPSHOT || !bJoined)
+	{
+		return;
+	}
+
+	BitReader Bits(Reader.GetCursor(), Reader.GetRemaining());
+	QuantizedSnapshot Decoded;
+	if (!Codec.Decode(Bits, Received, Decoded))
+	{
+		return;
+	}
+	Received.Store(Decoded);
+	Acked = std::max(Acked, Decoded.Sequence);
+	const ServerProtocol::Snapshot Latest = Codec.Dequantize(Decoded);
+
+	// Final snapshots repeat the last tick until the match closes
+	const bool bRepeated = !Snapshots.empty() && Latest.Tick == Snapshots.back().Tick && Latest.State == Snapshots.back().State;
+	if (!Snapshots.empty() && (Latest.Tick < Snapshots.back().Tick || bRepeated))
+	{
+		Stats.StaleSnapshots++;
+		return;
+	}
+
+	Stats.SnapshotsReceived++;
+	if (static_cast<int>(Snapshots.size()) == MAX_SNAPSHOTS)
+	{
+		Snapshots.erase(Snapshots.begin());
+	}
+	Snapshots.push_back(Latest);
+	TicksSinceSnapshot = 0;
+
+	Reconcile(Latest);
+}
+
+void MatchClient::Reconcile(const ServerProtocol::Snapshot& Latest)
+{
+	const float ServerY = (bPlayerOne) ? Latest.PlayerOneY : Latest.PlayerTwoY;
+	const int Applied = std::min(static_cast<int>(Latest.ProcessedInputs), InputCount);
+
+	// Where prediction had the paddle after the same inputs
+	if (Applied > 0 && Applied > InputCount - INPUT_RING)
+	{
+		const float Correction = std::abs(Predicted[Slot(Applied - 1)] - ServerY);
+		if (Correction > CORRECTION_EPSILON)
+		{
+			Stats.Corrections++;
+			Stats.TotalCorrection += Correction;
+			Stats.MaxCorrection = std::max(Stats.MaxCorrection, Correction);
+		}
+	}
+
+	// Start over from the authoritative height and replay what the server has not seen yet
+	Processed = std::max(Processed, Applied);
+	float Y = ServerY;
+	for (int Input = Applied; Input < InputCount; ++Input)
+	{
+		Y = MoveOwnPaddle(Y, Inputs[Slot(Input)]);
+		Predicted[Slot(Input)] = Y;
+	}
+	PredictedY = Y;
+}
+
+void MatchClient::Interpolate()
+{
+	const int Delay = INTERPOLATION_SNAPSHOTS * SnapshotInterval;
+	const ServerProtocol::Snapshot& Newest = Snapshots.back();
+	const float RenderTick = static_cast<float>(Newest.Tick) + TicksSinceSnapshot - Delay;
+
+	size_t FromIndex = 0;
+	while (FromIndex + 1 < Snapshots.size() && Snapshots[FromIndex + 1].Tick <= RenderTick)
+	{
+		FromIndex++;
+	}
+
+	const ServerProtocol::Snapshot* From = &Snapshots[FromIndex];
+	const ServerProtocol::Snapshot* To = (FromIndex + 1 < Snapshots.size()) ? &Snapshots[FromIndex + 1] : From;
+
+	float Alpha = 0.f;
+	float Extrapolation = 0.f;
+	if (To != From)
+	{
+		Alpha = Math::Clamp((RenderTick - From->Tick) / static_cast<float>(To->Tick - From->Tick), 0.f, 1.f);
+		Stats.InterpolatedTicks++;
+	}
+	else if (RenderTick > From->Tick)
+	{
+		Extrapolation = std::min(RenderTick - From->Tick, static_cast<float>(Delay));
+		Stats.ExtrapolatedTicks++;
+	}
+
+	// A goal teleports the ball, nothing to interpolate across it
+	if (From->PlayerOneScore != To->PlayerOneScore || From->PlayerTwoScore != To->PlayerTwoScore)
+	{
+		From = To;
+	}
+
+	const float Delta = View.GetTickDelta();
+	const float ArenaHeight = static_cast<float>(View.GetScreenHeight());
+
+	GameKeyframe Keyframe;
+	View.CaptureKeyframe(Keyframe);
+	Keyframe.State = To->State;
+	Keyframe.PlayerOneScore = To->PlayerOneScore;
+	Keyframe.PlayerTwoScore = To->PlayerTwoScore;
+	Keyframe.Rallies = To->Rallies;
+	Keyframe.PlayerOneLocation[1] = (bPlayerOne) ? PredictedY : Lerp(From->PlayerOneY, To->PlayerOneY, Alpha);
+	Keyframe.PlayerTwoLocation[1] = (bPlayerOne) ? Lerp(From->PlayerTwoY, To->PlayerTwoY, Alpha) : PredictedY;
+	Keyframe.BallLocation[0] = Lerp(From->BallX, To->BallX, Alpha) + To->BallDirectionX * To->BallSpeed * Delta * Extrapolation;
+	Keyframe.BallLocation[1] = Math::Clamp(Lerp(From->BallY, To->BallY, Alpha) + To->BallDirectionY * To->BallSpeed * Delta * Extrapolation,
+		0.f, ArenaHeight);
+	Keyframe.BallDirection[0] = To->BallDirectionX;
+	Keyframe.BallDirection[1] = To->BallDirectionY;
+	Keyframe.BallSpeed = To->BallSpeed;
+	View.RestoreKeyframe(Keyframe);
+}
+
+void MatchClient::Send()
+{
+	uint8_t Buffer[ServerProtocol::MAX_DATAGRAM];
+	ByteWriter Writer(Buffer, sizeof(Buffer));
+
+	if (!bJoined)
+	{
+		ServerProtocol::WriteHeader(Writer, ServerProtocol::Message::JOIN);
+		Socket.Send(Server, Buffer, Writer.GetSize());
+		return;
+	}
+
+	// Sent every tick, even without inputs it tells the server the client is still there
+	ServerProtocol::Inputs Pending = {};
+	const int Start = std::max(Processed, InputCount - INPUT_RING / 2);
+	Pending.Start = static_cast<uint32_t>(Start);
+	Pending.Count = static_cast<uint8_t>(std::min(InputCount - Start, ServerProtocol::MAX_INPUTS));
+	Pending.Acked = Acked;
+	for (int i = 0; i < Pending.Count; ++i)
+	{
+		Pending.Set(i, Inputs[Slot(Start + i)]);
+	}
+
+	ServerProtocol::WriteHeader(Writer, ServerProtocol::Message::INPUTS);
+	ServerProtocol::Write(Writer, Pending);
+	Socket.Send(Server, Buffer, Writer.GetSize());
+}
+
+float MatchClient::MoveOwnPaddle(const float Y, const PaddleCommand Command) const
+{
+	const Player& Own = (bPlayerOne) ? View.GetPlayerOne() : View.GetPlayerTwo();
+	const float HalfHeight = Own.GetSize().y / 2.0f;
+	return Player::Move(Y, HalfHeight, Command, Own.GetSpeed() * View.GetTickDelta(), static_cast<float>(View.GetScreenHeight()));
+}
+
+bool MatchClient::IsJoined() const
+{
+	return bJoined;
+}
+
+bool MatchClient::IsFinished() const
+{
+	return bJoined && !Snapshots.empty() && Snapshots.back().State == static_cast<uint8_t>(GameState::WIN);
+}
+
+bool MatchClient::IsPlayerOne() const
+{
+	return bPlayerOne;
+}
+
+uint32_t MatchClient::GetMatch() const
+{
+	return Match;
+}
+
+int MatchClient::GetTickRate() const
+{
+	return TickRate;
+}
+
+const Game& MatchClient::GetView() const
+{
+	return View;
+}
+
+const MatchClientStats& MatchClient::GetStats() const
+{
+	return Stats;
+}
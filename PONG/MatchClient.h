@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "Game.h"
+#include "MatchSettings.h"
+#include "PaddleController.h"
+#include "ServerProtocol.h"
+#include "SnapshotCodec.h"
+#include "pk/UdpSocket.h"
+
+struct MatchClientStats
+{
+	uint64_t Ticks = 0;
+	uint64_t SnapshotsReceived = 0;
+	// Arrived after a newer one, ignored
+	uint64_t StaleSnapshots = 0;
+	// Snapshots that moved the predicted paddle, and by how much
+	uint64_t Corrections = 0;
+	double TotalCorrection = 0.0;
+	float MaxCorrection = 0.f;
+	uint64_t InterpolatedTicks = 0;
+	// The render time ran past the newest snapshot
+	uint64_t ExtrapolatedTicks = 0;
+};
+
+// Client of a MatchServer. Its own paddle is predicted from the inputs the server has not applied yet
+// and corrected whenever a snapshot says where the server put it; the ball and the opponent
+// are shown a couple of snapshots in the past, interpolated between the two around that time.
+// The result lives in a headless view Game that is never ticked, only placed.
+class MatchClient
+{
+public:
+	MatchClient(UdpSocket& _Socket, const NetAddress& _Server, const MatchSettings& Settings, const PaddleController::SharedPtr& _Controller);
+
+	// One tick at the server tick rate: receive, decide, predict, interpolate and send
+	void Tick();
+
+	bool IsJoined() const;
+	// The server declared a winner
+	bool IsFinished() const;
+	bool IsPlayerOne() const;
+	uint32_t GetMatch() const;
+	int GetTickRate() const;
+
+	// Own paddle predicted, ball and opponent interpolated. Controllers decide on this.
+	const Game& GetView() const;
+	const MatchClientStats& GetStats() const;
+
+private:
+	void Receive(const uint8_t* Data, const int Size);
+	void Reconcile(const ServerProtocol::Snapshot& Latest);
+	void Interpolate();
+	void Send();
+
+	float MoveOwnPaddle(const float Y, const PaddleCommand Command) const;
+
+	UdpSocket& Socket;
+	NetAddress Server;
+	PaddleController::SharedPtr Controller;
+	Game View;
+
+	bool bJoined;
+	bool bPlayerOne;
+	uint32_t Match;
+	int TickRate;
+	int SnapshotInterval;
+
+	std::vector<PaddleCommand> Inputs;
+	// Predicted paddle height after each input
+	std::vector<float> Predicted;
+	int InputCount;
+	int Processed;
+	float PredictedY;
+
+	// Ordered by tick, oldest first
+	std::vector<ServerProtocol::Snapshot> Snapshots;
+	// Decoded snapshots, the baselines of the next ones
+	SnapshotCodec Codec;
+	SnapshotHistory Received;
+	uint32_t Acked;
+	int TicksSinceSnapshot;
+
+	MatchClientStats Stats;
+};
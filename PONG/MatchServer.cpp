@@ -0,0 +1,339 @@
+#include "MatchServer.h"
+
+#include <algorithm>
+
+#include "SpectatorServer.h"
+
+namespace
+{
+	constexpr int INPUT_RING = 256;
+	// Inputs a client may have queued, more would only add latency
+	constexpr int MAX_QUEUED_INPUTS = 8;
+	constexpr double CLIENT_TIMEOUT = 5.0;
+	// Final snapshots go on for a second, so clients learn the result despite losses
+	constexpr int END_SECONDS = 1;
+
+	int Slot(const int Tick)
+	{
+		return Tick & (INPUT_RING - 1);
+	}
+}
+
+MatchServer::MatchServer(UdpSocket& _Socket, const MatchSettings& _Settings, const int _MaxMatches,
+	const int _TickRate, const int _SnapshotInterval)
+	: Socket(_Socket), Spectators(nullptr), Settings(_Settings), Codec(_Settings), TickRate(std::max(_TickRate, 1)), SnapshotInterval(std::max(_SnapshotInterval, 1)),
+		Matches(std::max(_MaxMatches, 1)), Clients(2 * Matches.size()), WaitingMatch(-1), NextMatchId(1)
+{
+	for (Client& Entry : Clients)
+	{
+		Entry.Inputs.assign(INPUT_RING, PaddleCommand::HOLD);
+		Entry.InputTicks.assign(INPUT_RING, -1);
+	}
+}
+
+void MatchServer::SetSpectators(SpectatorServer* _Spectators)
+{
+	Spectators = _Spectators;
+}
+
+void MatchServer::Tick()
+{
+	const Clock::Nanoseconds Start = Clock::Now();
+
+	uint8_t Buffer[ServerProtocol::MAX_DATAGRAM];
+	NetAddress From;
+	int Size = 0;
+	while ((Size = Socket.Receive(Buffer, sizeof(Buffer), From)) >= 0)
+	{
+		Stats.DatagramsReceived++;
+		Receive(From, Buffer, Size);
+	}
+
+	for (int i = 0; i < static_cast<int>(Matches.size()); ++i)
+	{
+		TickMatch(i, Start);
+	}
+
+	const Clock::Nanoseconds Elapsed = Clock::Now() - Start;
+	Stats.Ticks++;
+	Stats.TickTime += Elapsed;
+	Stats.MaxTickTime = std::max(Stats.MaxTickTime, Elapsed);
+}
+
+void MatchServer::Receive(const NetAddress& From, const uint8_t* Data, const int Size)
+{
+	ByteReader Reader(Data, Size);
+	ServerProtocol::Message Type;
+	if (!ServerProtocol::ReadHeader(Reader, Type))
+	{
+		return;
+	}
+
+	if (Type == ServerProtocol::Message::JOIN)
+	{
+		Join(From);
+		return;
+	}
+
+	const std::unordered_map<uint64_t, int>::const_iterator Known = ClientsByAddress.find(MakeKey(From));
+	ServerProtocol::Inputs Received;
+	if (Type == ServerProtocol::Message::INPUTS && Known != ClientsByAddress.end() && ServerProtocol::Read(Reader, Received))
+	{
+		Client& Sender = Clients[Known->second];
+		Sender.LastHeard = Clock::Now();
+		Sender.Acked = std::max(Sender.Acked, Received.Acked);
+		StoreInputs(Sender, Received);
+	}
+}
+
+void MatchServer::Join(const NetAddress& From)
+{
+	const std::unordered_map<uint64_t, int>::const_iterator Known = ClientsByAddress.find(MakeKey(From));
+	if (Known != ClientsByAddress.end())
+	{
+		// The welcome got lost
+		SendWelcome(Known->second);
+		return;
+	}
+
+	if (WaitingMatch < 0)
+	{
+		const std::vector<Match>::iterator Free = std::find_if(Matches.begin(), Matches.end(),
+			[](const Match& Candidate) { return !Candidate.bActive; });
+		if (Free == Matches.end())
+		{
+			return;
+		}
+
+		WaitingMatch = static_cast<int>(Free - Matches.begin());
+		Match& Created = *Free;
+		Created.Id = NextMatchId++;
+		Created.Tick = 0;
+		Created.EndTicks = 0;
+		Created.bActive = true;
+		Created.Controllers[0] = std::make_shared<ScriptedController>();
+		Created.Controllers[1] = std::make_shared<ScriptedController>();
+		Created.Simulation = std::make_unique<Game>(Settings);
+		Created.Simulation->SetSeed(Created.Id);
+		Created.Simulation->SetEffectsEnabled(false);
+		Created.Simulation->SetTickRate(TickRate);
+		Created.Simulation->SetController(true, Created.Controllers[0]);
+		Created.Simulation->SetController(false, Created.Controllers[1]);
+		Created.Simulation->Begin();
+	}
+
+	const bool bPlayerOne = !Clients[2 * WaitingMatch].bConnected;
+	const int Index = 2 * WaitingMatch + (bPlayerOne ? 0 : 1);
+	Client& Joined = Clients[Index];
+	Joined.Address = From;
+	Joined.bConnected = true;
+	Joined.Received = 0;
+	Joined.Processed = 0;
+	Joined.Last = PaddleCommand::HOLD;
+	Joined.LastHeard = Clock::Now();
+	Joined.Sent.Clear();
+	Joined.SentCount = 0;
+	Joined.Acked = 0;
+	std::fill(Joined.InputTicks.begin(), Joined.InputTicks.end(), -1);
+	ClientsByAddress[MakeKey(From)] = Index;
+
+	SendWelcome(Index);
+
+	if (!bPlayerOne)
+	{
+		Matches[WaitingMatch].Simulation->StartMatch();
+		Stats.MatchesStarted++;
+		WaitingMatch = -1;
+	}
+}
+
+void MatchServer::StoreInputs(Client& Target, const ServerProtocol::Inputs& Data)
+{
+	for (int i = 0; i < Data.Count; ++i)
+	{
+		const int Tick = static_cast<int>(Data.Start) + i;
+		if (Tick < Target.Received || Tick >= Target.Processed + INPUT_RING)
+		{
+			continue;
+		}
+
+		Target.Inputs[Slot(Tick)] = Data.Get(i);
+		Target.InputTicks[Slot(Tick)] = Tick;
+	}
+
+	while (Target.InputTicks[Slot(Target.Received)] == Target.Received)
+	{
+		Target.Received++;
+	}
+}
+
+PaddleCommand MatchServer::NextInput(Client& Source)
+{
+	if (Source.Received - Source.Processed > MAX_QUEUED_INPUTS)
+	{
+		Stats.SkippedInputs += Source.Received - Source.Processed - MAX_QUEUED_INPUTS;
+		Source.Processed = Source.Received - MAX_QUEUED_INPUTS;
+	}
+
+	if (Source.Processed < Source.Received)
+	{
+		Source.Last = Source.Inputs[Slot(Source.Processed)];
+		Source.Processed++;
+	}
+	else
+	{
+		Stats.MissedInputs++;
+	}
+
+	return Source.Last;
+}
+
+void MatchServer::TickMatch(const int Index, const Clock::Nanoseconds Now)
+{
+	Match& Current = Matches[Index];
+	if (!Current.bActive)
+	{
+		return;
+	}
+
+	Client& PlayerOne = Clients[2 * Index];
+	Client& PlayerTwo = Clients[2 * Index + 1];
+	const Clock::Nanoseconds Timeout = Clock::FromSeconds(CLIENT_TIMEOUT);
+	if ((PlayerOne.bConnected && Now - PlayerOne.LastHeard > Timeout) || (PlayerTwo.bConnected && Now - PlayerTwo.LastHeard > Timeout))
+	{
+		CloseMatch(Index, false);
+		return;
+	}
+
+	Game& Simulation = *Current.Simulation;
+	if (Simulation.GetState() == GameState::MATCH)
+	{
+		Current.Controllers[0]->SetCommand(NextInput(PlayerOne));
+		Current.Controllers[1]->SetCommand(NextInput(PlayerTwo));
+		Simulation.Tick(Simulation.GetTickDelta());
+		Current.Tick++;
+		Stats.MatchTicks++;
+
+		if (Simulation.GetState() == GameState::WIN)
+		{
+			Current.EndTicks = END_SECONDS * TickRate;
+			Results.push_back(MatchResult{ Current.Id, Simulation.GetPlayerOneScore(), Simulation.GetPlayerTwoScore(), Current.Tick });
+		}
+	}
+	else if (Simulation.GetState() == GameState::WIN && --Current.EndTicks <= 0)
+	{
+		CloseMatch(Index, true);
+		return;
+	}
+
+	if (Spectators != nullptr && Spectators->HasAudience(Current.Id))
+	{
+		Spectators->Publish(Current.Id, ServerProtocol::Capture(*Current.Simulation, Current.Tick, 0));
+	}
+
+	// Matches are spread over the ticks of the interval, not all sent at once
+	if ((Stats.Ticks + Index) % SnapshotInterval == 0)
+	{
+		if (PlayerOne.bConnected)
+		{
+			SendSnapshot(2 * Index);
+		}
+		if (PlayerTwo.bConnected)
+		{
+			SendSnapshot(2 * Index + 1);
+		}
+	}
+}
+
+void MatchServer::CloseMatch(const int Index, const bool bFinished)
+{
+	Match& Closed = Matches[Index];
+	Closed.bActive = false;
+	Closed.Simulation.reset();
+
+	for (int Side = 0; Side < 2; ++Side)
+	{
+		Client& Leaving = Clients[2 * Index + Side];
+		if (Leaving.bConnected)
+		{
+			ClientsByAddress.erase(MakeKey(Leaving.Address));
+			Leaving.bConnected = false;
+		}
+	}
+
+	if (WaitingMatch == Index)
+	{
+		WaitingMatch = -1;
+	}
+
+	if (bFinished)
+	{
+		Stats.MatchesFinished++;
+	}
+	else
+	{
+		Stats.MatchesAbandoned++;
+	}
+}
+
+void MatchServer::SendWelcome(const int ClientIndex)
+{
+	const ServerProtocol::Welcome Data{ Matches[ClientIndex / 2].Id, static_cast<uint8_t>(ClientIndex % 2 == 0),
+		static_cast<uint16_t>(TickRate), static_cast<uint16_t>(SnapshotInterval) };
+
+	uint8_t Buffer[ServerProtocol::MAX_DATAGRAM];
+	ByteWriter Writer(Buffer, sizeof(Buffer));
+	ServerProtocol::WriteHeader(Writer, ServerProtocol::Message::WELCOME);
+	ServerProtocol::Write(Writer, Data);
+	Socket.Send(Clients[ClientIndex].Address, Buffer, Writer.GetSize());
+}
+
+void MatchServer::SendSnapshot(const int ClientIndex)
+{
+	const Match& Current = Matches[ClientIndex / 2];
+	Client& Receiver = Clients[ClientIndex];
+	QuantizedSnapshot State = Codec.Quantize(ServerProtocol::Capture(*Current.Simulation, Current.Tick,
+		static_cast<uint32_t>(Receiver.Processed)));
+	State.Sequence = ++Receiver.SentCount;
+	const QuantizedSnapshot* Baseline = (Receiver.Acked > 0) ? Receiver.Sent.Find(Receiver.Acked) : nullptr;
+
+	uint8_t Buffer[ServerProtocol::MAX_DATAGRAM];
+	ByteWriter Writer(Buffer, sizeof(Buffer));
+	ServerProtocol::WriteHeader(Writer, ServerProtocol::Message::SNAPSHOT);
+
+	BitWriter Bits(Buffer + Writer.GetSize(), sizeof(Buffer) - Writer.GetSize());
+	Codec.Encode(Bits, State, Baseline);
+	Receiver.Sent.Store(State);
+
+	Socket.Send(Receiver.Address, Buffer, Writer.GetSize() + Bits.GetSize());
+	Stats.SnapshotsSent++;
+	Stats.SnapshotBytes += Bits.GetSize();
+	Stats.FullSnapshots += (Baseline == nullptr || State.Sequence - Baseline->Sequence > SnapshotCodec::MAX_BASELINE_AGE) ? 1 : 0;
+}
+
+uint64_t MatchServer::MakeKey(const NetAddress& Address)
+{
+	return (static_cast<uint64_t>(Address.Host) << 16) | Address.Port;
+}
+
+int MatchServer::GetTickRate() const
+{
+	return TickRate;
+}
+
+int MatchServer::GetActiveMatches() const
+{
+	return static_cast<int>(std::count_if(Matches.begin(), Matches.end(), [](const Match& Candidate) { return Candidate.bActive; }));
+}
+
+const MatchServerStats& MatchServer::GetStats() const
+{
+	return Stats;
+}
+
+std::vector<MatchResult> MatchServer::TakeResults()
+{
+	std::vector<MatchResult> Taken;
+	Taken.swap(Results);
+	return Taken;
+}
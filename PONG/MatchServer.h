@@ -0,0 +1,124 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "Game.h"
+#include "MatchSettings.h"
+#include "PaddleController.h"
+#include "ServerProtocol.h"
+#include "SnapshotCodec.h"
+#include "pk/Clock.h"
+#include "pk/UdpSocket.h"
+
+class SpectatorServer;
+
+struct MatchServerStats
+{
+	uint64_t Ticks = 0;
+	uint64_t MatchTicks = 0;
+	// Receiving, simulating and sending, summed over every server tick
+	Clock::Nanoseconds TickTime = 0;
+	Clock::Nanoseconds MaxTickTime = 0;
+	uint64_t DatagramsReceived = 0;
+	uint64_t SnapshotsSent = 0;
+	// Encoded snapshot payload, without the datagram header
+	uint64_t SnapshotBytes = 0;
+	uint64_t FullSnapshots = 0;
+	// Ticks a client's input had not arrived yet and its previous command was repeated
+	uint64_t MissedInputs = 0;
+	// Inputs thrown away because a client ran too far ahead of the server
+	uint64_t SkippedInputs = 0;
+	int MatchesStarted = 0;
+	int MatchesFinished = 0;
+	int MatchesAbandoned = 0;
+};
+
+struct MatchResult
+{
+	uint32_t Match;
+	int PlayerOneScore;
+	int PlayerTwoScore;
+	uint32_t Ticks;
+};
+
+// Dedicated server owning the authoritative simulation of many matches, all ticked from one thread.
+// Clients joining are paired in order, each pair gets its own headless Game fed by their inputs.
+// Every SnapshotInterval ticks both clients get the match state and how many of their inputs it includes.
+class MatchServer
+{
+public:
+	MatchServer(UdpSocket& _Socket, const MatchSettings& _Settings, const int _MaxMatches,
+		const int _TickRate = 240, const int _SnapshotInterval = 4);
+
+	// Every tick of a watched match is published to its spectators
+	void SetSpectators(SpectatorServer* _Spectators);
+
+	// Receives, ticks every running match once and sends the snapshots that are due
+	void Tick();
+
+	int GetTickRate() const;
+	int GetActiveMatches() const;
+	const MatchServerStats& GetStats() const;
+	// Matches finished since the last call
+	std::vector<MatchResult> TakeResults();
+
+private:
+	struct Client
+	{
+		NetAddress Address;
+		bool bConnected = false;
+		std::vector<PaddleCommand> Inputs;
+		std::vector<int> InputTicks;
+		int Received = 0;
+		int Processed = 0;
+		PaddleCommand Last = PaddleCommand::HOLD;
+		Clock::Nanoseconds LastHeard = 0;
+		// Snapshots sent, the acknowledged one is the baseline of the next
+		SnapshotHistory Sent;
+		uint32_t SentCount = 0;
+		uint32_t Acked = 0;
+	};
+
+	struct Match
+	{
+		std::unique_ptr<Game> Simulation;
+		std::shared_ptr<ScriptedController> Controllers[2];
+		uint32_t Id = 0;
+		uint32_t Tick = 0;
+		int EndTicks = 0;
+		bool bActive = false;
+	};
+
+	void Receive(const NetAddress& From, const uint8_t* Data, const int Size);
+	void Join(const NetAddress& From);
+	void StoreInputs(Client& Target, const ServerProtocol::Inputs& Data);
+	PaddleCommand NextInput(Client& Source);
+
+	void TickMatch(const int Index, const Clock::Nanoseconds Now);
+	void CloseMatch(const int Index, const bool bFinished);
+
+	void SendWelcome(const int ClientIndex);
+	void SendSnapshot(const int ClientIndex);
+
+	static uint64_t MakeKey(const NetAddress& Address);
+
+	UdpSocket& Socket;
+	SpectatorServer* Spectators;
+	MatchSettings Settings;
+	SnapshotCodec Codec;
+	int TickRate;
+	int SnapshotInterval;
+
+	// Client 2 * i plays player one of match i, client 2 * i + 1 player two
+	std::vector<Match> Matches;
+	std::vector<Client> Clients;
+	std::unordered_map<uint64_t, int> ClientsByAddress;
+	int WaitingMatch;
+	uint32_t NextMatchId;
+
+	std::vector<MatchResult> Results;
+	MatchServerStats Stats;
+};
@@ -0,0 +1,43 @@
+#include "MatchSettings.h"
+
+namespace
+{
+	constexpr int DEFAULT_ARENA_WIDTH = 800;
+	constexpr int DEFAULT_ARENA_HEIGHT = 600;
+
+	constexpr float PLAYER_SPEED = 600.f;
+	// Gap between a paddle and its side of the arena
+	constexpr float PLAYER_MARGIN = 50.f;
+
+	constexpr float BALL_BASE_SPEED = 300.f;
+	constexpr float BALL_MAX_SPEED = 600.f;
+	constexpr float BALL_SPEED_INCREMENT = 50.f;
+
+	constexpr int WIN_SCORE = 5;
+}
+
+MatchSettings::MatchSettings()
+	: MatchSettings(glm::ivec2(DEFAULT_ARENA_WIDTH, DEFAULT_ARENA_HEIGHT))
+{
+}
+
+MatchSettings::MatchSettings(const glm::ivec2& _ArenaSize)
+	: ArenaSize(_ArenaSize), PlayerSpeed(PLAYER_SPEED),
+		BallDirection(1.f, 0.5f, 0.f), BallSpeed(BALL_BASE_SPEED), BallSpeedIncrement(BALL_SPEED_INCREMENT), BallMaxSpeed(BALL_MAX_SPEED),
+		WinScore(WIN_SCORE)
+{
+	const glm::vec2 ScreenCenter(ArenaSize.x / 2, ArenaSize.y / 2);
+
+	const float PlayerOffset = ScreenCenter.x - PLAYER_MARGIN;
+
+	const glm::vec3 PlayerOnePos(ScreenCenter.x - PlayerOffset, ScreenCenter.y, 0.f);
+	const glm::vec3 PlayerTwoPos(ScreenCenter.x + PlayerOffset, ScreenCenter.y, 0.f);
+	const glm::vec3 PlayerSize(6.5f, 80.f, 1.f);
+
+	const glm::vec3 BallBasePos(ScreenCenter.x, ScreenCenter.y, 1.f);
+	const glm::vec3 BallSize(10.f, 12.f, 1.f);
+
+	PlayerOne = Transform(PlayerOnePos, PlayerSize);
+	PlayerTwo = Transform(PlayerTwoPos, PlayerSize);
+	Ball = Transform(BallBasePos, BallSize);
+}
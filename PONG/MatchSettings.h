@@ -0,0 +1,26 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include "GameActor.h"
+
+// Everything needed to construct a Game, so matches can be set up outside main
+struct MatchSettings
+{
+	glm::ivec2 ArenaSize;
+
+	Transform PlayerOne;
+	Transform PlayerTwo;
+	float PlayerSpeed;
+
+	Transform Ball;
+	glm::vec3 BallDirection;
+	float BallSpeed;
+	float BallSpeedIncrement;
+	float BallMaxSpeed;
+
+	int WinScore;
+
+	MatchSettings();
+	MatchSettings(const glm::ivec2& _ArenaSize);
+};
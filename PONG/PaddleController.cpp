@@ -0,0 +1,139 @@
+#include "PaddleController.h"
+
+#include <cmath>
+
+#include "Game.h"
+#include "Trajectory.h"
+#include "pk/Window.h"
+
+KeyboardController::KeyboardController(const Window* _Window, const int _TopKey, const int _BottomKey)
+	: WindowPtr(_Window), TopKey(_TopKey), BottomKey(_BottomKey)
+{
+}
+
+PaddleCommand KeyboardController::Decide(const Player& Paddle, const Game& CurrentGame, const float Delta)
+{
+	if (WindowPtr == nullptr)
+	{
+		return PaddleCommand::HOLD;
+	}
+
+	const bool bTop = WindowPtr->IsPressed(TopKey);
+	const bool bBottom = WindowPtr->IsPressed(BottomKey);
+
+	if (bTop == bBottom)
+	{
+		return PaddleCommand::HOLD;
+	}
+
+	return (bTop) ? PaddleCommand::UP : PaddleCommand::DOWN;
+}
+
+ScriptedController::ScriptedController()
+	: Command(PaddleCommand::HOLD)
+{
+}
+
+void ScriptedController::SetCommand(const PaddleCommand NewCommand)
+{
+	Command = NewCommand;
+}
+
+PaddleCommand ScriptedController::Decide(const Player& Paddle, const Game& CurrentGame, const float Delta)
+{
+	return Command;
+}
+
+AIController::AIController(const float _ReactionDelay, const float _Error, const uint32_t _Seed)
+	: ReactionDelay(_ReactionDelay), Error(_Error), Rng(_Seed), TargetY(0.f), ReactionTimer(0.f),
+		bHasTarget(false), bBallIncoming(false), LastRallies(-1)
+{
+}
+
+void AIController::SetReactionDelay(const float NewDelay)
+{
+	ReactionDelay = NewDelay;
+}
+
+void AIController::SetError(const float NewError)
+{
+	Error = NewError;
+}
+
+float AIController::GetReactionDelay() const
+{
+	return ReactionDelay;
+}
+
+float AIController::GetError() const
+{
+	return Error;
+}
+
+void AIController::Reset(const uint32_t NewSeed)
+{
+	Rng.Seed(NewSeed);
+	TargetY = 0.f;
+	ReactionTimer = 0.f;
+	bHasTarget = false;
+	bBallIncoming = false;
+	LastRallies = -1;
+}
+
+PaddleCommand AIController::Decide(const Player& Paddle, const Game& CurrentGame, const float Delta)
+{
+	const ::Ball& CurrentBall = CurrentGame.GetBall();
+	const float PaddleX = Paddle.GetLocation().x;
+	const bool bIncoming = (CurrentBall.GetDirection().x < 0.f) == (PaddleX < CurrentGame.GetScreenCenter().x);
+	const int Rallies = CurrentGame.GetStats().Rallies;
+
+	// A paddle hit or a goal changes the heading, the reaction starts over
+	if (bIncoming != bBallIncoming || Rallies != LastRallies)
+	{
+		bBallIncoming = bIncoming;
+		LastRallies = Rallies;
+		ReactionTimer = ReactionDelay;
+		bHasTarget = false;
+	}
+
+	if (!bHasTarget)
+	{
+		ReactionTimer -= Delta;
+		if (ReactionTimer > 0.f)
+		{
+			return PaddleCommand::HOLD;
+		}
+
+		Plan(Paddle, CurrentGame);
+	}
+
+	const float Difference = TargetY - Paddle.GetLocation().y;
+	const float Step = Paddle.GetSpeed() * Delta;
+
+	// Closer than one step, moving would only overshoot
+	if (std::abs(Difference) < Step)
+	{
+		return PaddleCommand::HOLD;
+	}
+
+	return (Difference < 0.f) ? PaddleCommand::UP : PaddleCommand::DOWN;
+}
+
+void AIController::Plan(const Player& Paddle, const Game& CurrentGame)
+{
+	bHasTarget = true;
+
+	if (!bBallIncoming)
+	{
+		TargetY = CurrentGame.GetScreenCenter().y;
+		return;
+	}
+
+	const ::Ball& CurrentBall = CurrentGame.GetBall();
+	const float ArenaHeight = static_cast<float>(CurrentGame.GetScreenHeight());
+	const Trajectory::Intercept Landing = Trajectory::Predict(CurrentBall, Paddle.GetLocation().x, ArenaHeight);
+
+	// Uniform in [-Error, Error]
+	const float Miss = (Error > 0.f) ? ((Rng.Range(2001) - 1000) / 1000.f) * Error : 0.f;
+	TargetY = (Landing.bReaches ? Landing.Y : CurrentGame.GetScreenCenter().y) + Miss;
+}
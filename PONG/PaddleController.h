@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+
+#include "pk/Random.h"
+
+class Window;
+class Player;
+class Game;
+
+enum class PaddleCommand : uint8_t
+{
+	HOLD,
+	UP,
+	DOWN
+};
+
+// Source of paddle input, asked once per simulation tick
+class PaddleController
+{
+public:
+	typedef std::shared_ptr<PaddleController> SharedPtr;
+
+	virtual PaddleCommand Decide(const Player& Paddle, const Game& CurrentGame, const float Delta) = 0;
+	// Forgets any state and reseeds, so an episode can be played again. Stateless controllers ignore it.
+	virtual void Reset(const uint32_t NewSeed) {}
+
+	virtual ~PaddleController() = default;
+};
+
+class KeyboardController : public PaddleController
+{
+public:
+	KeyboardController(const Window* _Window, const int _TopKey, const int _BottomKey);
+
+	virtual PaddleCommand Decide(const Player& Paddle, const Game& CurrentGame, const float Delta) override;
+
+private:
+	const Window* WindowPtr;
+	int TopKey;
+	int BottomKey;
+};
+
+// Plays the command it was last given, for sessions that feed inputs tick by tick
+class ScriptedController : public PaddleController
+{
+public:
+	ScriptedController();
+
+	void SetCommand(const PaddleCommand NewCommand);
+
+	virtual PaddleCommand Decide(const Player& Paddle, const Game& CurrentGame, const float Delta) override;
+
+private:
+	PaddleCommand Command;
+};
+
+// Built-in opponent. Aims where the ball will cross its paddle, but only notices a new
+// ball heading after ReactionDelay seconds and misses the target by up to Error pixels.
+// Plans only when the heading changes, every other tick is a couple of comparisons.
+class AIController : public PaddleController
+{
+public:
+	AIController(const float _ReactionDelay, const float _Error, const uint32_t _Seed);
+
+	void SetReactionDelay(const float NewDelay);
+	void SetError(const float NewError);
+	float GetReactionDelay() const;
+	float GetError() const;
+	// Forgets the current plan and reseeds, a reused controller then plays like a new one
+	virtual void Reset(const uint32_t NewSeed) override;
+
+	virtual PaddleCommand Decide(const Player& Paddle, const Game& CurrentGame, const float Delta) override;
+
+private:
+	void Plan(const Player& Paddle, const Game& CurrentGame);
+
+	float ReactionDelay;
+	float Error;
+	Random Rng;
+
+	float TargetY;
+	float ReactionTimer;
+	bool bHasTarget;
+	bool bBallIncoming;
+	int LastRallies;
+};
@@ -1,14 +1,14 @@
 #include "Player.h"
 
-#include "pk/Window.h"
+#include "Game.h"
 
-Player::Player(const Transform& _Transform, const float _Speed, const int _TopKey, const int _BottomKey)
-	: GameActor(_Transform), TopKey(_TopKey), BottomKey(_BottomKey), Speed(_Speed)
+Player::Player(const Transform& _Transform, const float _Speed)
+	: GameActor(_Transform), Speed(_Speed), LastCommand(PaddleCommand::HOLD)
 {
 }
 
-Player::Player(const glm::vec3& _Location, const glm::vec3 _Size, const float _Speed, const int _TopKey, const int _BottomKey)
-	: GameActor(_Location, _Size), TopKey(_TopKey), BottomKey(_BottomKey), Speed(_Speed)
+Player::Player(const glm::vec3& _Location, const glm::vec3 _Size, const float _Speed)
+	: GameActor(_Location, _Size), Speed(_Speed), LastCommand(PaddleCommand::HOLD)
 {
 }
 
@@ -22,31 +22,58 @@ float Player::GetSpeed() const
 	return Speed;
 }
 
-void Player::Input(const Window& Window, const float Delta)
+void Player::SetController(const PaddleController::SharedPtr& NewController)
 {
-	GameActor::Input(Window, Delta);
+	Controller = NewController;
+}
+
+PaddleController::SharedPtr Player::GetController() const
+{
+	return Controller;
+}
+
+PaddleCommand Player::GetLastCommand() const
+{
+	return LastCommand;
+}
+
+void Player::Input(const float Delta)
+{
+	GameActor::Input(Delta);
+
+	// No controller attached, paddle holds its position
+	LastCommand = PaddleCommand::HOLD;
+	if (!Controller)
+	{
+		return;
+	}
+
+	const PaddleCommand Command = Controller->Decide(*this, *GetGame(), Delta);
+	LastCommand = Command;
+	if (Command == PaddleCommand::HOLD)
+	{
+		return;
+	}
 
 	const BoundingBox Box(GetBoundingBox());
 	glm::vec3 Location(GetLocation());
-	const float WindowHeight = static_cast<float>(Window.GetHeight());
+	const float ArenaHeight = static_cast<float>(GetGame()->GetScreenHeight());
 
-	const float Velocity = Speed * Delta;
+	Location.y = Move(Location.y, Box.ScaleOffset.y, Command, Speed * Delta, ArenaHeight);
+	SetLocation(Location);
+}
 
-	if (Window.IsPressed(TopKey))
+float Player::Move(const float Y, const float HalfHeight, const PaddleCommand Command, const float Velocity, const float ArenaHeight)
+{
+	if (Command == PaddleCommand::UP && (Y - HalfHeight) - Velocity > 0.f)
 	{
-		if ((Location.y - Box.ScaleOffset.y) - Velocity > 0.f)
-		{
-			Location.y -= Velocity;
-		}
+		return Y - Velocity;
 	}
 
-	if (Window.IsPressed(BottomKey))
+	if (Command == PaddleCommand::DOWN && (Y + HalfHeight) + Velocity < ArenaHeight)
 	{
-		if ((Location.y + Box.ScaleOffset.y) + Velocity < WindowHeight)
-		{
-			Location.y += Velocity;
-		}
+		return Y + Velocity;
 	}
 
-	SetLocation(Location);
+	return Y;
 }
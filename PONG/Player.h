@@ -1,20 +1,31 @@
 #pragma once
 
 #include "GameActor.h"
+#include "PaddleController.h"
+
 class Player : public GameActor
 {
 public:
-	Player(const Transform& _Transform, const float _Speed, const int _TopKey, const int _BottomKey);
-	Player(const glm::vec3& _Location, const glm::vec3 _Size, const float _Speed, const int _TopKey, const int _BottomKey);
+	Player(const Transform& _Transform, const float _Speed);
+	Player(const glm::vec3& _Location, const glm::vec3 _Size, const float _Speed);
 
 	void SetSpeed(const float NewSpeed);
 	float GetSpeed() const;
 
-	virtual void Input(const Window& Window, const float Delta) override;
+	void SetController(const PaddleController::SharedPtr& NewController);
+	PaddleController::SharedPtr GetController() const;
+	// What the controller asked for in the last Input
+	PaddleCommand GetLastCommand() const;
+
+	virtual void Input(const float Delta) override;
+
+	// Paddle height after one command, the paddle stops short of the arena edges.
+	// Shared with client side prediction, which has to move exactly like the simulation.
+	static float Move(const float Y, const float HalfHeight, const PaddleCommand Command, const float Velocity, const float ArenaHeight);
 
 private:
-	int TopKey;
-	int BottomKey;
 	float Speed;
-};
 
+	PaddleController::SharedPtr Controller;
+	PaddleCommand LastCommand;
+};
@@ -0,0 +1,455 @@
+#include "Replay.h"
+
+#include <algorithm>
+#include <cstring>
+#include <type_traits>
+
+#include "Game.h"
+#include "StateChecksum.h"
+
+static_assert(std::is_trivially_copyable<ReplayHeader>::value, "ReplayHeader is written to disk as is");
+static_assert(std::is_trivially_copyable<GameKeyframe>::value, "GameKeyframe is written to disk as is");
+
+namespace
+{
+	void CopyVector(float* Destination, const glm::vec3& Source)
+	{
+		Destination[0] = Source.x;
+		Destination[1] = Source.y;
+		Destination[2] = Source.z;
+	}
+
+	glm::vec3 ToVector(const float* Source)
+	{
+		return glm::vec3(Source[0], Source[1], Source[2]);
+	}
+}
+
+ReplaySettings ReplaySettings::From(const MatchSettings& Settings)
+{
+	ReplaySettings Result;
+	std::memset(&Result, 0, sizeof(Result));
+
+	Result.ArenaWidth = Settings.ArenaSize.x;
+	Result.ArenaHeight = Settings.ArenaSize.y;
+	CopyVector(Result.PlayerOneLocation, Settings.PlayerOne.Location);
+	CopyVector(Result.PlayerOneSize, Settings.PlayerOne.Size);
+	CopyVector(Result.PlayerTwoLocation, Settings.PlayerTwo.Location);
+	CopyVector(Result.PlayerTwoSize, Settings.PlayerTwo.Size);
+	Result.PlayerSpeed = Settings.PlayerSpeed;
+	CopyVector(Result.BallLocation, Settings.Ball.Location);
+	CopyVector(Result.BallSize, Settings.Ball.Size);
+	CopyVector(Result.BallDirection, Settings.BallDirection);
+	Result.BallSpeed = Settings.BallSpeed;
+	Result.BallSpeedIncrement = Settings.BallSpeedIncrement;
+	Result.BallMaxSpeed = Settings.BallMaxSpeed;
+	Result.WinScore = Settings.WinScore;
+
+	return Result;
+}
+
+MatchSettings ReplaySettings::ToMatchSettings() const
+{
+	MatchSettings Settings(glm::ivec2(ArenaWidth, ArenaHeight));
+	Settings.PlayerOne = Transform(ToVector(PlayerOneLocation), ToVector(PlayerOneSize));
+	Settings.PlayerTwo = Transform(ToVector(PlayerTwoLocation), ToVector(PlayerTwoSize));
+	Settings.PlayerSpeed = PlayerSpeed;
+	Settings.Ball = Transform(ToVector(BallLocation), ToVector(BallSize));
+	Settings.BallDirection = ToVector(BallDirection);
+	Settings.BallSpeed = BallSpeed;
+	Settings.BallSpeedIncrement = BallSpeedIncrement;
+	Settings.BallMaxSpeed = BallMaxSpeed;
+	Settings.WinScore = WinScore;
+
+	return Settings;
+}
+
+uint8_t ReplayInput::Encode(const PaddleCommand PlayerOne, const PaddleCommand PlayerTwo)
+{
+	return static_cast<uint8_t>(static_cast<uint8_t>(PlayerOne) | (static_cast<uint8_t>(PlayerTwo) << 2));
+}
+
+PaddleCommand ReplayInput::Decode(const uint8_t Input, const bool bPlayerOne)
+{
+	const uint8_t Bits = (bPlayerOne) ? (Input & 0x3) : ((Input >> 2) & 0x3);
+	return (Bits <= static_cast<uint8_t>(PaddleCommand::DOWN)) ? static_cast<PaddleCommand>(Bits) : PaddleCommand::HOLD;
+}
+
+ReplayRecorder::ReplayRecorder(const std::string& _Path, const MatchSettings& Settings, const Game& RecordedGame,
+	const int _KeyframeInterval, const bool _bChecksums, const size_t _BufferSize)
+	: Path(_Path), File(_Path, std::ios::binary | std::ios::trunc), Written(0), BufferSize(std::max<size_t>(_BufferSize, 1)), Used(0), Active(0),
+		PendingData(nullptr), PendingSize(0), bStopping(false), bClosed(false), bWriteFailed(false)
+{
+	if (!File.is_open())
+	{
+		throw WriteError("Unable to open replay file " + Path);
+	}
+
+	std::memset(&Header, 0, sizeof(Header));
+	Header.Magic = ReplayHeader::MAGIC;
+	Header.Version = ReplayHeader::VERSION;
+	Header.Seed = RecordedGame.GetSeed();
+	Header.TickRate = static_cast<uint32_t>(RecordedGame.GetTickRate());
+	Header.bEffectsEnabled = RecordedGame.AreEffectsEnabled() ? 1 : 0;
+	Header.KeyframeInterval = static_cast<uint32_t>(std::max(_KeyframeInterval, 1));
+	Header.bChecksums = (_bChecksums) ? 1 : 0;
+	Header.TickSize = static_cast<uint32_t>(sizeof(uint8_t) + ((_bChecksums) ? sizeof(uint64_t) : 0));
+	Header.Settings = ReplaySettings::From(Settings);
+
+	// Rewritten on close, once tick count and final state are known
+	if (!File.write(reinterpret_cast<const char*>(&Header), sizeof(Header)))
+	{
+		throw WriteError("Unable to write replay file " + Path);
+	}
+
+	Buffers[0].resize(BufferSize);
+	Buffers[1].resize(BufferSize);
+	Index.reserve(1024);
+
+	Writer = std::thread(&ReplayRecorder::WriterLoop, this);
+}
+
+ReplayRecorder::~ReplayRecorder()
+{
+	// Not closed: the inputs are still saved, without a final state to check against
+	Finish();
+}
+
+bool ReplayRecorder::NeedsKeyframe() const
+{
+	return Header.TickCount % Header.KeyframeInterval == 0;
+}
+
+void ReplayRecorder::RecordKeyframe(const GameKeyframe& Keyframe)
+{
+	ReplayIndexEntry Entry;
+	Entry.Tick = Header.TickCount;
+	Entry.Padding = 0;
+	Entry.Offset = sizeof(ReplayHeader) + Written;
+	Index.push_back(Entry);
+
+	Append(&Keyframe, sizeof(Keyframe));
+}
+
+void ReplayRecorder::Record(const PaddleCommand PlayerOne, const PaddleCommand PlayerTwo)
+{
+	const uint8_t Input = ReplayInput::Encode(PlayerOne, PlayerTwo);
+	Append(&Input, sizeof(Input));
+	Header.TickCount++;
+}
+
+void ReplayRecorder::RecordChecksum(const uint64_t Checksum)
+{
+	if (Header.bChecksums != 0)
+	{
+		Append(&Checksum, sizeof(Checksum));
+	}
+}
+
+void ReplayRecorder::Close(const Game& RecordedGame)
+{
+	if (bClosed)
+	{
+		return;
+	}
+
+	const glm::vec3 BallLocation = RecordedGame.GetBall().GetLocation();
+	Header.FinalPlayerOneScore = RecordedGame.GetPlayerOneScore();
+	Header.FinalPlayerTwoScore = RecordedGame.GetPlayerTwoScore();
+	Header.FinalBallLocation[0] = BallLocation.x;
+	Header.FinalBallLocation[1] = BallLocation.y;
+
+	Finish();
+	if (bWriteFailed)
+	{
+		throw WriteError("Unable to write replay file " + Path);
+	}
+}
+
+void ReplayRecorder::Finish()
+{
+	if (bClosed)
+	{
+		return;
+	}
+
+	Submit();
+
+	{
+		std::lock_guard<std::mutex> Lock(Mutex);
+		bStopping = true;
+	}
+	Condition.notify_all();
+	Writer.join();
+	bClosed = true;
+
+	// The writer is done, the file position is right after the last block
+	Header.KeyframeCount = static_cast<uint32_t>(Index.size());
+	Header.IndexOffset = sizeof(ReplayHeader) + Written;
+	File.write(reinterpret_cast<const char*>(Index.data()), Index.size() * sizeof(ReplayIndexEntry));
+
+	File.seekp(0);
+	File.write(reinterpret_cast<const char*>(&Header), sizeof(Header));
+	File.close();
+	// Index, header and the final flush can fail as well
+	if (File.fail())
+	{
+		bWriteFailed = true;
+	}
+}
+
+uint32_t ReplayRecorder::GetTickCount() const
+{
+	return Header.TickCount;
+}
+
+void ReplayRecorder::Append(const void* Data, const size_t Size)
+{
+	const uint8_t* Bytes = static_cast<const uint8_t*>(Data);
+	size_t Remaining = Size;
+	while (Remaining > 0)
+	{
+		const size_t Chunk = std::min(Remaining, BufferSize - Used);
+		std::memcpy(Buffers[Active].data() + Used, Bytes, Chunk);
+		Used += Chunk;
+		Bytes += Chunk;
+		Remaining -= Chunk;
+
+		if (Used == BufferSize)
+		{
+			Submit();
+		}
+	}
+
+	Written += Size;
+}
+
+void ReplayRecorder::Submit()
+{
+	if (Used == 0)
+	{
+		return;
+	}
+
+	std::unique_lock<std::mutex> Lock(Mutex);
+
+	// Only blocks if the disk is slower than a whole buffer of ticks
+	Condition.wait(Lock, [this]() { return PendingData == nullptr; });
+	PendingData = Buffers[Active].data();
+	PendingSize = Used;
+	Lock.unlock();
+	Condition.notify_all();
+
+	Active = 1 - Active;
+	Used = 0;
+}
+
+void ReplayRecorder::WriterLoop()
+{
+	std::unique_lock<std::mutex> Lock(Mutex);
+	while (true)
+	{
+		Condition.wait(Lock, [this]() { return PendingData != nullptr || bStopping; });
+		if (PendingData == nullptr)
+		{
+			return;
+		}
+
+		const uint8_t* Data = PendingData;
+		const size_t Size = PendingSize;
+
+		Lock.unlock();
+		const bool bWritten = static_cast<bool>(File.write(reinterpret_cast<const char*>(Data), Size));
+		Lock.lock();
+
+		// Later blocks are dropped by the failed stream, Close reports it
+		bWriteFailed = bWriteFailed || !bWritten;
+		PendingData = nullptr;
+		Condition.notify_all();
+	}
+}
+
+Replay::Replay(const std::string& _Path)
+	: Path(_Path)
+{
+	std::ifstream File(Path, std::ios::binary);
+	if (!File.read(reinterpret_cast<char*>(&Header), sizeof(Header)))
+	{
+		throw LoadError("Unable to read replay " + Path);
+	}
+
+	if (Header.Magic != ReplayHeader::MAGIC || Header.Version != ReplayHeader::VERSION)
+	{
+		throw LoadError("Not a supported replay file " + Path);
+	}
+
+	// Input byte, then the checksum when there is one
+	const uint64_t MinTickSize = sizeof(uint8_t) + (Header.bChecksums != 0 ? sizeof(uint64_t) : 0);
+	if (Header.KeyframeInterval == 0 || Header.TickSize < MinTickSize)
+	{
+		throw LoadError("Corrupted replay " + Path);
+	}
+
+	// One keyframe opens every block, the last block may be short
+	const uint64_t ExpectedKeyframes = (static_cast<uint64_t>(Header.TickCount) + Header.KeyframeInterval - 1) / Header.KeyframeInterval;
+	const uint64_t BlocksSize = Header.IndexOffset - sizeof(ReplayHeader);
+	const uint64_t ExpectedSize = static_cast<uint64_t>(Header.KeyframeCount) * sizeof(GameKeyframe) + static_cast<uint64_t>(Header.TickCount) * Header.TickSize;
+	if (Header.KeyframeCount != ExpectedKeyframes || Header.IndexOffset < sizeof(ReplayHeader) || BlocksSize != ExpectedSize)
+	{
+		throw LoadError("Corrupted replay " + Path);
+	}
+
+	Blocks.resize(static_cast<size_t>(BlocksSize));
+	Index.resize(Header.KeyframeCount);
+	if (!File.read(reinterpret_cast<char*>(Blocks.data()), Blocks.size())
+		|| !File.read(reinterpret_cast<char*>(Index.data()), Index.size() * sizeof(ReplayIndexEntry)))
+	{
+		throw LoadError("Truncated replay " + Path);
+	}
+
+	// Lookups trust the index, so it must describe exactly the blocks the header implies
+	const uint64_t BlockSize = sizeof(GameKeyframe) + static_cast<uint64_t>(Header.KeyframeInterval) * Header.TickSize;
+	for (size_t i = 0; i < Index.size(); ++i)
+	{
+		if (Index[i].Tick != i * Header.KeyframeInterval || Index[i].Offset != sizeof(ReplayHeader) + i * BlockSize)
+		{
+			throw LoadError("Corrupted replay index " + Path);
+		}
+	}
+}
+
+const ReplayHeader& Replay::GetHeader() const
+{
+	return Header;
+}
+
+MatchSettings Replay::GetSettings() const
+{
+	return Header.Settings.ToMatchSettings();
+}
+
+int Replay::GetTickCount() const
+{
+	return static_cast<int>(Header.TickCount);
+}
+
+PaddleCommand Replay::GetCommand(const int Tick, const bool bPlayerOne) const
+{
+	if (Tick < 0 || Tick >= GetTickCount())
+	{
+		return PaddleCommand::HOLD;
+	}
+
+	return ReplayInput::Decode(Blocks[GetTickOffset(Tick)], bPlayerOne);
+}
+
+bool Replay::HasChecksums() const
+{
+	return Header.bChecksums != 0;
+}
+
+uint64_t Replay::GetChecksum(const int Tick) const
+{
+	if (!HasChecksums() || Tick < 0 || Tick >= GetTickCount())
+	{
+		return 0;
+	}
+
+	uint64_t Checksum;
+	std::memcpy(&Checksum, Blocks.data() + GetTickOffset(Tick) + sizeof(uint8_t), sizeof(Checksum));
+	return Checksum;
+}
+
+size_t Replay::GetTickOffset(const int Tick) const
+{
+	// Each block starts with a keyframe, ticks follow
+	const int Block = Tick / static_cast<int>(Header.KeyframeInterval);
+	const uint64_t Offset = Index[Block].Offset - sizeof(ReplayHeader) + sizeof(GameKeyframe) + static_cast<uint64_t>(Tick - Index[Block].Tick) * Header.TickSize;
+	return static_cast<size_t>(Offset);
+}
+
+std::unique_ptr<Game> Replay::CreateGame(const SharedPtr& Data)
+{
+	const ReplayHeader& Recorded = Data->GetHeader();
+
+	std::unique_ptr<Game> PlaybackGame = std::make_unique<Game>(Data->GetSettings());
+	PlaybackGame->SetSeed(Recorded.Seed);
+	PlaybackGame->SetTickRate(static_cast<int>(Recorded.TickRate));
+	PlaybackGame->SetEffectsEnabled(Recorded.bEffectsEnabled != 0);
+	PlaybackGame->SetController(true, std::make_shared<ReplayController>(Data, true));
+	PlaybackGame->SetController(false, std::make_shared<ReplayController>(Data, false));
+
+	return PlaybackGame;
+}
+
+void Replay::Step(Game& PlaybackGame)
+{
+	if (PlaybackGame.GetState() != GameState::MATCH)
+	{
+		PlaybackGame.StartMatch();
+	}
+
+	PlaybackGame.Tick(PlaybackGame.GetTickDelta());
+}
+
+int Replay::Verify(Game& PlaybackGame, uint8_t& Mask) const
+{
+	Mask = 0;
+	for (int Tick = 0; Tick < GetTickCount(); ++Tick)
+	{
+		Step(PlaybackGame);
+
+		if (HasChecksums() && PlaybackGame.GetChecksum() != GetChecksum(Tick))
+		{
+			Mask = StateChecksum::Compare(GetChecksum(Tick), PlaybackGame.GetChecksum());
+			return Tick;
+		}
+	}
+
+	return -1;
+}
+
+void Replay::Seek(Game& PlaybackGame, const int Tick) const
+{
+	if (Index.empty())
+	{
+		return;
+	}
+
+	const int Target = std::min(std::max(Tick, 0), GetTickCount());
+	const size_t Block = std::min(static_cast<size_t>(Target / Header.KeyframeInterval), Index.size() - 1);
+	const ReplayIndexEntry& Entry = Index[Block];
+
+	GameKeyframe Keyframe;
+	std::memcpy(&Keyframe, Blocks.data() + (Entry.Offset - sizeof(ReplayHeader)), sizeof(Keyframe));
+	PlaybackGame.RestoreKeyframe(Keyframe);
+
+	const Player* Paddles[] = { &PlaybackGame.GetPlayerOne(), &PlaybackGame.GetPlayerTwo() };
+	for (const Player* Paddle : Paddles)
+	{
+		if (const std::shared_ptr<ReplayController> Controller = std::dynamic_pointer_cast<ReplayController>(Paddle->GetController()))
+		{
+			Controller->SetCursor(static_cast<int>(Entry.Tick));
+		}
+	}
+
+	for (int Current = static_cast<int>(Entry.Tick); Current < Target; ++Current)
+	{
+		Step(PlaybackGame);
+	}
+}
+
+ReplayController::ReplayController(const Replay::SharedPtr& _Data, const bool _bPlayerOne)
+	: Data(_Data), bPlayerOne(_bPlayerOne), Cursor(0)
+{
+}
+
+PaddleCommand ReplayController::Decide(const Player& Paddle, const Game& CurrentGame, const float Delta)
+{
+	return Data->GetCommand(Cursor++, bPlayerOne);
+}
+
+void ReplayController::SetCursor(const int Tick)
+{
+	Cursor = Tick;
+}
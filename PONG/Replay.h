@@ -0,0 +1,201 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Game.h"
+#include "MatchSettings.h"
+#include "PaddleController.h"
+
+// Replay file: a ReplayHeader, then blocks made of a GameKeyframe followed by the next KeyframeInterval
+// ticks. A tick is one byte with both paddle commands, then optionally the StateChecksum after it. An index of
+// (tick, file offset) pairs closes the file, so playback can seek without simulating from the start.
+// Seed, tick rate and match settings in the header rebuild the exact same Game,
+// the final state is written on close so playback can be checked against it.
+
+// MatchSettings without glm types, so the layout on disk is fixed
+struct ReplaySettings
+{
+	int32_t ArenaWidth;
+	int32_t ArenaHeight;
+	float PlayerOneLocation[3];
+	float PlayerOneSize[3];
+	float PlayerTwoLocation[3];
+	float PlayerTwoSize[3];
+	float PlayerSpeed;
+	float BallLocation[3];
+	float BallSize[3];
+	float BallDirection[3];
+	float BallSpeed;
+	float BallSpeedIncrement;
+	float BallMaxSpeed;
+	int32_t WinScore;
+
+	static ReplaySettings From(const MatchSettings& Settings);
+	MatchSettings ToMatchSettings() const;
+};
+
+struct ReplayHeader
+{
+	static constexpr uint32_t MAGIC = 0x4C505250; // "PRPL"
+	static constexpr uint32_t VERSION = 3;
+
+	uint32_t Magic;
+	uint32_t Version;
+	uint32_t Seed;
+	uint32_t TickRate;
+	uint32_t TickCount;
+	uint32_t bEffectsEnabled;
+	uint32_t KeyframeInterval;
+	uint32_t KeyframeCount;
+	// Input byte, plus 8 checksum bytes when checksums are recorded
+	uint32_t TickSize;
+	uint32_t bChecksums;
+	uint64_t IndexOffset;
+	ReplaySettings Settings;
+
+	int32_t FinalPlayerOneScore;
+	int32_t FinalPlayerTwoScore;
+	float FinalBallLocation[2];
+};
+
+struct ReplayIndexEntry
+{
+	uint32_t Tick;
+	uint32_t Padding;
+	// From the start of the file, where the keyframe of Tick begins
+	uint64_t Offset;
+};
+
+namespace ReplayInput
+{
+	uint8_t Encode(const PaddleCommand PlayerOne, const PaddleCommand PlayerTwo);
+	PaddleCommand Decode(const uint8_t Input, const bool bPlayerOne);
+}
+
+// Records the inputs of every tick. Inputs go to a preallocated buffer, full buffers
+// are written by a background thread while the game keeps filling the other one.
+class ReplayRecorder
+{
+public:
+	typedef std::unique_ptr<ReplayRecorder> UniquePtr;
+
+	static constexpr size_t DEFAULT_BUFFER_SIZE = 64 * 1024;
+	// Shorter intervals seek faster and make bigger files
+	static constexpr int DEFAULT_KEYFRAME_INTERVAL = 240;
+
+	// Game must already have its seed and tick rate set
+	ReplayRecorder(const std::string& _Path, const MatchSettings& Settings, const Game& RecordedGame,
+		const int _KeyframeInterval = DEFAULT_KEYFRAME_INTERVAL, const bool _bChecksums = true, const size_t _BufferSize = DEFAULT_BUFFER_SIZE);
+	~ReplayRecorder();
+
+	ReplayRecorder(const ReplayRecorder&) = delete;
+	ReplayRecorder& operator=(const ReplayRecorder&) = delete;
+
+	// Asked by the game at the start of every tick, before the inputs of that tick
+	bool NeedsKeyframe() const;
+	void RecordKeyframe(const GameKeyframe& Keyframe);
+	void Record(const PaddleCommand PlayerOne, const PaddleCommand PlayerTwo);
+	// Called once the tick is simulated, ignored if the recorder does not keep checksums
+	void RecordChecksum(const uint64_t Checksum);
+	// Flushes the inputs and writes the final state of the game into the header.
+	// Throws WriteError if any write failed, the replay on disk is then incomplete.
+	void Close(const Game& RecordedGame);
+
+	uint32_t GetTickCount() const;
+
+	class WriteError : public std::runtime_error
+	{
+		using std::runtime_error::runtime_error;
+	};
+
+private:
+	void Append(const void* Data, const size_t Size);
+	void Submit();
+	void Finish();
+	void WriterLoop();
+
+	std::string Path;
+	std::ofstream File;
+	ReplayHeader Header;
+	std::vector<ReplayIndexEntry> Index;
+	uint64_t Written;
+
+	std::vector<uint8_t> Buffers[2];
+	size_t BufferSize;
+	size_t Used;
+	int Active;
+
+	std::thread Writer;
+	std::mutex Mutex;
+	std::condition_variable Condition;
+	const uint8_t* PendingData;
+	size_t PendingSize;
+	bool bStopping;
+	bool bClosed;
+	// Set by the writer thread, reported by Close
+	bool bWriteFailed;
+};
+
+class Replay
+{
+public:
+	typedef std::shared_ptr<Replay> SharedPtr;
+
+	Replay(const std::string& _Path);
+
+	const ReplayHeader& GetHeader() const;
+	MatchSettings GetSettings() const;
+	int GetTickCount() const;
+	PaddleCommand GetCommand(const int Tick, const bool bPlayerOne) const;
+	bool HasChecksums() const;
+	// Checksum of the recorded game right after Tick was simulated
+	uint64_t GetChecksum(const int Tick) const;
+
+	// Builds the recorded game with a replay controller on both paddles, ready to Begin
+	static std::unique_ptr<Game> CreateGame(const SharedPtr& Data);
+	// Advances a playback game by one recorded tick, the recording kept playing after a win too
+	static void Step(Game& PlaybackGame);
+	// Steps through the whole replay comparing checksums, returns the first diverging tick or -1.
+	// Mask gets the StateChecksum fields that differ there.
+	int Verify(Game& PlaybackGame, uint8_t& Mask) const;
+	// Puts a game made by CreateGame in the state it had after Tick ticks: restores the closest
+	// keyframe before it, then simulates at most KeyframeInterval - 1 ticks
+	void Seek(Game& PlaybackGame, const int Tick) const;
+
+	class LoadError : public std::runtime_error
+	{
+		using std::runtime_error::runtime_error;
+	};
+
+private:
+	std::string Path;
+	ReplayHeader Header;
+	std::vector<ReplayIndexEntry> Index;
+	// Everything between header and index, as in the file
+	std::vector<uint8_t> Blocks;
+
+	size_t GetTickOffset(const int Tick) const;
+};
+
+// Feeds a paddle the commands of a replay, one per tick, then holds
+class ReplayController : public PaddleController
+{
+public:
+	ReplayController(const Replay::SharedPtr& _Data, const bool _bPlayerOne);
+
+	virtual PaddleCommand Decide(const Player& Paddle, const Game& CurrentGame, const float Delta) override;
+	void SetCursor(const int Tick);
+
+private:
+	Replay::SharedPtr Data;
+	bool bPlayerOne;
+	int Cursor;
+};
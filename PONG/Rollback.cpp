@@ -0,0 +1,332 @@
+#include "Rollback.h"
+
+#include <algorithm>
+#include <climits>
+
+#include "Player.h"
+#include "pk/ByteStream.h"
+
+namespace
+{
+	constexpr uint8_t MAGIC_FIRST = 'P';
+	constexpr uint8_t MAGIC_SECOND = 'R';
+	constexpr uint8_t HELLO = 1;
+	constexpr uint8_t INPUTS = 2;
+
+	// Power of two well above MAX_ROLLBACK + MAX_INPUT_DELAY, the farthest a peer can run ahead
+	constexpr int INPUT_RING = 256;
+	constexpr int MAX_INPUTS_PER_DATAGRAM = 64;
+	constexpr int MAX_DATAGRAM = 64;
+	constexpr int NO_ROLLBACK = INT_MAX;
+
+	int Slot(const int Tick)
+	{
+		return Tick & (INPUT_RING - 1);
+	}
+
+	// Four commands per byte, two bits each
+	PaddleCommand Unpack(const uint8_t* Packed, const int Index)
+	{
+		return static_cast<PaddleCommand>((Packed[Index / 4] >> (2 * (Index % 4))) & 3);
+	}
+}
+
+RollbackSession::RollbackSession(Game& _Game, UdpSocket& _Socket, const NetAddress& _Remote, const bool _bLocalPlayerOne,
+	const int _MaxRollback, const int _InputDelay)
+	: GameRef(_Game), Socket(_Socket), Remote(_Remote), bLocalPlayerOne(_bLocalPlayerOne),
+		MaxRollback(std::min(std::max(_MaxRollback, 1), MAX_ROLLBACK)),
+		LocalController(std::make_shared<ScriptedController>()), RemoteController(std::make_shared<ScriptedController>()),
+		bConnected(false), CurrentTick(0), RollbackTick(NO_ROLLBACK), LocalCount(std::min(std::max(_InputDelay, 0), MAX_INPUT_DELAY)),
+		RemoteConfirmed(0), RemoteAck(0),
+		LocalInputs(INPUT_RING, PaddleCommand::HOLD), RemoteInputs(INPUT_RING, PaddleCommand::HOLD), RemoteTicks(INPUT_RING, -1),
+		UsedRemote(INPUT_RING, PaddleCommand::HOLD), Checksums(INPUT_RING, 0), Snapshots(MaxRollback + 1),
+		RemoteChecksumTicks(INPUT_RING, -1), RemoteChecksums(INPUT_RING, 0), ComparedTick(0), LastComparedTick(-1)
+{
+	const Player& LocalPlayer = (bLocalPlayerOne) ? GameRef.GetPlayerOne() : GameRef.GetPlayerTwo();
+	LocalSource = LocalPlayer.GetController();
+
+	GameRef.SetController(bLocalPlayerOne, LocalController);
+	GameRef.SetController(!bLocalPlayerOne, RemoteController);
+}
+
+bool RollbackSession::Advance()
+{
+	Poll();
+
+	bool bTicked = false;
+	if (bConnected)
+	{
+		if (RollbackTick != NO_ROLLBACK)
+		{
+			Rollback();
+		}
+
+		// Stop on the tick the match ended, a rollback may still bring it back
+		const bool bMatchOver = GameRef.GetState() != GameState::MATCH;
+		if (!bMatchOver && CurrentTick - RemoteConfirmed >= MaxRollback)
+		{
+			Stats.Stalls++;
+		}
+		else if (!bMatchOver)
+		{
+			const Player& LocalPlayer = (bLocalPlayerOne) ? GameRef.GetPlayerOne() : GameRef.GetPlayerTwo();
+			const PaddleCommand Command = (LocalSource != nullptr)
+				? LocalSource->Decide(LocalPlayer, GameRef, GameRef.GetTickDelta()) : PaddleCommand::HOLD;
+			LocalInputs[Slot(LocalCount)] = Command;
+			LocalCount++;
+
+			SimulateTick(CurrentTick);
+			CurrentTick++;
+			Stats.Ticks++;
+			bTicked = true;
+		}
+
+		CompareChecksums();
+	}
+
+	Send();
+	return bTicked;
+}
+
+void RollbackSession::Poll()
+{
+	uint8_t Buffer[512];
+	NetAddress From;
+	int Size = 0;
+	while ((Size = Socket.Receive(Buffer, sizeof(Buffer), From)) >= 0)
+	{
+		if (From == Remote)
+		{
+			Stats.PacketsReceived++;
+			Receive(Buffer, Size);
+		}
+	}
+}
+
+void RollbackSession::Receive(const uint8_t* Data, const int Size)
+{
+	ByteReader Reader(Data, Size);
+	const uint8_t First = Reader.Read8();
+	const uint8_t Second = Reader.Read8();
+	const uint8_t Type = Reader.Read8();
+	if (!Reader.IsValid() || First != MAGIC_FIRST || Second != MAGIC_SECOND)
+	{
+		return;
+	}
+
+	if (Type == HELLO)
+	{
+		const uint32_t Seed = Reader.Read32();
+		const bool bEffects = Reader.Read8() != 0;
+		if (!Reader.IsValid())
+		{
+			return;
+		}
+
+		if (Seed != GameRef.GetSeed() || bEffects != GameRef.AreEffectsEnabled())
+		{
+			throw Error("Session Error: the peer plays with another seed or effects setting");
+		}
+	}
+	else if (Type == INPUTS)
+	{
+		const int Ack = static_cast<int>(Reader.Read32());
+		const int ChecksumTick = static_cast<int>(Reader.Read32());
+		const uint64_t Checksum = Reader.Read64();
+		const uint32_t Start = Reader.Read32();
+		const int Count = std::min<int>(Reader.Read8(), MAX_INPUTS_PER_DATAGRAM);
+		if (!Reader.IsValid() || Reader.GetRemaining() < (Count + 3) / 4)
+		{
+			return;
+		}
+
+		RemoteAck = std::max(RemoteAck, Ack);
+		ReceiveInputs(Start, Count, Reader.GetCursor());
+
+		if (ChecksumTick >= 0 && ChecksumTick < ComparedTick)
+		{
+			CompareChecksum(ChecksumTick, Checksum);
+		}
+		else if (ChecksumTick >= ComparedTick)
+		{
+			RemoteChecksumTicks[Slot(ChecksumTick)] = ChecksumTick;
+			RemoteChecksums[Slot(ChecksumTick)] = Checksum;
+		}
+	}
+	else
+	{
+		return;
+	}
+
+	// Anything from the peer means it is up, the match starts on the first tick of both
+	if (!bConnected)
+	{
+		bConnected = true;
+		GameRef.StartMatch();
+	}
+}
+
+void RollbackSession::ReceiveInputs(const uint32_t Start, const int Count, const uint8_t* Packed)
+{
+	for (int i = 0; i < Count; ++i)
+	{
+		const int Tick = static_cast<int>(Start) + i;
+		const int Index = Slot(Tick);
+		if (Tick < RemoteConfirmed || RemoteTicks[Index] == Tick)
+		{
+			continue;
+		}
+
+		const PaddleCommand Command = Unpack(Packed, i);
+		RemoteInputs[Index] = Command;
+		RemoteTicks[Index] = Tick;
+
+		if (Tick < CurrentTick && UsedRemote[Index] != Command)
+		{
+			RollbackTick = std::min(RollbackTick, Tick);
+		}
+	}
+
+	while (RemoteTicks[Slot(RemoteConfirmed)] == RemoteConfirmed)
+	{
+		RemoteConfirmed++;
+	}
+}
+
+void RollbackSession::CompareChecksums()
+{
+	const int Confirmed = GetConfirmedTick();
+	for (; ComparedTick < Confirmed; ++ComparedTick)
+	{
+		if (RemoteChecksumTicks[Slot(ComparedTick)] == ComparedTick)
+		{
+			CompareChecksum(ComparedTick, RemoteChecksums[Slot(ComparedTick)]);
+		}
+	}
+}
+
+void RollbackSession::CompareChecksum(const int Tick, const uint64_t RemoteChecksum)
+{
+	// Older ticks left the ring, nothing to compare them with. Lost datagrams repeat the same tick.
+	if (Tick < CurrentTick - INPUT_RING || Tick <= LastComparedTick)
+	{
+		return;
+	}
+
+	LastComparedTick = Tick;
+	Stats.ChecksumsCompared++;
+	if (Checksums[Slot(Tick)] != RemoteChecksum && Stats.DesyncTick < 0)
+	{
+		Stats.DesyncTick = Tick;
+	}
+}
+
+void RollbackSession::Send()
+{
+	uint8_t Buffer[MAX_DATAGRAM];
+	ByteWriter Writer(Buffer, sizeof(Buffer));
+	Writer.Write8(MAGIC_FIRST);
+	Writer.Write8(MAGIC_SECOND);
+
+	if (!bConnected)
+	{
+		Writer.Write8(HELLO);
+		Writer.Write32(GameRef.GetSeed());
+		Writer.Write8(GameRef.AreEffectsEnabled() ? 1 : 0);
+	}
+	else
+	{
+		const int ChecksumTick = GetConfirmedTick() - 1;
+		const int Start = std::max(RemoteAck, LocalCount - INPUT_RING / 2);
+		const int Count = std::min(LocalCount - Start, MAX_INPUTS_PER_DATAGRAM);
+
+		Writer.Write8(INPUTS);
+		Writer.Write32(static_cast<uint32_t>(RemoteConfirmed));
+		Writer.Write32(static_cast<uint32_t>(ChecksumTick));
+		Writer.Write64((ChecksumTick >= 0) ? Checksums[Slot(ChecksumTick)] : 0);
+		Writer.Write32(static_cast<uint32_t>(Start));
+		Writer.Write8(static_cast<uint8_t>(Count));
+
+		for (int Packed = 0; Packed < Count; Packed += 4)
+		{
+			uint8_t Byte = 0;
+			for (int i = Packed; i < std::min(Packed + 4, Count); ++i)
+			{
+				Byte |= static_cast<uint8_t>(static_cast<uint8_t>(LocalInputs[Slot(Start + i)]) << (2 * (i % 4)));
+			}
+			Writer.Write8(Byte);
+		}
+	}
+
+	Stats.PacketsSent++;
+	Socket.Send(Remote, Buffer, Writer.GetSize());
+}
+
+void RollbackSession::Rollback()
+{
+	const Clock::Nanoseconds Start = Clock::Now();
+	const int Depth = CurrentTick - RollbackTick;
+
+	GameRef.RestoreState(Snapshots[RollbackTick % Snapshots.size()]);
+	for (int Tick = RollbackTick; Tick < CurrentTick; ++Tick)
+	{
+		SimulateTick(Tick);
+	}
+	RollbackTick = NO_ROLLBACK;
+
+	Stats.Rollbacks++;
+	Stats.ResimulatedTicks += Depth;
+	Stats.MaxDepth = std::max(Stats.MaxDepth, Depth);
+	Stats.ResimulationTime += Clock::Now() - Start;
+}
+
+void RollbackSession::SimulateTick(const int Tick)
+{
+	const int Index = Slot(Tick);
+	GameRef.SaveState(Snapshots[Tick % Snapshots.size()]);
+
+	const PaddleCommand RemoteCommand = GetRemoteCommand(Tick);
+	UsedRemote[Index] = RemoteCommand;
+	LocalController->SetCommand(LocalInputs[Index]);
+	RemoteController->SetCommand(RemoteCommand);
+
+	GameRef.Tick(GameRef.GetTickDelta());
+	Checksums[Index] = GameRef.GetChecksum();
+}
+
+PaddleCommand RollbackSession::GetRemoteCommand(const int Tick) const
+{
+	if (RemoteTicks[Slot(Tick)] == Tick)
+	{
+		return RemoteInputs[Slot(Tick)];
+	}
+
+	// Players mostly keep holding what they held
+	return (RemoteConfirmed > 0) ? RemoteInputs[Slot(RemoteConfirmed - 1)] : PaddleCommand::HOLD;
+}
+
+bool RollbackSession::IsConnected() const
+{
+	return bConnected;
+}
+
+bool RollbackSession::IsFinished() const
+{
+	return bConnected && GameRef.GetState() != GameState::MATCH && RollbackTick == NO_ROLLBACK
+		&& RemoteConfirmed >= CurrentTick && RemoteAck >= CurrentTick;
+}
+
+int RollbackSession::GetTick() const
+{
+	return CurrentTick;
+}
+
+int RollbackSession::GetConfirmedTick() const
+{
+	return std::min(std::min(RemoteConfirmed, CurrentTick), RollbackTick);
+}
+
+const RollbackStats& RollbackSession::GetStats() const
+{
+	return Stats;
+}
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include "Game.h"
+#include "PaddleController.h"
+#include "pk/Clock.h"
+#include "pk/UdpSocket.h"
+
+struct RollbackStats
+{
+	uint64_t Ticks = 0;
+	uint64_t Stalls = 0;
+	uint64_t Rollbacks = 0;
+	uint64_t ResimulatedTicks = 0;
+	int MaxDepth = 0;
+	Clock::Nanoseconds ResimulationTime = 0;
+	uint64_t PacketsSent = 0;
+	uint64_t PacketsReceived = 0;
+	uint64_t ChecksumsCompared = 0;
+	// First tick whose checksum differs between the peers, -1 while they agree
+	int DesyncTick = -1;
+};
+
+// Peer to peer session of two machines, each one simulating the whole match.
+// Local input is applied at once and the remote paddle is predicted to repeat its last known command.
+// When the real command arrives and differs, the session restores the snapshot of that tick and simulates again.
+// Every datagram carries all the inputs the peer has not acknowledged yet, a lost one only delays confirmation.
+class RollbackSession
+{
+public:
+	typedef std::unique_ptr<RollbackSession> UniquePtr;
+
+	class Error : public std::runtime_error
+	{
+	public:
+		using std::runtime_error::runtime_error;
+	};
+
+	static constexpr int MAX_ROLLBACK = 60;
+	static constexpr int MAX_INPUT_DELAY = 8;
+
+	// Takes the local paddle's controller from the game, both paddles are fed by the session afterwards.
+	// Both peers need the same match settings, seed and effects setting, the match starts once they meet.
+	RollbackSession(Game& _Game, UdpSocket& _Socket, const NetAddress& _Remote, const bool _bLocalPlayerOne,
+		const int _MaxRollback = 16, const int _InputDelay = 0);
+
+	// One simulation tick, after rolling back for late inputs. False while waiting for the peer:
+	// not met yet, too many ticks ahead of its inputs, or the match is over.
+	bool Advance();
+	// Receives without simulating, for the time between ticks
+	void Poll();
+
+	bool IsConnected() const;
+	// Both peers agree the match ended and have all of each other's inputs
+	bool IsFinished() const;
+	int GetTick() const;
+	// Ticks simulated with real inputs only, they never roll back
+	int GetConfirmedTick() const;
+	const RollbackStats& GetStats() const;
+
+private:
+	void Receive(const uint8_t* Data, const int Size);
+	void ReceiveInputs(const uint32_t Start, const int Count, const uint8_t* Packed);
+	void CompareChecksums();
+	void CompareChecksum(const int Tick, const uint64_t RemoteChecksum);
+	void Send();
+
+	void Rollback();
+	void SimulateTick(const int Tick);
+	PaddleCommand GetRemoteCommand(const int Tick) const;
+
+	Game& GameRef;
+	UdpSocket& Socket;
+	NetAddress Remote;
+	bool bLocalPlayerOne;
+	int MaxRollback;
+
+	PaddleController::SharedPtr LocalSource;
+	std::shared_ptr<ScriptedController> LocalController;
+	std::shared_ptr<ScriptedController> RemoteController;
+
+	bool bConnected;
+	int CurrentTick;
+	int RollbackTick;
+	int LocalCount;
+	int RemoteConfirmed;
+	int RemoteAck;
+
+	std::vector<PaddleCommand> LocalInputs;
+	std::vector<PaddleCommand> RemoteInputs;
+	std::vector<int> RemoteTicks;
+	std::vector<PaddleCommand> UsedRemote;
+	std::vector<uint64_t> Checksums;
+	std::vector<GameSnapshot> Snapshots;
+
+	// One remote checksum per datagram, compared once the tick is confirmed here too
+	std::vector<int> RemoteChecksumTicks;
+	std::vector<uint64_t> RemoteChecksums;
+	int ComparedTick;
+	int LastComparedTick;
+
+	RollbackStats Stats;
+};
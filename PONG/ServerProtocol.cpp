@@ -0,0 +1,165 @@
+#include "ServerProtocol.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "Game.h"
+
+namespace
+{
+	constexpr uint8_t MAGIC_FIRST = 'P';
+	constexpr uint8_t MAGIC_SECOND = 'S';
+}
+
+namespace ServerProtocol
+{
+	void Inputs::Set(const int Index, const PaddleCommand Command)
+	{
+		const int Shift = 2 * (Index % 4);
+		Packed[Index / 4] = static_cast<uint8_t>((Packed[Index / 4] & ~(3 << Shift)) | (static_cast<uint8_t>(Command) << Shift));
+	}
+
+	PaddleCommand Inputs::Get(const int Index) const
+	{
+		return static_cast<PaddleCommand>((Packed[Index / 4] >> (2 * (Index % 4))) & 3);
+	}
+
+	Snapshot Capture(const Game& Simulation, const uint32_t Tick, const uint32_t ProcessedInputs)
+	{
+		const glm::vec3 BallLocation = Simulation.GetBall().GetLocation();
+		const glm::vec3 BallDirection = Simulation.GetBall().GetDirection();
+
+		Snapshot Data;
+		Data.Tick = Tick;
+		Data.ProcessedInputs = ProcessedInputs;
+		Data.State = static_cast<uint8_t>(Simulation.GetState());
+		Data.PlayerOneScore = static_cast<uint8_t>(Simulation.GetPlayerOneScore());
+		Data.PlayerTwoScore = static_cast<uint8_t>(Simulation.GetPlayerTwoScore());
+		Data.Rallies = static_cast<uint16_t>(Simulation.GetStats().Rallies);
+		Data.PlayerOneY = Simulation.GetPlayerOne().GetLocation().y;
+		Data.PlayerTwoY = Simulation.GetPlayerTwo().GetLocation().y;
+		Data.BallX = BallLocation.x;
+		Data.BallY = BallLocation.y;
+		Data.BallDirectionX = BallDirection.x;
+		Data.BallDirectionY = BallDirection.y;
+		Data.BallSpeed = Simulation.GetBall().GetSpeed();
+		return Data;
+	}
+
+	void WriteHeader(ByteWriter& Writer, const Message Type)
+	{
+		Writer.Write8(MAGIC_FIRST);
+		Writer.Write8(MAGIC_SECOND);
+		Writer.Write8(static_cast<uint8_t>(Type));
+	}
+
+	bool ReadHeader(ByteReader& Reader, Message& Type)
+	{
+		const uint8_t First = Reader.Read8();
+		const uint8_t Second = Reader.Read8();
+		Type = static_cast<Message>(Reader.Read8());
+		return Reader.IsValid() && First == MAGIC_FIRST && Second == MAGIC_SECOND;
+	}
+
+	void Write(ByteWriter& Writer, const Welcome& Data)
+	{
+		Writer.Write32(Data.Match);
+		Writer.Write8(Data.bPlayerOne);
+		Writer.Write16(Data.TickRate);
+		Writer.Write16(Data.SnapshotInterval);
+	}
+
+	void Write(ByteWriter& Writer, const Inputs& Data)
+	{
+		Writer.Write32(Data.Start);
+		Writer.Write8(Data.Count);
+		for (int i = 0; i < (Data.Count + 3) / 4; ++i)
+		{
+			Writer.Write8(Data.Packed[i]);
+		}
+		Writer.Write32(Data.Acked);
+	}
+
+	void Write(ByteWriter& Writer, const Snapshot& Data)
+	{
+		Writer.Write32(Data.Tick);
+		Writer.Write32(Data.ProcessedInputs);
+		Writer.Write8(Data.State);
+		Writer.Write8(Data.PlayerOneScore);
+		Writer.Write8(Data.PlayerTwoScore);
+		Writer.Write16(Data.Rallies);
+		Writer.WriteFloat(Data.PlayerOneY);
+		Writer.WriteFloat(Data.PlayerTwoY);
+		Writer.WriteFloat(Data.BallX);
+		Writer.WriteFloat(Data.BallY);
+		Writer.WriteFloat(Data.BallDirectionX);
+		Writer.WriteFloat(Data.BallDirectionY);
+		Writer.WriteFloat(Data.BallSpeed);
+	}
+
+	void Write(ByteWriter& Writer, const Subscribe& Data)
+	{
+		Writer.Write32(Data.Match);
+	}
+
+	void Write(ByteWriter& Writer, const Spectate& Data)
+	{
+		Writer.Write32(Data.Match);
+		Writer.Write32(Data.Sequence);
+		Writer.Write64(Data.Published);
+	}
+
+	bool Read(ByteReader& Reader, Welcome& Data)
+	{
+		Data.Match = Reader.Read32();
+		Data.bPlayerOne = Reader.Read8();
+		Data.TickRate = Reader.Read16();
+		Data.SnapshotInterval = Reader.Read16();
+		return Reader.IsValid() && Data.TickRate > 0 && Data.SnapshotInterval > 0;
+	}
+
+	bool Read(ByteReader& Reader, Inputs& Data)
+	{
+		Data.Start = Reader.Read32();
+		Data.Count = std::min<uint8_t>(Reader.Read8(), MAX_INPUTS);
+		std::memset(Data.Packed, 0, sizeof(Data.Packed));
+		for (int i = 0; i < (Data.Count + 3) / 4; ++i)
+		{
+			Data.Packed[i] = Reader.Read8();
+		}
+		Data.Acked = Reader.Read32();
+		return Reader.IsValid();
+	}
+
+	bool Read(ByteReader& Reader, Snapshot& Data)
+	{
+		Data.Tick = Reader.Read32();
+		Data.ProcessedInputs = Reader.Read32();
+		Data.State = Reader.Read8();
+		Data.PlayerOneScore = Reader.Read8();
+		Data.PlayerTwoScore = Reader.Read8();
+		Data.Rallies = Reader.Read16();
+		Data.PlayerOneY = Reader.ReadFloat();
+		Data.PlayerTwoY = Reader.ReadFloat();
+		Data.BallX = Reader.ReadFloat();
+		Data.BallY = Reader.ReadFloat();
+		Data.BallDirectionX = Reader.ReadFloat();
+		Data.BallDirectionY = Reader.ReadFloat();
+		Data.BallSpeed = Reader.ReadFloat();
+		return Reader.IsValid();
+	}
+
+	bool Read(ByteReader& Reader, Subscribe& Data)
+	{
+		Data.Match = Reader.Read32();
+		return Reader.IsValid();
+	}
+
+	bool Read(ByteReader& Reader, Spectate& Data)
+	{
+		Data.Match = Reader.Read32();
+		Data.Sequence = Reader.Read32();
+		Data.Published = Reader.Read64();
+		return Reader.IsValid();
+	}
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <cstdint>
+
+#include "PaddleController.h"
+#include "pk/ByteStream.h"
+
+class Game;
+
+// Datagrams between MatchServer and MatchClient, and from SpectatorServer to its subscribers.
+// Each one starts with two magic bytes and its type.
+namespace ServerProtocol
+{
+	enum class Message : uint8_t
+	{
+		JOIN = 1,
+		WELCOME,
+		INPUTS,
+		SNAPSHOT,
+		SUBSCRIBE,
+		SPECTATE
+	};
+
+	constexpr int MAX_DATAGRAM = 128;
+	constexpr int MAX_INPUTS = 64;
+
+	struct Welcome
+	{
+		uint32_t Match;
+		uint8_t bPlayerOne;
+		uint16_t TickRate;
+		uint16_t SnapshotInterval;
+	};
+
+	// Commands Start .. Start + Count - 1 of one client, two bits each
+	struct Inputs
+	{
+		uint32_t Start;
+		uint8_t Count;
+		uint8_t Packed[MAX_INPUTS / 4];
+		// Sequence of the newest snapshot received, 0 before the first. The server encodes against it.
+		uint32_t Acked;
+
+		void Set(const int Index, const PaddleCommand Command);
+		PaddleCommand Get(const int Index) const;
+	};
+
+	// Authoritative state of one match as sent to one of its clients.
+	// SNAPSHOT datagrams carry it bit packed by SnapshotCodec, spectator frames in full.
+	struct Snapshot
+	{
+		uint32_t Tick;
+		// How many of this client's inputs the server has applied, prediction replays the ones after
+		uint32_t ProcessedInputs;
+		uint8_t State;
+		uint8_t PlayerOneScore;
+		uint8_t PlayerTwoScore;
+		uint16_t Rallies;
+		float PlayerOneY;
+		float PlayerTwoY;
+		float BallX;
+		float BallY;
+		float BallDirectionX;
+		float BallDirectionY;
+		float BallSpeed;
+	};
+
+	// Sent by a spectator once a second, both to start watching and to keep watching
+	struct Subscribe
+	{
+		uint32_t Match;
+	};
+
+	// Broadcast frame, followed by the match Snapshot
+	struct Spectate
+	{
+		uint32_t Match;
+		// Counts the frames of this match, a gap means the spectator was skipped ahead
+		uint32_t Sequence;
+		// Clock::Now of the server, only comparable on the same machine
+		uint64_t Published;
+	};
+
+	// State of a running match, as the server sends it to one client
+	Snapshot Capture(const Game& Simulation, const uint32_t Tick, const uint32_t ProcessedInputs);
+
+	void WriteHeader(ByteWriter& Writer, const Message Type);
+	// False when the datagram is not one of ours
+	bool ReadHeader(ByteReader& Reader, Message& Type);
+
+	void Write(ByteWriter& Writer, const Welcome& Data);
+	void Write(ByteWriter& Writer, const Inputs& Data);
+	void Write(ByteWriter& Writer, const Snapshot& Data);
+	void Write(ByteWriter& Writer, const Subscribe& Data);
+	void Write(ByteWriter& Writer, const Spectate& Data);
+
+	// False on a truncated datagram
+	bool Read(ByteReader& Reader, Welcome& Data);
+	bool Read(ByteReader& Reader, Inputs& Data);
+	bool Read(ByteReader& Reader, Snapshot& Data);
+	bool Read(ByteReader& Reader, Subscribe& Data);
+	bool Read(ByteReader& Reader, Spectate& Data);
+}
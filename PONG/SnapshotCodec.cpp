@@ -0,0 +1,261 @@
+#include "SnapshotCodec.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "pk/Common.h"
+
+namespace
+{
+	constexpr float POSITION_SCALE = 8.f;
+	// The ball leaves the arena by up to one tick of movement before a goal is scored
+	constexpr float POSITION_MARGIN = 64.f;
+	constexpr int HEADING_BITS = 12;
+	constexpr float SPEED_SCALE = 4.f;
+	constexpr float PI = 3.14159265358979f;
+
+	constexpr int COUNTER_BITS = 32;
+	constexpr int STATE_BITS = 2;
+	constexpr int SCORE_BITS = 8;
+	constexpr int RALLY_BITS = 16;
+
+	// Signed change a field usually sees between two snapshots a few ticks apart
+	constexpr int SMALL_TICK_BITS = 8;
+	constexpr int SMALL_INPUT_BITS = 6;
+	constexpr int SMALL_RALLY_BITS = 3;
+	constexpr int SMALL_POSITION_BITS = 10;
+
+	int BitsFor(const float Range)
+	{
+		int Bits = 1;
+		while (Bits < 32 && static_cast<float>(1u << Bits) <= Range)
+		{
+			Bits++;
+		}
+		return Bits;
+	}
+
+	uint32_t QuantizeRange(const float Value, const float Offset, const float Scale, const int Bits)
+	{
+		const float Scaled = std::round((Value + Offset) * Scale);
+		return static_cast<uint32_t>(Math::Clamp(Scaled, 0.f, static_cast<float>((1u << Bits) - 1)));
+	}
+
+	// Unchanged: 0. Small change: 1 0 and the difference in SmallBits. Otherwise: 1 1 and the value in FullBits.
+	// Fields that only ever jump skip the small form with SmallBits 0.
+	void WriteField(BitWriter& Writer, const uint32_t Value, const uint32_t Base, const int FullBits, const int SmallBits)
+	{
+		if (Value == Base)
+		{
+			Writer.WriteBool(false);
+			return;
+		}
+		Writer.WriteBool(true);
+
+		const int64_t Difference = static_cast<int64_t>(Value) - static_cast<int64_t>(Base);
+		const int64_t Limit = (SmallBits > 0) ? (1LL << (SmallBits - 1)) : 0;
+		if (SmallBits > 0 && Difference >= -Limit && Difference < Limit)
+		{
+			Writer.WriteBool(false);
+			Writer.WriteBits(static_cast<uint32_t>(Difference + Limit), SmallBits);
+			return;
+		}
+
+		if (SmallBits > 0)
+		{
+			Writer.WriteBool(true);
+		}
+		Writer.WriteBits(Value, FullBits);
+	}
+
+	uint32_t ReadField(BitReader& Reader, const uint32_t Base, const int FullBits, const int SmallBits)
+	{
+		if (!Reader.ReadBool())
+		{
+			return Base;
+		}
+
+		if (SmallBits > 0 && !Reader.ReadBool())
+		{
+			const int64_t Limit = 1LL << (SmallBits - 1);
+			return static_cast<uint32_t>(static_cast<int64_t>(Base) + static_cast<int64_t>(Reader.ReadBits(SmallBits)) - Limit);
+		}
+		return Reader.ReadBits(FullBits);
+	}
+}
+
+SnapshotHistory::SnapshotHistory()
+	: Entries(1 << SLOT_BITS), bValid(1 << SLOT_BITS, false)
+{
+}
+
+void SnapshotHistory::Store(const QuantizedSnapshot& State)
+{
+	const int Slot = GetSlot(State.Sequence);
+	if (bValid[Slot] && Entries[Slot].Sequence > State.Sequence)
+	{
+		return;
+	}
+
+	Entries[Slot] = State;
+	bValid[Slot] = true;
+}
+
+const QuantizedSnapshot* SnapshotHistory::Find(const uint32_t Sequence) const
+{
+	const QuantizedSnapshot* Entry = FindSlot(GetSlot(Sequence));
+	return (Entry != nullptr && Entry->Sequence == Sequence) ? Entry : nullptr;
+}
+
+const QuantizedSnapshot* SnapshotHistory::FindSlot(const int Slot) const
+{
+	return bValid[Slot] ? &Entries[Slot] : nullptr;
+}
+
+int SnapshotHistory::GetSlot(const uint32_t Sequence)
+{
+	return static_cast<int>(Sequence & ((1u << SLOT_BITS) - 1));
+}
+
+void SnapshotHistory::Clear()
+{
+	std::fill(bValid.begin(), bValid.end(), false);
+}
+
+SnapshotCodec::SnapshotCodec(const MatchSettings& Settings)
+	: MaxSpeed(2.f * std::max(Settings.BallMaxSpeed, Settings.BallSpeed)),
+		ArenaWidth(static_cast<float>(Settings.ArenaSize.x)), ArenaHeight(static_cast<float>(Settings.ArenaSize.y))
+{
+	BallXBits = BitsFor((ArenaWidth + 2.f * POSITION_MARGIN) * POSITION_SCALE);
+	HeightBits = BitsFor((ArenaHeight + 2.f * POSITION_MARGIN) * POSITION_SCALE);
+	SpeedBits = BitsFor(MaxSpeed * SPEED_SCALE);
+}
+
+QuantizedSnapshot SnapshotCodec::Quantize(const ServerProtocol::Snapshot& State) const
+{
+	QuantizedSnapshot Quantized;
+	Quantized.Tick = State.Tick;
+	Quantized.ProcessedInputs = State.ProcessedInputs;
+	Quantized.State = State.State;
+	Quantized.PlayerOneScore = State.PlayerOneScore;
+	Quantized.PlayerTwoScore = State.PlayerTwoScore;
+	Quantized.Rallies = State.Rallies;
+	Quantized.PlayerOneY = QuantizeRange(State.PlayerOneY, POSITION_MARGIN, POSITION_SCALE, HeightBits);
+	Quantized.PlayerTwoY = QuantizeRange(State.PlayerTwoY, POSITION_MARGIN, POSITION_SCALE, HeightBits);
+	Quantized.BallX = QuantizeRange(State.BallX, POSITION_MARGIN, POSITION_SCALE, BallXBits);
+	Quantized.BallY = QuantizeRange(State.BallY, POSITION_MARGIN, POSITION_SCALE, HeightBits);
+	Quantized.BallSpeed = QuantizeRange(State.BallSpeed, 0.f, SPEED_SCALE, SpeedBits);
+
+	// Headings wrap around, straight left is 0 whichever sign the zero vertical component has
+	const float Angle = std::atan2(State.BallDirectionY, State.BallDirectionX) + PI;
+	const uint32_t Headings = 1u << HEADING_BITS;
+	Quantized.BallHeading = static_cast<uint32_t>(std::lround(Angle / (2.f * PI) * Headings)) & (Headings - 1);
+	return Quantized;
+}
+
+ServerProtocol::Snapshot SnapshotCodec::Dequantize(const QuantizedSnapshot& State) const
+{
+	ServerProtocol::Snapshot Data;
+	Data.Tick = State.Tick;
+	Data.ProcessedInputs = State.ProcessedInputs;
+	Data.State = static_cast<uint8_t>(State.State);
+	Data.PlayerOneScore = static_cast<uint8_t>(State.PlayerOneScore);
+	Data.PlayerTwoScore = static_cast<uint8_t>(State.PlayerTwoScore);
+	Data.Rallies = static_cast<uint16_t>(State.Rallies);
+	Data.PlayerOneY = State.PlayerOneY / POSITION_SCALE - POSITION_MARGIN;
+	Data.PlayerTwoY = State.PlayerTwoY / POSITION_SCALE - POSITION_MARGIN;
+	Data.BallX = State.BallX / POSITION_SCALE - POSITION_MARGIN;
+	Data.BallY = State.BallY / POSITION_SCALE - POSITION_MARGIN;
+	Data.BallSpeed = State.BallSpeed / SPEED_SCALE;
+
+	const float Angle = State.BallHeading * (2.f * PI) / (1u << HEADING_BITS) - PI;
+	Data.BallDirectionX = std::cos(Angle);
+	Data.BallDirectionY = std::sin(Angle);
+	return Data;
+}
+
+void SnapshotCodec::Encode(BitWriter& Writer, const QuantizedSnapshot& State, const QuantizedSnapshot* Baseline) const
+{
+	const bool bDelta = Baseline != nullptr && State.Sequence > Baseline->Sequence && State.Sequence - Baseline->Sequence <= MAX_BASELINE_AGE;
+	Writer.WriteBool(bDelta);
+
+	if (!bDelta)
+	{
+		Writer.WriteBits(State.Sequence, COUNTER_BITS);
+		Writer.WriteBits(State.Tick, COUNTER_BITS);
+		Writer.WriteBits(State.ProcessedInputs, COUNTER_BITS);
+		Writer.WriteBits(State.State, STATE_BITS);
+		Writer.WriteBits(State.PlayerOneScore, SCORE_BITS);
+		Writer.WriteBits(State.PlayerTwoScore, SCORE_BITS);
+		Writer.WriteBits(State.Rallies, RALLY_BITS);
+		Writer.WriteBits(State.PlayerOneY, HeightBits);
+		Writer.WriteBits(State.PlayerTwoY, HeightBits);
+		Writer.WriteBits(State.BallX, BallXBits);
+		Writer.WriteBits(State.BallY, HeightBits);
+		Writer.WriteBits(State.BallHeading, HEADING_BITS);
+		Writer.WriteBits(State.BallSpeed, SpeedBits);
+		return;
+	}
+
+	Writer.WriteBits(static_cast<uint32_t>(SnapshotHistory::GetSlot(Baseline->Sequence)), SnapshotHistory::SLOT_BITS);
+	Writer.WriteBits(State.Sequence - Baseline->Sequence, SnapshotHistory::SLOT_BITS);
+	WriteField(Writer, State.Tick, Baseline->Tick, COUNTER_BITS, SMALL_TICK_BITS);
+	WriteField(Writer, State.ProcessedInputs, Baseline->ProcessedInputs, COUNTER_BITS, SMALL_INPUT_BITS);
+	WriteField(Writer, State.State, Baseline->State, STATE_BITS, 0);
+	WriteField(Writer, State.PlayerOneScore, Baseline->PlayerOneScore, SCORE_BITS, 0);
+	WriteField(Writer, State.PlayerTwoScore, Baseline->PlayerTwoScore, SCORE_BITS, 0);
+	WriteField(Writer, State.Rallies, Baseline->Rallies, RALLY_BITS, SMALL_RALLY_BITS);
+	WriteField(Writer, State.PlayerOneY, Baseline->PlayerOneY, HeightBits, SMALL_POSITION_BITS);
+	WriteField(Writer, State.PlayerTwoY, Baseline->PlayerTwoY, HeightBits, SMALL_POSITION_BITS);
+	WriteField(Writer, State.BallX, Baseline->BallX, BallXBits, SMALL_POSITION_BITS);
+	WriteField(Writer, State.BallY, Baseline->BallY, HeightBits, SMALL_POSITION_BITS);
+	WriteField(Writer, State.BallHeading, Baseline->BallHeading, HEADING_BITS, 0);
+	WriteField(Writer, State.BallSpeed, Baseline->BallSpeed, SpeedBits, 0);
+}
+
+bool SnapshotCodec::Decode(BitReader& Reader, const SnapshotHistory& History, QuantizedSnapshot& State) const
+{
+	if (!Reader.ReadBool())
+	{
+		State.Sequence = Reader.ReadBits(COUNTER_BITS);
+		State.Tick = Reader.ReadBits(COUNTER_BITS);
+		State.ProcessedInputs = Reader.ReadBits(COUNTER_BITS);
+		State.State = Reader.ReadBits(STATE_BITS);
+		State.PlayerOneScore = Reader.ReadBits(SCORE_BITS);
+		State.PlayerTwoScore = Reader.ReadBits(SCORE_BITS);
+		State.Rallies = Reader.ReadBits(RALLY_BITS);
+		State.PlayerOneY = Reader.ReadBits(HeightBits);
+		State.PlayerTwoY = Reader.ReadBits(HeightBits);
+		State.BallX = Reader.ReadBits(BallXBits);
+		State.BallY = Reader.ReadBits(HeightBits);
+		State.BallHeading = Reader.ReadBits(HEADING_BITS);
+		State.BallSpeed = Reader.ReadBits(SpeedBits);
+		return Reader.IsValid();
+	}
+
+	const QuantizedSnapshot* Baseline = History.FindSlot(static_cast<int>(Reader.ReadBits(SnapshotHistory::SLOT_BITS)));
+	if (Baseline == nullptr || !Reader.IsValid())
+	{
+		return false;
+	}
+
+	State.Sequence = Baseline->Sequence + Reader.ReadBits(SnapshotHistory::SLOT_BITS);
+	State.Tick = ReadField(Reader, Baseline->Tick, COUNTER_BITS, SMALL_TICK_BITS);
+	State.ProcessedInputs = ReadField(Reader, Baseline->ProcessedInputs, COUNTER_BITS, SMALL_INPUT_BITS);
+	State.State = ReadField(Reader, Baseline->State, STATE_BITS, 0);
+	State.PlayerOneScore = ReadField(Reader, Baseline->PlayerOneScore, SCORE_BITS, 0);
+	State.PlayerTwoScore = ReadField(Reader, Baseline->PlayerTwoScore, SCORE_BITS, 0);
+	State.Rallies = ReadField(Reader, Baseline->Rallies, RALLY_BITS, SMALL_RALLY_BITS);
+	State.PlayerOneY = ReadField(Reader, Baseline->PlayerOneY, HeightBits, SMALL_POSITION_BITS);
+	State.PlayerTwoY = ReadField(Reader, Baseline->PlayerTwoY, HeightBits, SMALL_POSITION_BITS);
+	State.BallX = ReadField(Reader, Baseline->BallX, BallXBits, SMALL_POSITION_BITS);
+	State.BallY = ReadField(Reader, Baseline->BallY, HeightBits, SMALL_POSITION_BITS);
+	State.BallHeading = ReadField(Reader, Baseline->BallHeading, HEADING_BITS, 0);
+	State.BallSpeed = ReadField(Reader, Baseline->BallSpeed, SpeedBits, 0);
+	return Reader.IsValid();
+}
+
+int SnapshotCodec::GetFullBits() const
+{
+	return 1 + 3 * COUNTER_BITS + STATE_BITS + 2 * SCORE_BITS + RALLY_BITS + 3 * HeightBits + BallXBits + HEADING_BITS + SpeedBits;
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "MatchSettings.h"
+#include "ServerProtocol.h"
+#include "pk/BitStream.h"
+
+// Snapshot with every field an integer: positions in eighths of a pixel inside the arena (plus a margin),
+// the ball direction as one of 4096 headings and its speed in quarters of a pixel per second
+struct QuantizedSnapshot
+{
+	// Numbers the snapshots sent to one receiver, set by the sender. Ticks repeat while a match waits or ends.
+	uint32_t Sequence = 0;
+	uint32_t Tick = 0;
+	uint32_t ProcessedInputs = 0;
+	uint32_t State = 0;
+	uint32_t PlayerOneScore = 0;
+	uint32_t PlayerTwoScore = 0;
+	uint32_t Rallies = 0;
+	uint32_t PlayerOneY = 0;
+	uint32_t PlayerTwoY = 0;
+	uint32_t BallX = 0;
+	uint32_t BallY = 0;
+	uint32_t BallHeading = 0;
+	uint32_t BallSpeed = 0;
+};
+
+// The last snapshots sent to, or received by, one client, looked up by sequence for use as baselines
+class SnapshotHistory
+{
+public:
+	// Snapshots are kept in 2^SLOT_BITS slots, the encoder names the baseline by its slot
+	static constexpr int SLOT_BITS = 6;
+
+	SnapshotHistory();
+
+	// Never replaces a newer snapshot sharing the slot
+	void Store(const QuantizedSnapshot& State);
+	// Nullptr once the snapshot is forgotten
+	const QuantizedSnapshot* Find(const uint32_t Sequence) const;
+	const QuantizedSnapshot* FindSlot(const int Slot) const;
+	static int GetSlot(const uint32_t Sequence);
+
+	void Clear();
+
+private:
+	std::vector<QuantizedSnapshot> Entries;
+	std::vector<bool> bValid;
+};
+
+// Bit packed snapshots, each one a delta against a baseline the receiver acknowledged.
+// A field equal to the baseline costs one bit, a small change a few more and anything else its full width,
+// so a tick of ordinary play fits in about ten bytes instead of the 42 of the raw Snapshot.
+// Both sides work on the quantized values, the decoder rebuilds exactly what the encoder had.
+class SnapshotCodec
+{
+public:
+	// Oldest baseline in snapshots, older ones are forgotten by SnapshotHistory and get a full snapshot
+	static constexpr int MAX_BASELINE_AGE = 63;
+
+	// Largest difference between a field and its decoded value
+	static constexpr float POSITION_TOLERANCE = 1.f / 16.f;
+	static constexpr float HEADING_TOLERANCE = 3.14159265f / 4096.f;
+	static constexpr float SPEED_TOLERANCE = 1.f / 8.f;
+
+	explicit SnapshotCodec(const MatchSettings& Settings);
+
+	QuantizedSnapshot Quantize(const ServerProtocol::Snapshot& State) const;
+	// The ball direction comes back as a unit vector, the simulation only uses its heading
+	ServerProtocol::Snapshot Dequantize(const QuantizedSnapshot& State) const;
+
+	// Without a usable baseline every field is written in full
+	void Encode(BitWriter& Writer, const QuantizedSnapshot& State, const QuantizedSnapshot* Baseline) const;
+	// False on a truncated datagram or a baseline no longer in History
+	bool Decode(BitReader& Reader, const SnapshotHistory& History, QuantizedSnapshot& State) const;
+
+	// Encoded size of a snapshot with every field in full, in bits
+	int GetFullBits() const;
+
+private:
+	int BallXBits;
+	int HeightBits;
+	int SpeedBits;
+	float MaxSpeed;
+	float ArenaWidth;
+	float ArenaHeight;
+};
@@ -0,0 +1,283 @@
+#include "SpectatorServer.h"
+
+#include <algorithm>
+
+namespace
+{
+	constexpr double SPECTATOR_TIMEOUT = 5.0;
+	constexpr double IDLE_CHECK_INTERVAL = 1.0;
+	// Datagrams handed to the socket per call, sendmmsg splits them further.
+	// The deadline is checked between calls, a small batch does not overrun it by much.
+	constexpr int MAX_BATCH = 64;
+	// Fan-out bursts thousands of datagrams at once, a larger buffer rides them out
+	constexpr int SEND_BUFFER_BYTES = 4 * 1024 * 1024;
+	constexpr int RECEIVE_BUFFER_BYTES = 1024 * 1024;
+	constexpr int SOCKET_TOKEN = 0;
+	constexpr Clock::Nanoseconds MILLISECOND = 1000000;
+}
+
+SpectatorServer::SpectatorServer(UdpSocket& _Socket, const int _MaxSubscribers)
+	: Socket(_Socket), MaxSubscribers(std::max(_MaxSubscribers, 1)), ReadyCursor(0), bBlocked(false), LastIdleCheck(Clock::Now())
+{
+	Socket.SetBufferSizes(SEND_BUFFER_BYTES, RECEIVE_BUFFER_BYTES);
+	Poller.Add(Socket.GetHandle(), SOCKET_TOKEN);
+	Batch.reserve(MAX_BATCH);
+}
+
+bool SpectatorServer::HasAudience(const uint32_t Match) const
+{
+	const std::unordered_map<uint32_t, std::vector<int>>::const_iterator Audience = Audiences.find(Match);
+	return Audience != Audiences.end() && !Audience->second.empty();
+}
+
+void SpectatorServer::Publish(const uint32_t Match, const ServerProtocol::Snapshot& State)
+{
+	const std::unordered_map<uint32_t, std::vector<int>>::const_iterator Audience = Audiences.find(Match);
+	if (Audience == Audiences.end() || Audience->second.empty())
+	{
+		return;
+	}
+
+	const Clock::Nanoseconds Start = Clock::Now();
+
+	std::shared_ptr<SpectatorFrame> Frame = std::make_shared<SpectatorFrame>();
+	Frame->Match = Match;
+	Frame->Sequence = ++Sequences[Match];
+
+	ByteWriter Writer(Frame->Data, sizeof(Frame->Data));
+	ServerProtocol::WriteHeader(Writer, ServerProtocol::Message::SPECTATE);
+	ServerProtocol::Write(Writer, ServerProtocol::Spectate{ Match, Frame->Sequence, static_cast<uint64_t>(Start) });
+	ServerProtocol::Write(Writer, State);
+	Frame->Size = Writer.GetSize();
+
+	const SpectatorFrame::SharedPtr Shared = std::move(Frame);
+	for (const int Index : Audience->second)
+	{
+		Subscriber& Watcher = Subscribers[Index];
+		if (Watcher.Pending != nullptr)
+		{
+			Stats.SkippedFrames++;
+		}
+		else
+		{
+			Ready.push_back(Index);
+		}
+		Watcher.Pending = Shared;
+	}
+
+	Stats.FramesPublished++;
+	Stats.PublishTime += Clock::Now() - Start;
+}
+
+void SpectatorServer::Update()
+{
+	Receive();
+
+	const Clock::Nanoseconds Now = Clock::Now();
+	if (Clock::ToSeconds(Now - LastIdleCheck) >= IDLE_CHECK_INTERVAL)
+	{
+		DropIdle(Now);
+		LastIdleCheck = Now;
+	}
+}
+
+void SpectatorServer::WaitUntil(const Clock::Nanoseconds Deadline)
+{
+	// A blocked socket is flushed once the poller reports it writable
+	if (!bBlocked)
+	{
+		Flush(Deadline);
+	}
+
+	Clock::Nanoseconds Remaining = 0;
+	while ((Remaining = Deadline - Clock::Now()) >= MILLISECOND)
+	{
+		Poller.Wait(Remaining, PollEvents);
+		for (const SocketPoller::Event& Signal : PollEvents)
+		{
+			if (Signal.bReadable)
+			{
+				Receive();
+			}
+			if (Signal.bWritable)
+			{
+				bBlocked = false;
+				Poller.Modify(Socket.GetHandle(), SOCKET_TOKEN, false);
+				Flush(Deadline);
+			}
+		}
+	}
+}
+
+void SpectatorServer::Receive()
+{
+	uint8_t Buffer[ServerProtocol::MAX_DATAGRAM];
+	NetAddress From;
+	int Size = 0;
+	while ((Size = Socket.Receive(Buffer, sizeof(Buffer), From)) >= 0)
+	{
+		ByteReader Reader(Buffer, Size);
+		ServerProtocol::Message Type;
+		ServerProtocol::Subscribe Request;
+		if (ServerProtocol::ReadHeader(Reader, Type) && Type == ServerProtocol::Message::SUBSCRIBE && ServerProtocol::Read(Reader, Request))
+		{
+			Stats.SubscribesReceived++;
+			Subscribe(From, Request.Match);
+		}
+	}
+}
+
+void SpectatorServer::Subscribe(const NetAddress& From, const uint32_t Match)
+{
+	const std::unordered_map<uint64_t, int>::const_iterator Known = SubscribersByAddress.find(MakeKey(From));
+	if (Known != SubscribersByAddress.end())
+	{
+		if (Subscribers[Known->second].Match == Match)
+		{
+			Subscribers[Known->second].LastHeard = Clock::Now();
+			return;
+		}
+		// Switched to another match
+		Unsubscribe(Known->second);
+	}
+
+	if (FreeSlots.empty() && static_cast<int>(Subscribers.size()) >= MaxSubscribers)
+	{
+		return;
+	}
+
+	int Index = static_cast<int>(Subscribers.size());
+	if (!FreeSlots.empty())
+	{
+		Index = FreeSlots.back();
+		FreeSlots.pop_back();
+	}
+	else
+	{
+		Subscribers.emplace_back();
+	}
+
+	Subscriber& Joined = Subscribers[Index];
+	Joined.Address = From;
+	Joined.Match = Match;
+	Joined.LastHeard = Clock::Now();
+	Joined.Pending.reset();
+	Joined.bActive = true;
+	SubscribersByAddress[MakeKey(From)] = Index;
+	Audiences[Match].push_back(Index);
+}
+
+void SpectatorServer::Unsubscribe(const int Index)
+{
+	Subscriber& Leaving = Subscribers[Index];
+	std::vector<int>& Audience = Audiences[Leaving.Match];
+	const std::vector<int>::iterator Found = std::find(Audience.begin(), Audience.end(), Index);
+	if (Found != Audience.end())
+	{
+		*Found = Audience.back();
+		Audience.pop_back();
+	}
+	if (Audience.empty())
+	{
+		Audiences.erase(Leaving.Match);
+	}
+
+	// Still listed in Ready, Flush skips it without a pending frame
+	SubscribersByAddress.erase(MakeKey(Leaving.Address));
+	Leaving.Pending.reset();
+	Leaving.bActive = false;
+	FreeSlots.push_back(Index);
+}
+
+void SpectatorServer::DropIdle(const Clock::Nanoseconds Now)
+{
+	const Clock::Nanoseconds Timeout = Clock::FromSeconds(SPECTATOR_TIMEOUT);
+	for (int i = 0; i < static_cast<int>(Subscribers.size()); ++i)
+	{
+		if (Subscribers[i].bActive && Now - Subscribers[i].LastHeard > Timeout)
+		{
+			Unsubscribe(i);
+		}
+	}
+}
+
+void SpectatorServer::Flush(const Clock::Nanoseconds Deadline)
+{
+	const Clock::Nanoseconds Start = Clock::Now();
+
+	while (ReadyCursor < Ready.size())
+	{
+		if (Clock::Now() >= Deadline)
+		{
+			Stats.DeferredFlushes++;
+			break;
+		}
+
+		// Points into the shared frames, which stay alive through Pending until the batch is sent
+		Batch.clear();
+		size_t Next = ReadyCursor;
+		for (; Next < Ready.size() && static_cast<int>(Batch.size()) < MAX_BATCH; ++Next)
+		{
+			const Subscriber& Watcher = Subscribers[Ready[Next]];
+			if (Watcher.Pending != nullptr)
+			{
+				Batch.push_back(OutgoingDatagram{ Watcher.Address, Watcher.Pending->Data, Watcher.Pending->Size });
+			}
+		}
+
+		const int Sent = Socket.SendBatch(Batch.data(), static_cast<int>(Batch.size()));
+		Stats.DatagramsSent += Sent;
+
+		// Release the frames that left, in the same order they were batched
+		int Released = 0;
+		for (; ReadyCursor < Next; ++ReadyCursor)
+		{
+			Subscriber& Watcher = Subscribers[Ready[ReadyCursor]];
+			if (Watcher.Pending != nullptr)
+			{
+				if (Released == Sent)
+				{
+					break;
+				}
+				Watcher.Pending.reset();
+				Released++;
+			}
+		}
+
+		if (Sent < static_cast<int>(Batch.size()))
+		{
+			bBlocked = true;
+			Stats.BlockedFlushes++;
+			Poller.Modify(Socket.GetHandle(), SOCKET_TOKEN, true);
+			break;
+		}
+	}
+
+	if (ReadyCursor == Ready.size())
+	{
+		Ready.clear();
+		ReadyCursor = 0;
+	}
+	else if (ReadyCursor > Ready.size() / 2)
+	{
+		Ready.erase(Ready.begin(), Ready.begin() + static_cast<std::ptrdiff_t>(ReadyCursor));
+		ReadyCursor = 0;
+	}
+
+	Stats.FlushTime += Clock::Now() - Start;
+}
+
+uint64_t SpectatorServer::MakeKey(const NetAddress& Address)
+{
+	return (static_cast<uint64_t>(Address.Host) << 16) | Address.Port;
+}
+
+int SpectatorServer::GetSubscribers() const
+{
+	return static_cast<int>(SubscribersByAddress.size());
+}
+
+const SpectatorStats& SpectatorServer::GetStats() const
+{
+	return Stats;
+}
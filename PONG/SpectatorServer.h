@@ -0,0 +1,103 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "ServerProtocol.h"
+#include "pk/Clock.h"
+#include "pk/SocketPoller.h"
+#include "pk/UdpSocket.h"
+
+struct SpectatorStats
+{
+	uint64_t SubscribesReceived = 0;
+	uint64_t FramesPublished = 0;
+	uint64_t DatagramsSent = 0;
+	// Frames replaced by a newer one before they could be sent
+	uint64_t SkippedFrames = 0;
+	// Flushes stopped by a full socket buffer, resumed when it drains
+	uint64_t BlockedFlushes = 0;
+	// Flushes stopped at the next tick, resumed after it
+	uint64_t DeferredFlushes = 0;
+	Clock::Nanoseconds PublishTime = 0;
+	Clock::Nanoseconds FlushTime = 0;
+};
+
+// Match state serialized once and shared by every subscriber it is queued for
+struct SpectatorFrame
+{
+	typedef std::shared_ptr<const SpectatorFrame> SharedPtr;
+
+	uint32_t Match;
+	uint32_t Sequence;
+	int Size;
+	uint8_t Data[ServerProtocol::MAX_DATAGRAM];
+};
+
+// Broadcasts live matches to any number of spectators on its own UDP port.
+// A spectator subscribes to one match and renews the subscription every second; each published state
+// becomes one shared frame queued for the whole audience and sent in sendmmsg batches.
+// Subscribers hold at most one frame: one still queued when the next is published is replaced,
+// so a backlog never builds up and slow consumers skip ahead to the latest state.
+// Frames are only sent between ticks and never past the next one, an audience too large for the
+// spare time of the match thread skips frames instead of slowing the simulation down.
+class SpectatorServer
+{
+public:
+	SpectatorServer(UdpSocket& _Socket, const int _MaxSubscribers);
+
+	// Nobody watching, no need to build the state
+	bool HasAudience(const uint32_t Match) const;
+	void Publish(const uint32_t Match, const ServerProtocol::Snapshot& State);
+
+	// Reads subscriptions and drops the spectators that stopped renewing them
+	void Update();
+	// Sends queued frames and reads subscriptions until Deadline, resuming sends as soon as the socket drains.
+	// Returns up to a millisecond early, the caller sleeps the rest.
+	void WaitUntil(const Clock::Nanoseconds Deadline);
+
+	int GetSubscribers() const;
+	const SpectatorStats& GetStats() const;
+
+private:
+	struct Subscriber
+	{
+		NetAddress Address;
+		uint32_t Match = 0;
+		Clock::Nanoseconds LastHeard = 0;
+		SpectatorFrame::SharedPtr Pending;
+		bool bActive = false;
+	};
+
+	void Receive();
+	void Subscribe(const NetAddress& From, const uint32_t Match);
+	void Unsubscribe(const int Index);
+	void DropIdle(const Clock::Nanoseconds Now);
+	// Sends batches until the queue is empty, the socket is full or Deadline has passed
+	void Flush(const Clock::Nanoseconds Deadline);
+
+	static uint64_t MakeKey(const NetAddress& Address);
+
+	UdpSocket& Socket;
+	SocketPoller Poller;
+	// Reused by every wait, polling never allocates once it has grown
+	std::vector<SocketPoller::Event> PollEvents;
+	int MaxSubscribers;
+
+	std::vector<Subscriber> Subscribers;
+	std::vector<int> FreeSlots;
+	std::unordered_map<uint64_t, int> SubscribersByAddress;
+	std::unordered_map<uint32_t, std::vector<int>> Audiences;
+	std::unordered_map<uint32_t, uint32_t> Sequences;
+
+	// Subscribers with a pending frame in the order they got it, the ones before ReadyCursor are done
+	std::vector<int> Ready;
+	size_t ReadyCursor;
+	std::vector<OutgoingDatagram> Batch;
+	bool bBlocked;
+	Clock::Nanoseconds LastIdleCheck;
+
+	SpectatorStats Stats;
+};
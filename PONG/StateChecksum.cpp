@@ -0,0 +1,129 @@
+#include "StateChecksum.h"
+
+#include <cstring>
+
+#include "Game.h"
+
+static_assert(StateChecksum::FIELD_COUNT == 8, "Every field needs a byte of the 64 bit checksum");
+
+namespace
+{
+	uint32_t Bits(const float Value)
+	{
+		uint32_t Result;
+		std::memcpy(&Result, &Value, sizeof(Result));
+		return Result;
+	}
+
+	// FNV-1a step on a whole word
+	uint32_t Mix(const uint32_t Hash, const uint32_t Value)
+	{
+		return (Hash ^ Value) * 0x01000193u;
+	}
+
+	uint32_t HashVector(const glm::vec3& Vector)
+	{
+		return Mix(Mix(Mix(0x811C9DC5u, Bits(Vector.x)), Bits(Vector.y)), Bits(Vector.z));
+	}
+
+	uint8_t Fold(const uint32_t Hash)
+	{
+		const uint32_t Half = Hash ^ (Hash >> 16);
+		return static_cast<uint8_t>(Half ^ (Half >> 8));
+	}
+
+	// Rotating keeps the lane a bijection of its previous value, so equal inputs never merge two different lanes.
+	// After a desync the inputs differ too, and two different lanes land on the same value again one tick in 256.
+	uint64_t RollLane(const uint64_t Checksum, const StateChecksum::Field Which, const uint32_t Hash)
+	{
+		const int Shift = static_cast<int>(Which) * 8;
+		const uint8_t Lane = static_cast<uint8_t>(Checksum >> Shift);
+		const uint8_t Rolled = static_cast<uint8_t>(((Lane << 1) | (Lane >> 7)) ^ Fold(Hash));
+		return (Checksum & ~(0xFFull << Shift)) | (static_cast<uint64_t>(Rolled) << Shift);
+	}
+}
+
+uint64_t StateChecksum::Update(const uint64_t Previous, const Game& CurrentGame)
+{
+	const ::Ball& CurrentBall = CurrentGame.GetBall();
+	const MatchStats& Stats = CurrentGame.GetStats();
+
+	uint32_t TrailRandom = 0, BounceRandom = 0;
+	CurrentBall.GetRandomStates(TrailRandom, BounceRandom);
+
+	const uint32_t Score = Mix(Mix(Mix(0x811C9DC5u, static_cast<uint32_t>(CurrentGame.GetPlayerOneScore())),
+		static_cast<uint32_t>(CurrentGame.GetPlayerTwoScore())), static_cast<uint32_t>(CurrentGame.GetState()));
+	const uint32_t StatsHash = Mix(Mix(Mix(Mix(0x811C9DC5u, static_cast<uint32_t>(Stats.Rallies)), static_cast<uint32_t>(Stats.TotalHits)),
+		static_cast<uint32_t>(Stats.LongestRally)), static_cast<uint32_t>(Stats.CurrentRally));
+
+	uint64_t Checksum = Previous;
+	Checksum = RollLane(Checksum, BALL_LOCATION, HashVector(CurrentBall.GetLocation()));
+	Checksum = RollLane(Checksum, BALL_DIRECTION, HashVector(CurrentBall.GetDirection()));
+	Checksum = RollLane(Checksum, BALL_SPEED, Mix(0x811C9DC5u, Bits(CurrentBall.GetSpeed())));
+	Checksum = RollLane(Checksum, PLAYER_ONE, HashVector(CurrentGame.GetPlayerOne().GetLocation()));
+	Checksum = RollLane(Checksum, PLAYER_TWO, HashVector(CurrentGame.GetPlayerTwo().GetLocation()));
+	Checksum = RollLane(Checksum, SCORE, Score);
+	Checksum = RollLane(Checksum, STATS, StatsHash);
+	Checksum = RollLane(Checksum, RANDOM, Mix(Mix(0x811C9DC5u, TrailRandom), BounceRandom));
+
+	return Checksum;
+}
+
+uint8_t StateChecksum::Compare(const uint64_t Expected, const uint64_t Actual)
+{
+	const uint64_t Difference = Expected ^ Actual;
+
+	uint8_t Mask = 0;
+	for (int i = 0; i < FIELD_COUNT; ++i)
+	{
+		if ((Difference >> (i * 8)) & 0xFF)
+		{
+			Mask |= static_cast<uint8_t>(1 << i);
+		}
+	}
+
+	return Mask;
+}
+
+const char* StateChecksum::GetFieldName(const Field Which)
+{
+	switch (Which)
+	{
+	case BALL_LOCATION:
+		return "ball location";
+	case BALL_DIRECTION:
+		return "ball direction";
+	case BALL_SPEED:
+		return "ball speed";
+	case PLAYER_ONE:
+		return "player one location";
+	case PLAYER_TWO:
+		return "player two location";
+	case SCORE:
+		return "score and game state";
+	case STATS:
+		return "rally stats";
+	case RANDOM:
+		return "particle random state";
+	default:
+		return "unknown";
+	}
+}
+
+std::string StateChecksum::Describe(const uint8_t Mask)
+{
+	std::string Result;
+	for (int i = 0; i < FIELD_COUNT; ++i)
+	{
+		if (Mask & (1 << i))
+		{
+			if (!Result.empty())
+			{
+				Result += ", ";
+			}
+			Result += GetFieldName(static_cast<Field>(i));
+		}
+	}
+
+	return Result;
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+class Game;
+
+// Rolling per-tick checksum of everything that decides how a match goes on.
+// Each field has its own 8 bit lane in the 64 bit value, so comparing two checksums
+// tells which fields diverged. A diverged lane is not guaranteed to stay different: on every tick
+// after a desync it matches again with probability 1/256. Comparing every tick catches a desync
+// within a tick or two; comparing only the final value misses a one field divergence about once in 256.
+// Allocation free, a few dozen instructions per tick.
+namespace StateChecksum
+{
+	enum Field : uint8_t
+	{
+		BALL_LOCATION,
+		BALL_DIRECTION,
+		BALL_SPEED,
+		PLAYER_ONE,
+		PLAYER_TWO,
+		SCORE,
+		STATS,
+		RANDOM,
+		FIELD_COUNT
+	};
+
+	// Folds the state of the game after a tick into the checksum of the previous tick
+	uint64_t Update(const uint64_t Previous, const Game& CurrentGame);
+
+	// One bit per Field, set where the lanes differ
+	uint8_t Compare(const uint64_t Expected, const uint64_t Actual);
+
+	const char* GetFieldName(const Field Which);
+	// Comma separated field names of a Compare mask, only meant for reports
+	std::string Describe(const uint8_t Mask);
+}
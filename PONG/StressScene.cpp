@@ -0,0 +1,339 @@
+#include "StressScene.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "Assets.h"
+#include "Game.h"
+#include "pk/AssetManager.h"
+#include "pk/Clock.h"
+#include "pk/Common.h"
+#include "pk/Font.h"
+#include "pk/Renderer.h"
+#include "pk/Window.h"
+
+namespace
+{
+	// Fixed step, frames do not depend on how long the previous one took
+	constexpr float FRAME_DELTA = 1.f / 60.f;
+	constexpr float PI = 3.14159265358979f;
+	// Frame phase times in microsecond buckets, up to 100 ms
+	constexpr Clock::Nanoseconds TIME_BUCKET = 1000;
+	constexpr int TIME_BUCKETS = 100000;
+
+	constexpr float PARTICLE_SPEED = 60.f;
+	constexpr float PARTICLE_LIFE = 1.f;
+	constexpr float PARTICLE_SCALE = 4.f;
+	constexpr float MIN_ORBIT_RADIUS = 20.f;
+	constexpr float MAX_ORBIT_RADIUS = 150.f;
+	constexpr float MAX_ANGULAR_SPEED = 3.f;
+
+	const glm::vec3 BRICK_SIZE(5.f, 20.f, 1.f);
+	constexpr float MIN_TEXT_SCALE = 0.3f;
+	constexpr float MAX_TEXT_SCALE = 0.8f;
+
+	const char* const PHASE_NAMES[] = { "ball update", "particle update", "sprite render", "particle render", "text render",
+		"present", "frame" };
+	static_assert(sizeof(PHASE_NAMES) / sizeof(PHASE_NAMES[0]) == static_cast<size_t>(StressPhase::COUNT), "One name per phase");
+
+	// Uniform in [Min, Max], with the thousandth as resolution
+	float RandomRange(Random& Rng, const float Min, const float Max)
+	{
+		return Min + (Max - Min) * (Rng.Range(1001) / 1000.f);
+	}
+
+	uint64_t HashBytes(uint64_t Hash, const void* Data, const size_t Size)
+	{
+		const uint8_t* Bytes = static_cast<const uint8_t*>(Data);
+		for (size_t i = 0; i < Size; ++i)
+		{
+			Hash = (Hash ^ Bytes[i]) * 0x100000001B3ull;
+		}
+		return Hash;
+	}
+}
+
+StressScene::StressScene(Game& _Owner, const StressSettings& _Settings)
+	: Owner(_Owner), Settings(_Settings), SpriteDrawCalls(0), ParticleDrawCalls(0),
+		Times(static_cast<size_t>(StressPhase::COUNT), LatencyHistogram(TIME_BUCKET, TIME_BUCKETS)), FrameCount(0)
+{
+	AssetManager& mAssetManager = *Owner.GetAssetManager();
+	SpriteShader = mAssetManager.GetShader(Assets::MainShaderName);
+	BallTexture = mAssetManager.GetTexture(Assets::BallSpriteName);
+	TextFont = mAssetManager.GetFont(Assets::FontName);
+	Sprites = std::make_unique<SpriteBatch>(mAssetManager.GetShader(Assets::SpriteBatchShaderName), Owner.GetProjection());
+
+	// Each kind of object draws from its own sequence, changing one count leaves the others where they were
+	Random BallRng(Settings.Seed);
+	Random BrickRng(Settings.Seed + 1);
+	Random EmitterRng(Settings.Seed + 2);
+	Random TextRng(Settings.Seed + 3);
+
+	SpawnBalls(BallRng);
+	SpawnBricks(BrickRng);
+	SpawnEmitters(EmitterRng);
+	SpawnTexts(TextRng);
+}
+
+void StressScene::Frame(Window& Target)
+{
+	Clock::Nanoseconds Last = Clock::Now();
+	const Clock::Nanoseconds Start = Last;
+	const auto Measure = [this, &Last](const StressPhase Phase)
+	{
+		const Clock::Nanoseconds Now = Clock::Now();
+		Times[static_cast<size_t>(Phase)].Add(Now - Last);
+		Last = Now;
+	};
+
+	Target.ClearColor(Colors::LightBlack);
+	Target.ClearFlags(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+	UpdateBalls();
+	Measure(StressPhase::BALL_UPDATE);
+	UpdateParticles();
+	Measure(StressPhase::PARTICLE_UPDATE);
+	RenderSprites();
+	Measure(StressPhase::SPRITE_RENDER);
+	RenderParticles();
+	Measure(StressPhase::PARTICLE_RENDER);
+	RenderTexts();
+	Measure(StressPhase::TEXT_RENDER);
+
+	// Waits for the GPU too, so the frame time covers the work the calls above only queued
+	glFinish();
+	Target.CloseFrame();
+	Measure(StressPhase::PRESENT);
+
+	Times[static_cast<size_t>(StressPhase::FRAME)].Add(Clock::Now() - Start);
+	FrameCount++;
+}
+
+const LatencyHistogram& StressScene::GetTimes(const StressPhase Phase) const
+{
+	return Times[static_cast<size_t>(Phase)];
+}
+
+const char* StressScene::GetPhaseName(const StressPhase Phase)
+{
+	return PHASE_NAMES[static_cast<size_t>(Phase)];
+}
+
+int StressScene::CountLiveParticles() const
+{
+	int Live = 0;
+	for (const OrbitingEmitter& Orbit : Emitters)
+	{
+		Live += Orbit.Effect->CountLive();
+	}
+	return Live;
+}
+
+uint64_t StressScene::GetChecksum() const
+{
+	uint64_t Hash = 0xCBF29CE484222325ull;
+	Hash = HashBytes(Hash, BallX.data(), BallX.size() * sizeof(float));
+	Hash = HashBytes(Hash, BallY.data(), BallY.size() * sizeof(float));
+	Hash = HashBytes(Hash, BallSpeed.data(), BallSpeed.size() * sizeof(float));
+	for (const OrbitingEmitter& Orbit : Emitters)
+	{
+		const uint32_t State = Orbit.Effect->GetRandomState();
+		Hash = HashBytes(Hash, &State, sizeof(State));
+		Hash = HashBytes(Hash, &Orbit.Angle, sizeof(Orbit.Angle));
+	}
+	return Hash;
+}
+
+uint64_t StressScene::GetFrameCount() const
+{
+	return FrameCount;
+}
+
+int StressScene::GetSpriteDrawCalls() const
+{
+	return SpriteDrawCalls;
+}
+
+int StressScene::GetParticleDrawCalls() const
+{
+	return ParticleDrawCalls;
+}
+
+void StressScene::SpawnBalls(Random& Rng)
+{
+	const MatchSettings Defaults(glm::ivec2(Owner.GetScreenWidth(), Owner.GetScreenHeight()));
+	BallSize = Defaults.Ball.Size;
+
+	BallParameters.ArenaWidth = static_cast<float>(Owner.GetScreenWidth());
+	BallParameters.ArenaHeight = static_cast<float>(Owner.GetScreenHeight());
+	BallParameters.CenterX = BallParameters.ArenaWidth / 2.f;
+	BallParameters.CenterY = BallParameters.ArenaHeight / 2.f;
+	BallParameters.HalfWidth = BallSize.x / 2.f;
+	BallParameters.HalfHeight = BallSize.y / 2.f;
+	BallParameters.BaseSpeed = Defaults.BallSpeed;
+	BallParameters.SpeedIncrement = Defaults.BallSpeedIncrement;
+	BallParameters.MaxSpeed = Defaults.BallMaxSpeed;
+	BallParameters.Delta = FRAME_DELTA;
+
+	for (int i = 0; i < Settings.Balls; ++i)
+	{
+		const float Heading = RandomRange(Rng, 0.f, 2.f * PI);
+		BallX.push_back(RandomRange(Rng, BallParameters.HalfWidth, BallParameters.ArenaWidth - BallParameters.HalfWidth));
+		BallY.push_back(RandomRange(Rng, BallParameters.HalfHeight, BallParameters.ArenaHeight - BallParameters.HalfHeight));
+		BallDirectionX.push_back(std::cos(Heading));
+		BallDirectionY.push_back(std::sin(Heading));
+		BallSpeed.push_back(RandomRange(Rng, BallParameters.BaseSpeed, BallParameters.MaxSpeed));
+	}
+	BallEvents.resize(BallX.size());
+}
+
+void StressScene::SpawnBricks(Random& Rng)
+{
+	const Texture::SharedPtr BrickTexture = Owner.GetAssetManager()->GetTexture(Assets::BrickSpriteName);
+	Bricks.reserve(Settings.Bricks);
+	for (int i = 0; i < Settings.Bricks; ++i)
+	{
+		const glm::vec3 Location(RandomRange(Rng, 0.f, static_cast<float>(Owner.GetScreenWidth())),
+			RandomRange(Rng, 0.f, static_cast<float>(Owner.GetScreenHeight())), 0.f);
+
+		GameActor Brick(Location, BRICK_SIZE);
+		Brick.SetGame(&Owner);
+		Brick.SetTexture(BrickTexture);
+		Brick.SetColor(glm::vec3(RandomRange(Rng, 0.5f, 1.f), RandomRange(Rng, 0.5f, 1.f), RandomRange(Rng, 0.5f, 1.f)));
+		Bricks.push_back(Brick);
+	}
+}
+
+void StressScene::SpawnEmitters(Random& Rng)
+{
+	if (Settings.Emitters <= 0)
+	{
+		return;
+	}
+
+	AssetManager& mAssetManager = *Owner.GetAssetManager();
+	const Shader::SharedPtr ParticleShader = mAssetManager.GetShader(Assets::ParticleShaderName);
+	const Texture::SharedPtr ParticleTexture = mAssetManager.GetTexture(Assets::BallSpriteName);
+
+	// Pools are sized to the requested particles and spawn a little faster than particles die, so they stay full
+	const int PoolCapacity = std::max(Settings.Particles / Settings.Emitters, 1);
+	const int SpawnAmount = static_cast<int>(std::ceil(PoolCapacity * FRAME_DELTA / PARTICLE_LIFE)) + 1;
+
+	Emitters.reserve(Settings.Emitters);
+	for (int i = 0; i < Settings.Emitters; ++i)
+	{
+		OrbitingEmitter Orbit;
+		const ParticlePattern::Base::SharedPtr Pattern = std::make_shared<ParticlePattern::Linear>(PARTICLE_SPEED, PARTICLE_LIFE, SpawnAmount);
+		Orbit.Effect = std::make_unique<Emitter>(ParticleShader, ParticleTexture, PoolCapacity, Pattern, Owner.GetProjection());
+		Orbit.Effect->SetParticleScale(PARTICLE_SCALE);
+		Orbit.Effect->SetInstanced(Settings.bBatched);
+		Orbit.Effect->SetSeed(Rng.Next());
+		Orbit.Center = glm::vec2(RandomRange(Rng, 0.f, static_cast<float>(Owner.GetScreenWidth())),
+			RandomRange(Rng, 0.f, static_cast<float>(Owner.GetScreenHeight())));
+		Orbit.Radius = RandomRange(Rng, MIN_ORBIT_RADIUS, MAX_ORBIT_RADIUS);
+		Orbit.Angle = RandomRange(Rng, 0.f, 2.f * PI);
+		Orbit.AngularSpeed = RandomRange(Rng, -MAX_ANGULAR_SPEED, MAX_ANGULAR_SPEED);
+		Emitters.push_back(std::move(Orbit));
+	}
+}
+
+void StressScene::SpawnTexts(Random& Rng)
+{
+	Texts.reserve(Settings.Texts);
+	for (int i = 0; i < Settings.Texts; ++i)
+	{
+		StressText Text;
+		Text.Text = "Stress " + std::to_string(i) + " " + std::to_string(Rng.Next());
+		Text.Position = glm::vec2(RandomRange(Rng, 0.f, static_cast<float>(Owner.GetScreenWidth())),
+			RandomRange(Rng, 0.f, static_cast<float>(Owner.GetScreenHeight())));
+		Text.Scale = RandomRange(Rng, MIN_TEXT_SCALE, MAX_TEXT_SCALE);
+		if (Settings.bBatched)
+		{
+			Text.Mesh = std::make_unique<TextMesh>(TextFont);
+			Text.Mesh->Set(Text.Text, Text.Position, Text.Scale);
+		}
+		Texts.push_back(std::move(Text));
+	}
+}
+
+void StressScene::UpdateBalls()
+{
+	const BallKernel::BallArrays Arrays{ BallX.data(), BallY.data(), BallDirectionX.data(), BallDirectionY.data(), BallSpeed.data() };
+	BallKernel::Update(Arrays, BallEvents.data(), static_cast<int>(BallX.size()), BallParameters);
+}
+
+void StressScene::UpdateParticles()
+{
+	for (OrbitingEmitter& Orbit : Emitters)
+	{
+		Orbit.Angle += Orbit.AngularSpeed * FRAME_DELTA;
+		const glm::vec3 Position(Orbit.Center.x + std::cos(Orbit.Angle) * Orbit.Radius, Orbit.Center.y + std::sin(Orbit.Angle) * Orbit.Radius, 0.f);
+		// Particles leave outwards, the trails draw spirals
+		const glm::vec3 Direction(std::cos(Orbit.Angle), std::sin(Orbit.Angle), 0.f);
+		Orbit.Effect->Update(FRAME_DELTA, Position, Direction);
+	}
+}
+
+void StressScene::RenderSprites()
+{
+	const glm::vec3 White(1.f, 1.f, 1.f);
+	if (Settings.bBatched)
+	{
+		Sprites->Begin();
+		for (size_t i = 0; i < BallX.size(); ++i)
+		{
+			Sprites->Draw(BallTexture, glm::vec2(BallX[i], BallY[i]), glm::vec2(BallSize), White);
+		}
+
+		for (const GameActor& Brick : Bricks)
+		{
+			Brick.QueueSprite(*Sprites, 1.f);
+		}
+		Sprites->Flush();
+
+		SpriteDrawCalls = Sprites->GetDrawCalls();
+		return;
+	}
+
+	const glm::mat4 Identity(1.f);
+	for (size_t i = 0; i < BallX.size(); ++i)
+	{
+		glm::mat4 Model = glm::translate(Identity, glm::vec3(BallX[i], BallY[i], 0.f));
+		Model = glm::scale(Model, BallSize);
+		Renderer::Get().RenderSprite(SpriteShader, BallTexture, Model, White);
+	}
+
+	for (const GameActor& Brick : Bricks)
+	{
+		Brick.Render(1.f);
+	}
+	SpriteDrawCalls = static_cast<int>(BallX.size() + Bricks.size());
+}
+
+void StressScene::RenderParticles()
+{
+	ParticleDrawCalls = 0;
+	for (const OrbitingEmitter& Orbit : Emitters)
+	{
+		Orbit.Effect->Render();
+
+		const int Live = Orbit.Effect->CountLive();
+		ParticleDrawCalls += (Settings.bBatched) ? std::min(Live, 1) : Live;
+	}
+}
+
+void StressScene::RenderTexts() const
+{
+	for (const StressText& Text : Texts)
+	{
+		if (Text.Mesh != nullptr)
+		{
+			Text.Mesh->Render(Colors::White);
+			continue;
+		}
+
+		TextFont->Render(Text.Text, Text.Position, Text.Scale, Colors::White);
+	}
+}
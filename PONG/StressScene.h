@@ -0,0 +1,124 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "BallKernel.h"
+#include "GameActor.h"
+#include "pk/Emitter.h"
+#include "pk/LatencyHistogram.h"
+#include "pk/SpriteBatch.h"
+#include "pk/TextMesh.h"
+
+class Font;
+class Game;
+class Window;
+
+struct StressSettings
+{
+	int Balls = 1000;
+	int Bricks = 1000;
+	int Emitters = 100;
+	// Live particles, spread over the emitters
+	int Particles = 10000;
+	int Texts = 100;
+	uint32_t Seed = 1;
+	// Balls and bricks through a SpriteBatch, particles instanced and texts cached as meshes, or one draw call each
+	// and texts tessellated every frame
+	bool bBatched = true;
+};
+
+// Parts of a stress frame, each one timed on its own
+enum class StressPhase : uint8_t
+{
+	BALL_UPDATE,
+	PARTICLE_UPDATE,
+	SPRITE_RENDER,
+	PARTICLE_RENDER,
+	TEXT_RENDER,
+	PRESENT,
+	FRAME,
+	COUNT
+};
+
+// Synthetic scene with configurable counts of everything the game draws, to benchmark the renderer
+// well past what a match needs. Every frame advances by the same fixed delta and everything is
+// placed from the seed, so two runs with the same settings draw the same frames on any machine.
+class StressScene
+{
+public:
+	// Borrows the assets of a windowed game that already began
+	StressScene(Game& _Owner, const StressSettings& _Settings);
+
+	void Frame(Window& Target);
+
+	const LatencyHistogram& GetTimes(const StressPhase Phase) const;
+	static const char* GetPhaseName(const StressPhase Phase);
+
+	int CountLiveParticles() const;
+	// Hash of balls and emitters, equal across runs of the same settings and frame count
+	uint64_t GetChecksum() const;
+	uint64_t GetFrameCount() const;
+	// Draw calls of the last frame
+	int GetSpriteDrawCalls() const;
+	int GetParticleDrawCalls() const;
+
+private:
+	struct OrbitingEmitter
+	{
+		Emitter::UniquePtr Effect;
+		glm::vec2 Center;
+		float Radius;
+		float Angle;
+		float AngularSpeed;
+	};
+
+	struct StressText
+	{
+		std::string Text;
+		glm::vec2 Position;
+		float Scale;
+		// Batched scenes only
+		TextMesh::UniquePtr Mesh;
+	};
+
+	void SpawnBalls(Random& Rng);
+	void SpawnBricks(Random& Rng);
+	void SpawnEmitters(Random& Rng);
+	void SpawnTexts(Random& Rng);
+
+	void UpdateBalls();
+	void UpdateParticles();
+	void RenderSprites();
+	void RenderParticles();
+	void RenderTexts() const;
+
+	Game& Owner;
+	StressSettings Settings;
+	BallKernel::Params BallParameters;
+	glm::vec3 BallSize;
+
+	std::vector<float> BallX;
+	std::vector<float> BallY;
+	std::vector<float> BallDirectionX;
+	std::vector<float> BallDirectionY;
+	std::vector<float> BallSpeed;
+	std::vector<uint8_t> BallEvents;
+
+	std::vector<GameActor> Bricks;
+	std::vector<OrbitingEmitter> Emitters;
+	std::vector<StressText> Texts;
+
+	std::shared_ptr<Shader> SpriteShader;
+	Texture::SharedPtr BallTexture;
+	std::shared_ptr<Font> TextFont;
+	SpriteBatch::UniquePtr Sprites;
+	int SpriteDrawCalls;
+	int ParticleDrawCalls;
+
+	// One per StressPhase
+	std::vector<LatencyHistogram> Times;
+	uint64_t FrameCount;
+};
@@ -0,0 +1,228 @@
+#include "TournamentHost.h"
+
+#include <algorithm>
+#include <chrono>
+
+#include "Game.h"
+#include "PaddleController.h"
+#include "pk/LatencyHistogram.h"
+
+#if defined(_WIN32)
+#define NOMINMAX
+#include <windows.h>
+#elif defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace
+{
+	constexpr size_t ORDER_QUEUE = 1024;
+	constexpr size_t RESULT_QUEUE = 1024;
+	constexpr size_t REPORT_QUEUE = 64;
+	// Tick latency in microsecond buckets, up to 20 ms
+	constexpr Clock::Nanoseconds LATENCY_BUCKET = 1000;
+	constexpr int LATENCY_BUCKETS = 20000;
+
+	struct ShardMatch
+	{
+		std::unique_ptr<Game> Simulation;
+		uint32_t Id = 0;
+		uint32_t Ticks = 0;
+	};
+
+	// Best effort, the shard runs unpinned where the platform does not allow it
+	void PinToCore(std::thread& Worker, const int Core)
+	{
+		const unsigned int Cores = std::max(1u, std::thread::hardware_concurrency());
+#if defined(_WIN32)
+		SetThreadAffinityMask(static_cast<HANDLE>(Worker.native_handle()), DWORD_PTR(1) << (Core % Cores));
+#elif defined(__linux__)
+		cpu_set_t Set;
+		CPU_ZERO(&Set);
+		CPU_SET(Core % Cores, &Set);
+		pthread_setaffinity_np(Worker.native_handle(), sizeof(Set), &Set);
+#else
+		(void)Worker;
+		(void)Core;
+		(void)Cores;
+#endif
+	}
+
+	ShardMatch StartMatch(const TournamentMatch& Order, const MatchSettings& Settings, const int TickRate)
+	{
+		ShardMatch Started;
+		Started.Id = Order.Id;
+		Started.Simulation = std::make_unique<Game>(Settings);
+
+		Game& Simulation = *Started.Simulation;
+		Simulation.SetSeed(Order.Seed);
+		Simulation.SetEffectsEnabled(false);
+		Simulation.SetTickRate(TickRate);
+		Simulation.SetController(true, std::make_shared<AIController>(Order.PlayerOne.ReactionDelay, Order.PlayerOne.Error, Order.PlayerOne.Seed));
+		Simulation.SetController(false, std::make_shared<AIController>(Order.PlayerTwo.ReactionDelay, Order.PlayerTwo.Error, Order.PlayerTwo.Seed));
+		Simulation.Begin();
+		Simulation.StartMatch();
+		return Started;
+	}
+}
+
+TournamentHost::Shard::Shard(const int _Index)
+	: Index(_Index), Orders(ORDER_QUEUE), Results(RESULT_QUEUE), Reports(REPORT_QUEUE), Assigned(0)
+{
+}
+
+TournamentHost::TournamentHost(const MatchSettings& _Settings, const int ShardCount, const int _TickRate, const uint32_t _MaxTicks)
+	: Settings(_Settings), TickRate(std::max(_TickRate, 1)), MaxTicks(_MaxTicks), bStopping(false)
+{
+	for (int i = 0; i < std::max(ShardCount, 1); ++i)
+	{
+		Shards.push_back(std::make_unique<Shard>(i));
+	}
+
+	for (const std::unique_ptr<Shard>& Owner : Shards)
+	{
+		Shard* Target = Owner.get();
+		Owner->Worker = std::thread([this, Target]() { RunShard(*Target); });
+		PinToCore(Owner->Worker, Owner->Index);
+	}
+}
+
+TournamentHost::~TournamentHost()
+{
+	bStopping.store(true, std::memory_order_relaxed);
+	for (const std::unique_ptr<Shard>& Owner : Shards)
+	{
+		Owner->Worker.join();
+	}
+}
+
+void TournamentHost::Schedule(const TournamentMatch& Match)
+{
+	Shard& Target = **std::min_element(Shards.begin(), Shards.end(),
+		[](const std::unique_ptr<Shard>& A, const std::unique_ptr<Shard>& B) { return A->Assigned < B->Assigned; });
+
+	Target.Assigned++;
+	if (!Target.Backlog.empty() || !Target.Orders.Push(Match))
+	{
+		Target.Backlog.push_back(Match);
+	}
+}
+
+void TournamentHost::Update(std::vector<TournamentResult>& Results, std::vector<ShardReport>& Reports)
+{
+	for (const std::unique_ptr<Shard>& Owner : Shards)
+	{
+		while (!Owner->Backlog.empty() && Owner->Orders.Push(Owner->Backlog.front()))
+		{
+			Owner->Backlog.pop_front();
+		}
+
+		TournamentResult Result;
+		while (Owner->Results.Pop(Result))
+		{
+			Owner->Assigned--;
+			Results.push_back(Result);
+		}
+
+		ShardReport Report;
+		while (Owner->Reports.Pop(Report))
+		{
+			Reports.push_back(Report);
+		}
+	}
+}
+
+void TournamentHost::RunShard(Shard& Owner)
+{
+	const Clock::Nanoseconds Period = Clock::NanosecondsPerSecond / TickRate;
+	std::vector<ShardMatch> Matches;
+	std::vector<TournamentResult> Unsent;
+	LatencyHistogram Latency(LATENCY_BUCKET, LATENCY_BUCKETS);
+	uint64_t Ticks = 0;
+	uint64_t Overruns = 0;
+
+	Clock::Nanoseconds Due = Clock::Now();
+	while (!bStopping.load(std::memory_order_relaxed))
+	{
+		const Clock::Nanoseconds Now = Clock::Now();
+		if (Due > Now)
+		{
+			std::this_thread::sleep_for(std::chrono::nanoseconds(Due - Now));
+		}
+
+		TournamentMatch Order;
+		while (Owner.Orders.Pop(Order))
+		{
+			Matches.push_back(StartMatch(Order, Settings, TickRate));
+		}
+
+		for (size_t i = 0; i < Matches.size();)
+		{
+			ShardMatch& Current = Matches[i];
+			Game& Simulation = *Current.Simulation;
+			Simulation.Tick(Simulation.GetTickDelta());
+			Current.Ticks++;
+
+			if (Simulation.GetState() != GameState::MATCH || (MaxTicks > 0 && Current.Ticks >= MaxTicks))
+			{
+				Unsent.push_back(TournamentResult{ Current.Id, Simulation.GetPlayerOneScore(), Simulation.GetPlayerTwoScore(),
+					Current.Ticks, Simulation.GetChecksum(), Owner.Index });
+				Current = std::move(Matches.back());
+				Matches.pop_back();
+				continue;
+			}
+			++i;
+		}
+
+		// A full queue keeps them for the next tick, the aggregator is never waited for
+		size_t Sent = 0;
+		while (Sent < Unsent.size() && Owner.Results.Push(Unsent[Sent]))
+		{
+			Sent++;
+		}
+		Unsent.erase(Unsent.begin(), Unsent.begin() + static_cast<std::ptrdiff_t>(Sent));
+
+		const Clock::Nanoseconds End = Clock::Now();
+		Latency.Add(End - Due);
+		Ticks++;
+		if (End > Due + Period)
+		{
+			Overruns++;
+		}
+
+		if (Ticks % TickRate == 0)
+		{
+			Owner.Reports.Push(ShardReport{ Owner.Index, static_cast<int>(Matches.size()), Ticks,
+				Latency.Percentile(0.5), Latency.Percentile(0.99), Latency.GetMax(), Overruns });
+			Latency.Clear();
+		}
+
+		// More than a tick behind, the lost time is not made up with a burst of ticks
+		Due += Period;
+		if (End > Due + Period)
+		{
+			Due = End;
+		}
+	}
+}
+
+int TournamentHost::GetShards() const
+{
+	return static_cast<int>(Shards.size());
+}
+
+int TournamentHost::GetTickRate() const
+{
+	return TickRate;
+}
+
+int TournamentHost::GetPending() const
+{
+	int Pending = 0;
+	for (const std::unique_ptr<Shard>& Owner : Shards)
+	{
+		Pending += Owner->Assigned;
+	}
+	return Pending;
+}
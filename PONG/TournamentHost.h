@@ -0,0 +1,101 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "MatchSettings.h"
+#include "pk/Clock.h"
+#include "pk/SpscQueue.h"
+
+struct AIProfile
+{
+	float ReactionDelay;
+	float Error;
+	uint32_t Seed;
+};
+
+struct TournamentMatch
+{
+	uint32_t Id;
+	uint32_t Seed;
+	AIProfile PlayerOne;
+	AIProfile PlayerTwo;
+};
+
+struct TournamentResult
+{
+	uint32_t Id;
+	int PlayerOneScore;
+	int PlayerTwoScore;
+	uint32_t Ticks;
+	uint64_t Checksum;
+	int Shard;
+};
+
+// Sent to the aggregator once per second: latencies cover the last second, Ticks and Overruns
+// count from the start of the shard
+struct ShardReport
+{
+	int Shard;
+	int Matches;
+	uint64_t Ticks;
+	// Scheduled tick time to the end of its work, wake up delay included
+	Clock::Nanoseconds Median;
+	Clock::Nanoseconds P99;
+	Clock::Nanoseconds Max;
+	// Ticks that ended after the next one was due
+	uint64_t Overruns;
+};
+
+// Hosts many headless matches at a fixed tick rate on one worker thread per shard, each pinned to its own core.
+// Every match lives on exactly one shard for its whole life and its Game is never touched by another thread:
+// orders go in and results come out through single producer, single consumer lock-free queues.
+// The thread calling Schedule and Update is the aggregator, the only consumer of every shard's output.
+class TournamentHost
+{
+public:
+	TournamentHost(const MatchSettings& _Settings, const int ShardCount, const int _TickRate = 1000, const uint32_t _MaxTicks = 0);
+	// Stops and joins the shards, matches still running are dropped
+	~TournamentHost();
+
+	TournamentHost(const TournamentHost&) = delete;
+	TournamentHost& operator=(const TournamentHost&) = delete;
+
+	// Goes to the shard with the fewest matches
+	void Schedule(const TournamentMatch& Match);
+	// Collects finished matches and shard reports, and hands over orders that found a full queue
+	void Update(std::vector<TournamentResult>& Results, std::vector<ShardReport>& Reports);
+
+	int GetShards() const;
+	int GetTickRate() const;
+	// Scheduled and not reported finished yet
+	int GetPending() const;
+
+private:
+	struct Shard
+	{
+		Shard(const int _Index);
+
+		int Index;
+		std::thread Worker;
+		SpscQueue<TournamentMatch> Orders;
+		SpscQueue<TournamentResult> Results;
+		SpscQueue<ShardReport> Reports;
+
+		// Aggregator side
+		int Assigned;
+		std::deque<TournamentMatch> Backlog;
+	};
+
+	void RunShard(Shard& Owner);
+
+	MatchSettings Settings;
+	int TickRate;
+	uint32_t MaxTicks;
+	std::vector<std::unique_ptr<Shard>> Shards;
+	std::atomic<bool> bStopping;
+};
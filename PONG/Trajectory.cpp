@@ -0,0 +1,105 @@
+#include "Trajectory.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "Ball.h"
+
+namespace
+{
+	struct Folded
+	{
+		float Y;
+		int Bounces;
+	};
+
+	// Unfolds the walls into a line of mirrored arenas, then maps the straight line position back
+	Folded Fold(const float UnfoldedY, const Trajectory::Bounds& Limits)
+	{
+		const float Height = Limits.MaxY - Limits.MinY;
+		if (Height <= 0.f)
+		{
+			return Folded{ Limits.MinY, 0 };
+		}
+
+		const float Offset = UnfoldedY - Limits.MinY;
+		const float Cells = std::floor(Offset / Height);
+		const float Remainder = std::min(std::max(Offset - Cells * Height, 0.f), Height);
+
+		// Odd cells are mirrored
+		const int Bounces = static_cast<int>(std::abs(Cells));
+		const float Y = (Bounces % 2 == 0) ? Remainder : Height - Remainder;
+		return Folded{ Limits.MinY + Y, Bounces };
+	}
+
+	Trajectory::Intercept PredictOne(const float X, const float Y, const float DirectionX, const float DirectionY, const float Speed,
+		const float TargetX, const Trajectory::Bounds& Limits)
+	{
+		Trajectory::Intercept Result;
+
+		const float Length = std::sqrt(DirectionX * DirectionX + DirectionY * DirectionY);
+		if (Length <= 0.f || Speed <= 0.f)
+		{
+			return Result;
+		}
+
+		const float VelocityX = DirectionX / Length * Speed;
+		const float VelocityY = DirectionY / Length * Speed;
+		const float Time = (VelocityX != 0.f) ? (TargetX - X) / VelocityX : -1.f;
+		if (Time < 0.f)
+		{
+			return Result;
+		}
+
+		const Folded Landing = Fold(Y + VelocityY * Time, Limits);
+
+		Result.bReaches = true;
+		Result.Y = Landing.Y;
+		Result.Time = Time;
+		Result.Bounces = Landing.Bounces;
+		Result.DirectionY = ((Landing.Bounces % 2 == 0) ? 1.f : -1.f) * ((VelocityY > 0.f) ? 1.f : ((VelocityY < 0.f) ? -1.f : 0.f));
+		return Result;
+	}
+}
+
+Trajectory::Bounds Trajectory::MakeBounds(const float ArenaHeight, const float BallHalfHeight)
+{
+	return Bounds{ BallHalfHeight, ArenaHeight - BallHalfHeight };
+}
+
+glm::vec2 Trajectory::Advance(const BallState& State, const float Time, const Bounds& Limits)
+{
+	const glm::vec2 Velocity = glm::normalize(State.Direction) * State.Speed;
+	const glm::vec2 Unfolded = State.Location + Velocity * Time;
+	return glm::vec2(Unfolded.x, Fold(Unfolded.y, Limits).Y);
+}
+
+Trajectory::Intercept Trajectory::Predict(const BallState& State, const float TargetX, const Bounds& Limits)
+{
+	return PredictOne(State.Location.x, State.Location.y, State.Direction.x, State.Direction.y, State.Speed, TargetX, Limits);
+}
+
+Trajectory::Intercept Trajectory::Predict(const Ball& CurrentBall, const float TargetX, const float ArenaHeight)
+{
+	const glm::vec3 Location = CurrentBall.GetLocation();
+	const glm::vec3 Direction = CurrentBall.GetDirection();
+	const Bounds Limits = MakeBounds(ArenaHeight, CurrentBall.GetSize().y / 2.f);
+
+	return PredictOne(Location.x, Location.y, Direction.x, Direction.y, CurrentBall.GetSpeed(), TargetX, Limits);
+}
+
+void Trajectory::Predict(const BallState* States, const int Count, const float TargetX, const Bounds& Limits, Intercept* Results)
+{
+	for (int i = 0; i < Count; ++i)
+	{
+		Results[i] = Predict(States[i], TargetX, Limits);
+	}
+}
+
+void Trajectory::Predict(const BallKernel::BallArrays& Balls, const int Count, const float TargetX, const Bounds& Limits, Intercept* Results)
+{
+	for (int i = 0; i < Count; ++i)
+	{
+		Results[i] = PredictOne(Balls.X[i], Balls.Y[i], Balls.DirectionX[i], Balls.DirectionY[i], Balls.Speed[i], TargetX, Limits);
+	}
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include "BallKernel.h"
+
+class Ball;
+
+// Closed form ball flight between the top and bottom walls.
+// Any number of wall reflections is folded with a modulo, so every query is O(1).
+// Paddles are ignored: the prediction is where the ball goes if nobody touches it.
+namespace Trajectory
+{
+	// Range of y the ball center can reach, walls shrunk by the ball half height
+	struct Bounds
+	{
+		float MinY;
+		float MaxY;
+	};
+
+	struct BallState
+	{
+		glm::vec2 Location;
+		glm::vec2 Direction;
+		float Speed;
+	};
+
+	struct Intercept
+	{
+		// False when the ball is not moving towards TargetX
+		bool bReaches = false;
+		float Y = 0.f;
+		// Seconds until the ball center crosses TargetX
+		float Time = 0.f;
+		// Vertical direction sign when crossing, after all the reflections
+		float DirectionY = 0.f;
+		int Bounces = 0;
+	};
+
+	Bounds MakeBounds(const float ArenaHeight, const float BallHalfHeight);
+
+	// Where the ball is after Time seconds, without any paddle in the way
+	glm::vec2 Advance(const BallState& State, const float Time, const Bounds& Limits);
+
+	Intercept Predict(const BallState& State, const float TargetX, const Bounds& Limits);
+	Intercept Predict(const Ball& CurrentBall, const float TargetX, const float ArenaHeight);
+
+	// Batches, one intercept per ball against the same TargetX
+	void Predict(const BallState* States, const int Count, const float TargetX, const Bounds& Limits, Intercept* Results);
+	void Predict(const BallKernel::BallArrays& Balls, const int Count, const float TargetX, const Bounds& Limits, Intercept* Results);
+}
@@ -0,0 +1,168 @@
+#include "VectorEnv.h"
+
+#include "Game.h"
+
+namespace
+{
+	constexpr int DEFAULT_MAX_EPISODE_TICKS = 240 * 60 * 5;
+	// Vertical part of a serve, the horizontal one is always one unit towards either side
+	constexpr float MAX_SERVE_SLOPE = 0.75f;
+	constexpr int SERVE_STEPS = 1024;
+	// Opponent streams differ from the serve stream of the same seed
+	constexpr uint32_t OPPONENT_SEED_SALT = 0x9E3779B9u;
+
+	glm::vec3 DrawServe(Random& Rng)
+	{
+		const float Side = (Rng.Range(2) == 0) ? -1.f : 1.f;
+		const float Slope = (static_cast<float>(Rng.Range(SERVE_STEPS + 1)) / SERVE_STEPS * 2.f - 1.f) * MAX_SERVE_SLOPE;
+		return glm::vec3(Side, Slope, 0.f);
+	}
+
+	// Replays whatever the agent wrote in its action slot for this step
+	class ActionController : public PaddleController
+	{
+	public:
+		ActionController(const PaddleCommand* _Action)
+			: Action(_Action)
+		{
+		}
+
+		virtual PaddleCommand Decide(const Player& Paddle, const Game& CurrentGame, const float Delta) override
+		{
+			return *Action;
+		}
+
+	private:
+		const PaddleCommand* Action;
+	};
+}
+
+VectorEnv::VectorEnv(const int _Count, const MatchSettings& _Settings, const ControllerFactory& OpponentFactory)
+	: Count(_Count), MaxEpisodeTicks(DEFAULT_MAX_EPISODE_TICKS), Settings(_Settings),
+		Opponents(_Count), Seeds(_Count, 0), ServeRandoms(_Count), Actions(_Count, PaddleCommand::HOLD), EpisodeTicks(_Count, 0),
+		Observations(_Count * ObservationSize, 0.f), Rewards(_Count, 0.f), Dones(_Count, 0)
+{
+	Games.reserve(Count);
+	for (int i = 0; i < Count; ++i)
+	{
+		std::unique_ptr<Game> Env = std::make_unique<Game>(Settings);
+		Env->SetEffectsEnabled(false);
+		Seeds[i] = static_cast<uint32_t>(i);
+		Env->SetSeed(Seeds[i]);
+		Env->SetController(true, std::make_shared<ActionController>(&Actions[i]));
+		if (OpponentFactory)
+		{
+			Opponents[i] = OpponentFactory(i);
+			Env->SetController(false, Opponents[i]);
+		}
+
+		Env->Begin();
+		Games.push_back(std::move(Env));
+	}
+}
+
+VectorEnv::~VectorEnv() = default;
+
+int VectorEnv::GetCount() const
+{
+	return Count;
+}
+
+void VectorEnv::SetMaxEpisodeTicks(const int MaxTicks)
+{
+	MaxEpisodeTicks = MaxTicks;
+}
+
+VectorEnv::StepResult VectorEnv::Reset(const uint32_t* NewSeeds)
+{
+	for (int i = 0; i < Count; ++i)
+	{
+		if (NewSeeds != nullptr)
+		{
+			Seeds[i] = NewSeeds[i];
+		}
+
+		Games[i]->SetSeed(Seeds[i]);
+		ServeRandoms[i].Seed(Seeds[i]);
+		if (Opponents[i] != nullptr)
+		{
+			Opponents[i]->Reset(Seeds[i] ^ OPPONENT_SEED_SALT);
+		}
+
+		ResetEnv(i);
+		Rewards[i] = 0.f;
+		Dones[i] = 0;
+		WriteObservation(i);
+	}
+
+	return GetResult();
+}
+
+VectorEnv::StepResult VectorEnv::Step(const PaddleCommand* _Actions)
+{
+	std::copy(_Actions, _Actions + Count, Actions.begin());
+
+	for (int i = 0; i < Count; ++i)
+	{
+		Game& Env = *Games[i];
+		const int PlayerOneScore = Env.GetPlayerOneScore();
+		const int PlayerTwoScore = Env.GetPlayerTwoScore();
+
+		Env.Tick(Env.GetTickDelta());
+		EpisodeTicks[i]++;
+
+		// Points scored during the tick, from the agent point of view
+		Rewards[i] = static_cast<float>((Env.GetPlayerOneScore() - PlayerOneScore) - (Env.GetPlayerTwoScore() - PlayerTwoScore));
+
+		const bool bDone = Env.GetState() != GameState::MATCH || EpisodeTicks[i] >= MaxEpisodeTicks;
+		Dones[i] = bDone ? 1 : 0;
+		if (bDone)
+		{
+			ResetEnv(i);
+		}
+
+		WriteObservation(i);
+	}
+
+	return GetResult();
+}
+
+void VectorEnv::ResetEnv(const int Index)
+{
+	Game& Env = *Games[Index];
+	Env.SetServeDirection(DrawServe(ServeRandoms[Index]));
+	Env.Restart();
+	Env.StartMatch();
+	EpisodeTicks[Index] = 0;
+}
+
+void VectorEnv::WriteObservation(const int Index)
+{
+	const Game& Env = *Games[Index];
+	const Ball& EnvBall = Env.GetBall();
+
+	const float Width = static_cast<float>(Env.GetScreenWidth());
+	const float Height = static_cast<float>(Env.GetScreenHeight());
+
+	const glm::vec3 BallLocation = EnvBall.GetLocation();
+	const glm::vec3 Direction = glm::normalize(EnvBall.GetDirection());
+
+	float* Observation = &Observations[Index * ObservationSize];
+	Observation[0] = BallLocation.x / Width;
+	Observation[1] = BallLocation.y / Height;
+	Observation[2] = Direction.x;
+	Observation[3] = Direction.y;
+	Observation[4] = EnvBall.GetSpeed() / EnvBall.GetMaxSpeed();
+	Observation[5] = Env.GetPlayerOne().GetLocation().y / Height;
+	Observation[6] = Env.GetPlayerTwo().GetLocation().y / Height;
+}
+
+VectorEnv::StepResult VectorEnv::GetResult() const
+{
+	StepResult Result;
+	Result.Observations = Observations.data();
+	Result.Rewards = Rewards.data();
+	Result.Dones = Dones.data();
+
+	return Result;
+}
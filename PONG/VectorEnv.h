@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "MatchSettings.h"
+#include "PaddleController.h"
+
+class Game;
+
+// Steps many headless games in lockstep for paddle training.
+// The agent drives player one of every environment, player two is driven by an opponent controller.
+// All inputs and outputs live in flat buffers owned by the VectorEnv, stepping never allocates.
+class VectorEnv
+{
+public:
+	typedef std::function<PaddleController::SharedPtr(const int EnvIndex)> ControllerFactory;
+
+	// Ball x, ball y, direction x, direction y, speed, agent paddle y, opponent paddle y
+	static constexpr int ObservationSize = 7;
+
+	struct StepResult
+	{
+		const float* Observations;
+		const float* Rewards;
+		const uint8_t* Dones;
+	};
+
+	VectorEnv(const int _Count, const MatchSettings& _Settings, const ControllerFactory& OpponentFactory);
+	~VectorEnv();
+
+	VectorEnv(const VectorEnv&) = delete;
+	void operator=(const VectorEnv&) = delete;
+
+	int GetCount() const;
+	void SetMaxEpisodeTicks(const int MaxTicks);
+
+	// Seeds may be null, every environment then keeps its current seed. An environment's seed picks the
+	// serve of each of its episodes and reseeds its opponent, resetting with the same seeds replays the same run.
+	StepResult Reset(const uint32_t* NewSeeds);
+	// One PaddleCommand per environment. Finished environments are reset in place,
+	// their observation is already the first one of the next episode.
+	StepResult Step(const PaddleCommand* Actions);
+
+private:
+	void ResetEnv(const int Index);
+	void WriteObservation(const int Index);
+	StepResult GetResult() const;
+
+	int Count;
+	int MaxEpisodeTicks;
+	MatchSettings Settings;
+
+	std::vector<std::unique_ptr<Game>> Games;
+	std::vector<PaddleController::SharedPtr> Opponents;
+	std::vector<uint32_t> Seeds;
+	std::vector<Random> ServeRandoms;
+	std::vector<PaddleCommand> Actions;
+	std::vector<int> EpisodeTicks;
+
+	std::vector<float> Observations;
+	std::vector<float> Rewards;
+	std::vector<uint8_t> Dones;
+};
@@ -3,51 +3,294 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
+#include <algorithm>
 #include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
 
+#include "pk/Clock.h"
 #include "pk/Window.h"
 #include "pk/Font.h"
 #include "Game.h"
 #include "GameActor.h"
+#include "MatchSettings.h"
+#include "PaddleController.h"
+#include "Replay.h"
+#include "Rollback.h"
+#include "StateChecksum.h"
+#include "StressScene.h"
+#include "pk/UdpSocket.h"
 
 constexpr int WINDOW_WIDTH = 800;
 constexpr int WINDOW_HEIGHT = 600;
 const std::string WINDOW_TITLE = "PONG";
 
-constexpr float PLAYER_SPEED = 600.f;
+constexpr int HEADLESS_DEFAULT_TICKS = 1000000;
+constexpr uint32_t HEADLESS_DEFAULT_SEED = 1;
+constexpr float HEADLESS_AI_REACTION_DELAY = 0.15f;
+constexpr float HEADLESS_AI_ERROR = 60.f;
 
-constexpr float BALL_BASE_SPEED = 300.f;
-constexpr float BALL_MAX_SPEED = 600.f;
-constexpr float BALL_SPEED_INCREMENT = 50.f;
+constexpr int STRESS_DEFAULT_FRAMES = 600;
 
-constexpr int WIN_SCORE = 5;
+constexpr double NETPLAY_CONNECT_TIMEOUT = 30.0;
+constexpr double NETPLAY_PEER_TIMEOUT = 5.0;
+// Keeps answering after the match so the peer gets our last acknowledgements
+constexpr double NETPLAY_LINGER = 0.5;
 
-int main(int argc, char** argv)
+struct NetplayOptions
 {
-    Window w(WINDOW_WIDTH, WINDOW_HEIGHT, WINDOW_TITLE);
+    uint16_t LocalPort = 0;
+    NetAddress Remote;
+    bool bPlayerOne = true;
+    uint32_t Seed = 1;
+    int MaxRollback = 16;
+    int InputDelay = 0;
+    int Latency = 0; // Milliseconds, one way
+    int Jitter = 0;
+    int Loss = 0; // Percent of datagrams
+    double Speed = 1.0;
+};
+
+// Runs the simulation without window, GL context or sound for a fixed amount of ticks
+int RunHeadless(const int Ticks, const glm::ivec2& ArenaSize, const uint32_t Seed, const std::string& RecordPath)
+{
+    const MatchSettings Settings(ArenaSize);
+
+    Game g(Settings);
+    // The AI aiming errors decide the match, they follow the seed like in PONGBatch
+    g.SetSeed(Seed);
+    g.SetController(true, std::make_shared<AIController>(HEADLESS_AI_REACTION_DELAY, HEADLESS_AI_ERROR, Seed * 2 + 1));
+    g.SetController(false, std::make_shared<AIController>(HEADLESS_AI_REACTION_DELAY, HEADLESS_AI_ERROR, Seed * 2 + 2));
+
+    ReplayRecorder::UniquePtr Recorder;
+    try
+    {
+        if (!RecordPath.empty())
+        {
+            Recorder = std::make_unique<ReplayRecorder>(RecordPath, Settings, g);
+            g.SetRecorder(Recorder.get());
+        }
+    } catch (const std::runtime_error& Error)
+    {
+        std::cout << "Game Error: " << Error.what() << "\n";
+        return -1;
+    }
 
-    glm::vec2 ScreenCenter = w.GetScreenCenter();
-    glm::vec3 PlayerOnePos(ScreenCenter.x - 350.f, ScreenCenter.y, 0.f);
-    glm::vec3 PlayerTwoPos(ScreenCenter.x + 350.f, ScreenCenter.y, 0.f);
-    glm::vec3 PlayerSize(6.5f, 80.f, 1.f);
+    g.Begin();
+    g.StartMatch();
 
-    Transform PlayerOne(PlayerOnePos, PlayerSize);
-    Transform PlayerTwo(PlayerTwoPos, PlayerSize);
+    const Clock::Nanoseconds Start = Clock::Now();
 
-    glm::vec3 BallBasePos(ScreenCenter.x, ScreenCenter.y, 1.f);
-    glm::vec3 BallSize(10.f, 12.f, 1.f);
-    glm::vec3 BallDirection(1.f, 0.5f, 0.f);
+    int Tick = 0;
+    for (; Tick < Ticks && g.GetState() == GameState::MATCH; ++Tick)
+    {
+        g.Tick(g.GetTickDelta());
+    }
 
-    Transform BallTransform(BallBasePos, BallSize);
+    const double Elapsed = static_cast<double>(Clock::Now() - Start) / Clock::NanosecondsPerSecond;
+    const double TicksPerSecond = (Elapsed > 0.0) ? Tick / Elapsed : 0.0;
 
-    Game g(&w, PlayerOne, PlayerTwo, PLAYER_SPEED, BallTransform, BallDirection, BALL_BASE_SPEED, BALL_SPEED_INCREMENT, BALL_MAX_SPEED, WIN_SCORE);
+    std::cout << "Seed: " << Seed << "\n";
+    std::cout << "Final score: " << g.GetPlayerOneScore() << " - " << g.GetPlayerTwoScore() << "\n";
+    std::cout << "Ticks: " << Tick << " in " << Elapsed << "s (" << TicksPerSecond << " ticks/s)\n";
 
+    if (Recorder)
+    {
+        try
+        {
+            Recorder->Close(g);
+        } catch (const ReplayRecorder::WriteError& Error)
+        {
+            std::cout << "Game Error: " << Error.what() << "\n";
+            return -1;
+        }
+        std::cout << "Replay written to " << RecordPath << "\n";
+    }
+
+    return 0;
+}
+
+// Plays a replay file without window and checks it ends the way the recording did
+int RunReplay(const std::string& Path)
+{
+    Replay::SharedPtr Data;
+    try
+    {
+        Data = std::make_shared<Replay>(Path);
+    } catch (const Replay::LoadError& Error)
+    {
+        std::cout << "Replay Error: " << Error.what() << "\n";
+        return -1;
+    }
+
+    std::unique_ptr<Game> g = Replay::CreateGame(Data);
+    g->Begin();
+    g->StartMatch();
+
+    const Clock::Nanoseconds Start = Clock::Now();
+    uint8_t Mask = 0;
+    const int DivergedTick = Data->Verify(*g, Mask);
+    const double Elapsed = static_cast<double>(Clock::Now() - Start) / Clock::NanosecondsPerSecond;
+
+    if (DivergedTick >= 0)
+    {
+        std::cout << "Playback DIVERGED from the recording at tick " << DivergedTick << ": " << StateChecksum::Describe(Mask) << "\n";
+        return 1;
+    }
+
+    const ReplayHeader& Header = Data->GetHeader();
+    const glm::vec3 BallLocation = g->GetBall().GetLocation();
+    const bool bSameEnd = g->GetPlayerOneScore() == Header.FinalPlayerOneScore && g->GetPlayerTwoScore() == Header.FinalPlayerTwoScore
+        && BallLocation.x == Header.FinalBallLocation[0] && BallLocation.y == Header.FinalBallLocation[1];
+
+    std::cout << "Replayed " << Data->GetTickCount() << " ticks in " << Elapsed << "s\n";
+    std::cout << "Final score: " << g->GetPlayerOneScore() << " - " << g->GetPlayerTwoScore()
+        << " (recorded " << Header.FinalPlayerOneScore << " - " << Header.FinalPlayerTwoScore << ")\n";
+    std::cout << ((bSameEnd) ? "Playback matches the recording\n" : "Playback DIVERGED from the recording\n");
+
+    return (bSameEnd) ? 0 : 1;
+}
+
+void PrintNetplayStats(const RollbackSession& Session, const UdpSocket& Socket, const Game& g)
+{
+    const RollbackStats& Stats = Session.GetStats();
+    const double Ticks = static_cast<double>(std::max<uint64_t>(Stats.Ticks, 1));
+    const double Rollbacks = static_cast<double>(std::max<uint64_t>(Stats.Rollbacks, 1));
+
+    std::cout << "Final score: " << g.GetPlayerOneScore() << " - " << g.GetPlayerTwoScore() << "\n";
+    std::cout << "Ticks: " << Stats.Ticks << ", stalled " << Stats.Stalls << " times waiting for the peer\n";
+    std::cout << "Rollbacks: " << Stats.Rollbacks << " (" << 100.0 * Stats.Rollbacks / Ticks << "% of ticks), "
+        << Stats.ResimulatedTicks / Rollbacks << " ticks deep on average, " << Stats.MaxDepth << " at most\n";
+    std::cout << "Resimulation: " << Clock::ToSeconds(Stats.ResimulationTime) * 1000.0 << " ms total, "
+        << Stats.ResimulationTime / Rollbacks / 1000.0 << " us per rollback\n";
+    std::cout << "Datagrams: " << Stats.PacketsSent << " sent (" << Socket.GetSimulatedLosses() << " dropped on purpose), "
+        << Stats.PacketsReceived << " received\n";
+    std::cout << "Checksums compared with the peer: " << Stats.ChecksumsCompared;
+    if (Stats.DesyncTick >= 0)
+    {
+        std::cout << ", DESYNC at tick " << Stats.DesyncTick;
+    }
+    std::cout << "\nFinal checksum: " << std::hex << g.GetChecksum() << std::dec << "\n";
+}
+
+RollbackSession::UniquePtr MakeSession(Game& g, UdpSocket& Socket, const NetplayOptions& Options)
+{
+    RollbackSession::UniquePtr Session = std::make_unique<RollbackSession>(g, Socket, Options.Remote, Options.bPlayerOne,
+        Options.MaxRollback, Options.InputDelay);
+    Socket.SetSimulatedLatency(Options.Latency * Clock::NanosecondsPerSecond / 1000, Options.Jitter * Clock::NanosecondsPerSecond / 1000);
+    Socket.SetSimulatedLoss(Options.Loss);
+    return Session;
+}
+
+// One AI paddle against the peer's, ticking in real time (scaled by Speed)
+int RunNetplay(const NetplayOptions& Options)
+{
+    const MatchSettings Settings(glm::ivec2(WINDOW_WIDTH, WINDOW_HEIGHT));
+
+    Game g(Settings);
+    g.SetSeed(Options.Seed);
+    g.SetEffectsEnabled(false);
+    g.SetController(Options.bPlayerOne, std::make_shared<AIController>(HEADLESS_AI_REACTION_DELAY, HEADLESS_AI_ERROR, Options.bPlayerOne ? 1 : 2));
+    g.Begin();
+
+    try
+    {
+        UdpSocket Socket(Options.LocalPort);
+        RollbackSession::UniquePtr Session = MakeSession(g, Socket, Options);
+
+        std::cout << "Waiting for " << Options.Remote.ToString() << " on port " << Socket.GetPort() << "\n";
+
+        const Clock::Nanoseconds TickDuration = Clock::FromSeconds(g.GetTickDelta() / Options.Speed);
+        const Clock::Nanoseconds Start = Clock::Now();
+        Clock::Nanoseconds NextTick = Start;
+        Clock::Nanoseconds LastHeard = Start;
+        uint64_t LastReceived = 0;
+        Clock::Nanoseconds FinishedAt = 0;
+
+        while (FinishedAt == 0 || Clock::Now() - FinishedAt < Clock::FromSeconds(NETPLAY_LINGER))
+        {
+            const Clock::Nanoseconds Now = Clock::Now();
+            if (Now < NextTick)
+            {
+                Session->Poll();
+                std::this_thread::sleep_for(std::chrono::microseconds(200));
+                continue;
+            }
+
+            Session->Advance();
+            NextTick += TickDuration;
+
+            if (Session->GetStats().PacketsReceived != LastReceived)
+            {
+                LastReceived = Session->GetStats().PacketsReceived;
+                LastHeard = Now;
+            }
+
+            const double Silence = static_cast<double>(Now - LastHeard) / Clock::NanosecondsPerSecond;
+            if (FinishedAt == 0 && Silence > (Session->IsConnected() ? NETPLAY_PEER_TIMEOUT : NETPLAY_CONNECT_TIMEOUT))
+            {
+                std::cout << "Netplay Error: no news from the peer for " << Silence << "s\n";
+                PrintNetplayStats(*Session, Socket, g);
+                return 1;
+            }
+
+            if (FinishedAt == 0 && Session->IsFinished())
+            {
+                FinishedAt = Now;
+            }
+        }
+
+        PrintNetplayStats(*Session, Socket, g);
+        return (Session->GetStats().DesyncTick < 0) ? 0 : 1;
+    } catch (const std::runtime_error& Error)
+    {
+        std::cout << "Netplay Error: " << Error.what() << "\n";
+        return -1;
+    }
+}
+
+int RunWindowed(const std::string& RecordPath, const NetplayOptions* Netplay, const double TimeScale)
+{
+    Window w(WINDOW_WIDTH, WINDOW_HEIGHT, WINDOW_TITLE);
+
+    const MatchSettings Settings(glm::ivec2(w.GetWidth(), w.GetHeight()));
+
+    Game g(&w, Settings.PlayerOne, Settings.PlayerTwo, Settings.PlayerSpeed, Settings.Ball, Settings.BallDirection,
+        Settings.BallSpeed, Settings.BallSpeedIncrement, Settings.BallMaxSpeed, Settings.WinScore
+    );
+
+    ReplayRecorder::UniquePtr Recorder;
+    UdpSocket::UniquePtr Socket;
+    RollbackSession::UniquePtr Session;
     try
     {
         w.Initialize();
         w.SetInputMode(GLFW_CURSOR, GLFW_CURSOR_DISABLED);
 
+        if (Netplay != nullptr)
+        {
+            g.SetSeed(Netplay->Seed);
+        }
+
         g.Begin();
+        g.SetTimeScale(TimeScale);
+
+        // The local paddle keeps its keys, W/S for player one and the arrows for player two
+        if (Netplay != nullptr)
+        {
+            Socket = std::make_unique<UdpSocket>(Netplay->LocalPort);
+            Session = MakeSession(g, *Socket, *Netplay);
+            g.SetSession(Session.get());
+        }
+
+        if (!RecordPath.empty())
+        {
+            Recorder = std::make_unique<ReplayRecorder>(RecordPath, Settings, g);
+            g.SetRecorder(Recorder.get());
+        }
     } catch (const std::runtime_error& Error)
     {
         std::cout << "Game Error: " << Error.what() << "\n";
@@ -55,10 +298,300 @@ int main(int argc, char** argv)
     }
 
     // Render loop
-    while (!g.ShouldClose())
+    try
+    {
+        while (!g.ShouldClose())
+        {
+            g.Frame();
+        }
+    } catch (const RollbackSession::Error& Error)
     {
-        g.Frame();
+        std::cout << "Netplay Error: " << Error.what() << "\n";
+        return -1;
+    }
+
+    if (Recorder)
+    {
+        try
+        {
+            Recorder->Close(g);
+        } catch (const ReplayRecorder::WriteError& Error)
+        {
+            std::cout << "Game Error: " << Error.what() << "\n";
+            return -1;
+        }
+    }
+
+    if (Session)
+    {
+        PrintNetplayStats(*Session, *Socket, g);
     }
 
     return 0;
 }
+
+// Draws a synthetic scene for a fixed amount of frames and reports the time of each part of a frame
+int RunStress(const int Frames, const StressSettings& Settings)
+{
+    Window w(WINDOW_WIDTH, WINDOW_HEIGHT, WINDOW_TITLE);
+
+    const MatchSettings Match(glm::ivec2(w.GetWidth(), w.GetHeight()));
+
+    Game g(&w, Match.PlayerOne, Match.PlayerTwo, Match.PlayerSpeed, Match.Ball, Match.BallDirection,
+        Match.BallSpeed, Match.BallSpeedIncrement, Match.BallMaxSpeed, Match.WinScore
+    );
+
+    std::unique_ptr<StressScene> Scene;
+    try
+    {
+        w.Initialize();
+        // Frames as fast as they can go, vertical sync would hide the cost of a frame
+        glfwSwapInterval(0);
+        g.Begin();
+        Scene = std::make_unique<StressScene>(g, Settings);
+    } catch (const std::runtime_error& Error)
+    {
+        std::cout << "Game Error: " << Error.what() << "\n";
+        return -1;
+    }
+
+    for (int Frame = 0; Frame < Frames && !w.ShouldClose(); ++Frame)
+    {
+        Scene->Frame(w);
+    }
+
+    std::cout << "Stress scene: " << Settings.Balls << " balls, " << Settings.Bricks << " bricks, " << Settings.Emitters << " emitters, "
+        << Scene->CountLiveParticles() << " live particles, " << Settings.Texts << " texts, seed " << Settings.Seed << "\n";
+    std::cout << "Draw calls a frame (" << ((Settings.bBatched) ? "batched" : "unbatched") << "): " << Scene->GetSpriteDrawCalls()
+        << " sprites, " << Scene->GetParticleDrawCalls() << " particles\n";
+    std::cout << "Frames: " << Scene->GetFrameCount() << ", scene checksum " << std::hex << Scene->GetChecksum() << std::dec << "\n";
+    for (int i = 0; i < static_cast<int>(StressPhase::COUNT); ++i)
+    {
+        const StressPhase Phase = static_cast<StressPhase>(i);
+        const LatencyHistogram& Times = Scene->GetTimes(Phase);
+        std::cout << "  " << StressScene::GetPhaseName(Phase) << ": p50 " << Times.Percentile(0.5) / 1e6 << " ms, p99 "
+            << Times.Percentile(0.99) / 1e6 << " ms, max " << Times.GetMax() / 1e6 << " ms\n";
+    }
+
+    return 0;
+}
+
+// Removes "Name value" from the arguments, false when it is not there
+bool TakeOption(std::vector<std::string>& Args, const std::string& Name, std::string& Value)
+{
+    const std::vector<std::string>::iterator Option = std::find(Args.begin(), Args.end(), Name);
+    if (Option == Args.end() || Option + 1 == Args.end())
+    {
+        return false;
+    }
+
+    Value = *(Option + 1);
+    Args.erase(Option, Option + 2);
+    return true;
+}
+
+bool TakeFlag(std::vector<std::string>& Args, const std::string& Name)
+{
+    const std::vector<std::string>::iterator Flag = std::find(Args.begin(), Args.end(), Name);
+    if (Flag == Args.end())
+    {
+        return false;
+    }
+
+    Args.erase(Flag);
+    return true;
+}
+
+// Netplay settings after "--netplay local_port remote_address", false on a malformed address
+bool ParseNetplay(std::vector<std::string>& Args, NetplayOptions& Options)
+{
+    std::string Value;
+    Options.bPlayerOne = !TakeFlag(Args, "--player-two");
+    if (TakeOption(Args, "--seed", Value))
+    {
+        Options.Seed = static_cast<uint32_t>(std::stoul(Value));
+    }
+    if (TakeOption(Args, "--rollback", Value))
+    {
+        Options.MaxRollback = std::stoi(Value);
+    }
+    if (TakeOption(Args, "--input-delay", Value))
+    {
+        Options.InputDelay = std::stoi(Value);
+    }
+    if (TakeOption(Args, "--latency", Value))
+    {
+        Options.Latency = std::stoi(Value);
+    }
+    if (TakeOption(Args, "--jitter", Value))
+    {
+        Options.Jitter = std::stoi(Value);
+    }
+    if (TakeOption(Args, "--loss", Value))
+    {
+        Options.Loss = std::stoi(Value);
+    }
+    if (TakeOption(Args, "--speed", Value))
+    {
+        Options.Speed = std::max(std::stod(Value), 0.01);
+    }
+
+    if (Args.size() < 3 || !NetAddress::Parse(Args[2], Options.Remote))
+    {
+        return false;
+    }
+
+    Options.LocalPort = static_cast<uint16_t>(std::stoi(Args[1]));
+    return true;
+}
+
+// Usage: PONG [--time-scale factor] [--record file]
+//        PONG --headless [ticks] [arena_width arena_height] [--seed n] [--record file]
+//        PONG --replay file
+//        PONG --stress [frames] [--balls n] [--bricks n] [--emitters n] [--particles n] [--texts n] [--seed n] [--unbatched]
+//        PONG --netplay local_port remote_ip:port [--windowed] [--player-two] [--seed n] [--rollback ticks]
+//             [--input-delay ticks] [--latency ms] [--jitter ms] [--loss percent] [--speed factor]
+int main(int argc, char** argv)
+{
+    std::vector<std::string> Args(argv + 1, argv + argc);
+
+    std::string RecordPath;
+    TakeOption(Args, "--record", RecordPath);
+
+    if (!Args.empty() && Args[0] == "--netplay")
+    {
+        const bool bWindowed = TakeFlag(Args, "--windowed");
+        NetplayOptions Options;
+        bool bParsed = false;
+        try
+        {
+            bParsed = ParseNetplay(Args, Options);
+        } catch (const std::exception& Error)
+        {
+            std::cout << "Invalid option value: " << Error.what() << "\n";
+        }
+
+        if (!bParsed)
+        {
+            std::cout << "Usage: PONG --netplay local_port remote_ip:port [options]\n";
+            return -1;
+        }
+
+        // Rolled back ticks would be recorded twice
+        if (!RecordPath.empty())
+        {
+            std::cout << "Replays can not be recorded during online matches\n";
+            return -1;
+        }
+
+        // Both sides tick in real time, the peer would stall on a scaled clock
+        return (bWindowed) ? RunWindowed(RecordPath, &Options, 1.0) : RunNetplay(Options);
+    }
+
+    if (!Args.empty() && Args[0] == "--stress")
+    {
+        StressSettings Settings;
+        int Frames = STRESS_DEFAULT_FRAMES;
+        try
+        {
+            std::string Value;
+            if (TakeOption(Args, "--balls", Value))
+            {
+                Settings.Balls = std::stoi(Value);
+            }
+            if (TakeOption(Args, "--bricks", Value))
+            {
+                Settings.Bricks = std::stoi(Value);
+            }
+            if (TakeOption(Args, "--emitters", Value))
+            {
+                Settings.Emitters = std::stoi(Value);
+            }
+            if (TakeOption(Args, "--particles", Value))
+            {
+                Settings.Particles = std::stoi(Value);
+            }
+            if (TakeOption(Args, "--texts", Value))
+            {
+                Settings.Texts = std::stoi(Value);
+            }
+            if (TakeOption(Args, "--seed", Value))
+            {
+                Settings.Seed = static_cast<uint32_t>(std::stoul(Value));
+            }
+            Settings.bBatched = !TakeFlag(Args, "--unbatched");
+
+            if (Args.size() > 1)
+            {
+                Frames = std::stoi(Args[1]);
+            }
+        } catch (const std::exception& Error)
+        {
+            std::cout << "Invalid option value: " << Error.what() << "\n"
+                << "Usage: PONG --stress [frames] [--balls n] [--bricks n] [--emitters n] [--particles n] [--texts n] [--seed n] [--unbatched]\n";
+            return -1;
+        }
+
+        return RunStress(Frames, Settings);
+    }
+
+    if (Args.size() > 1 && Args[0] == "--replay")
+    {
+        return RunReplay(Args[1]);
+    }
+
+    if (!Args.empty() && Args[0] == "--headless")
+    {
+        int Ticks = HEADLESS_DEFAULT_TICKS;
+        glm::ivec2 ArenaSize(WINDOW_WIDTH, WINDOW_HEIGHT);
+        uint32_t Seed = HEADLESS_DEFAULT_SEED;
+        try
+        {
+            std::string Value;
+            if (TakeOption(Args, "--seed", Value))
+            {
+                Seed = static_cast<uint32_t>(std::stoul(Value));
+            }
+            if (Args.size() > 1)
+            {
+                Ticks = std::stoi(Args[1]);
+            }
+            if (Args.size() > 3)
+            {
+                ArenaSize = glm::ivec2(std::stoi(Args[2]), std::stoi(Args[3]));
+                if (ArenaSize.x <= 0 || ArenaSize.y <= 0)
+                {
+                    throw std::out_of_range("arena size must be positive");
+                }
+            }
+        } catch (const std::exception& Error)
+        {
+            std::cout << "Invalid option value: " << Error.what() << "\n"
+                << "Usage: PONG --headless [ticks] [arena_width arena_height] [--seed n] [--record file]\n";
+            return -1;
+        }
+
+        return RunHeadless(Ticks, ArenaSize, Seed, RecordPath);
+    }
+
+    double TimeScale = 1.0;
+    std::string Value;
+    try
+    {
+        if (TakeOption(Args, "--time-scale", Value))
+        {
+            TimeScale = std::stod(Value);
+            if (TimeScale <= 0.0)
+            {
+                throw std::out_of_range("time scale must be positive");
+            }
+        }
+    } catch (const std::exception& Error)
+    {
+        std::cout << "Invalid option value: " << Error.what() << "\n"
+            << "Usage: PONG [--time-scale factor] [--record file]\n";
+        return -1;
+    }
+
+    return RunWindowed(RecordPath, nullptr, TimeScale);
+}
@@ -1,5 +1,16 @@
 #include "AssetManager.h"
 
+namespace
+{
+	constexpr int ATLAS_PAGE_SIZE = 512;
+	constexpr int ATLAS_PADDING = 4;
+}
+
+AssetManager::AssetManager()
+	: SpriteAtlas(ATLAS_PAGE_SIZE, ATLAS_PADDING, GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR)
+{
+}
+
 Shader::SharedPtr AssetManager::LoadShader(const std::string& Name, const std::string& Vertex,
 	const std::string& Fragment)
 {
@@ -25,7 +36,16 @@ Texture::SharedPtr AssetManager::LoadTexture(const std::string& Name, const std:
 		return FoundTexture;
 	}
 
-	Texture::SharedPtr NewTexture = std::make_shared<Texture>(Path, _Format, _WrapS, _WrapT, _MinFilter, _MaxFilter);
+	Texture::SharedPtr NewTexture = nullptr;
+	if (SpriteAtlas.Accepts(_Format, _MinFilter, _MaxFilter))
+	{
+		NewTexture = SpriteAtlas.Add(Path);
+	}
+
+	if (NewTexture == nullptr)
+	{
+		NewTexture = std::make_shared<Texture>(Path, _Format, _WrapS, _WrapT, _MinFilter, _MaxFilter);
+	}
 	Textures.insert(TexturePair(Name, NewTexture));
 
 	return NewTexture;
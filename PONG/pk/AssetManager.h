@@ -6,6 +6,7 @@
 
 #include "Shader.h"
 #include "Texture.h"
+#include "TextureAtlas.h"
 #include "Font.h"
 
 class AssetManager
@@ -26,6 +27,8 @@ public:
 		return Instance;
 	}
 
+	AssetManager();
+
 	Shader::SharedPtr LoadShader(const std::string& Name, const std::string& Vertex, const std::string& Fragment);
 	Texture::SharedPtr LoadTexture(const std::string& Name, const std::string& Path, int _Format, int _WrapS, int _WrapT, int _MinFilter, int _MaxFilter);
 	Font::SharedPtr LoadFont(const std::string& Name, const std::string& Path, const std::string& ShaderName, const glm::mat4& _Projection);
@@ -37,5 +40,7 @@ public:
 private:
 	ShaderMap Shaders;
 	TextureMap Textures;
+	// Sprites loaded with the atlas settings share its pages instead of owning a texture each
+	TextureAtlas SpriteAtlas;
 	FontMap Fonts;
 };
\ No newline at end of file
@@ -0,0 +1,103 @@
+#include "BitStream.h"
+
+#include <cstring>
+
+BitWriter::BitWriter(uint8_t* _Data, const int _Capacity)
+	: Data(_Data), Capacity(_Capacity), BitCount(0), bValid(true)
+{
+	std::memset(Data, 0, static_cast<size_t>(Capacity));
+}
+
+void BitWriter::WriteBits(const uint32_t Value, const int Count)
+{
+	if (!bValid || Count <= 0)
+	{
+		return;
+	}
+
+	if (Count > 32 || BitCount + Count > Capacity * 8)
+	{
+		bValid = false;
+		return;
+	}
+
+	// The buffer starts zeroed, so bits only ever need to be or'ed in
+	const uint64_t Bits = (Count == 32) ? Value : (Value & ((1u << Count) - 1));
+	int Written = 0;
+	while (Written < Count)
+	{
+		const int Byte = (BitCount + Written) / 8;
+		const int Offset = (BitCount + Written) % 8;
+		const int Chunk = (8 - Offset < Count - Written) ? 8 - Offset : Count - Written;
+		Data[Byte] = static_cast<uint8_t>(Data[Byte] | (((Bits >> Written) & ((1u << Chunk) - 1)) << Offset));
+		Written += Chunk;
+	}
+	BitCount += Count;
+}
+
+void BitWriter::WriteBool(const bool bValue)
+{
+	WriteBits(bValue ? 1 : 0, 1);
+}
+
+int BitWriter::GetSize() const
+{
+	return (BitCount + 7) / 8;
+}
+
+int BitWriter::GetBitCount() const
+{
+	return BitCount;
+}
+
+bool BitWriter::IsValid() const
+{
+	return bValid;
+}
+
+BitReader::BitReader(const uint8_t* _Data, const int _Size)
+	: Data(_Data), Size(_Size), BitCount(0), bValid(true)
+{
+}
+
+uint32_t BitReader::ReadBits(const int Count)
+{
+	if (!bValid || Count <= 0)
+	{
+		return 0;
+	}
+
+	if (Count > 32 || BitCount + Count > Size * 8)
+	{
+		bValid = false;
+		return 0;
+	}
+
+	uint64_t Value = 0;
+	int Read = 0;
+	while (Read < Count)
+	{
+		const int Byte = (BitCount + Read) / 8;
+		const int Offset = (BitCount + Read) % 8;
+		const int Chunk = (8 - Offset < Count - Read) ? 8 - Offset : Count - Read;
+		Value |= static_cast<uint64_t>((Data[Byte] >> Offset) & ((1u << Chunk) - 1)) << Read;
+		Read += Chunk;
+	}
+	BitCount += Count;
+	return static_cast<uint32_t>(Value);
+}
+
+bool BitReader::ReadBool()
+{
+	return ReadBits(1) != 0;
+}
+
+int BitReader::GetBitCount() const
+{
+	return BitCount;
+}
+
+bool BitReader::IsValid() const
+{
+	return bValid;
+}
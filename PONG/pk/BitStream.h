@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstdint>
+
+// Bit level serialization into caller owned memory, least significant bit first.
+// Like the byte streams, going past the end marks the stream invalid instead of throwing.
+class BitWriter
+{
+public:
+	BitWriter(uint8_t* _Data, const int _Capacity);
+
+	// Writes the low Count bits of Value, up to 32
+	void WriteBits(const uint32_t Value, const int Count);
+	void WriteBool(const bool bValue);
+
+	// Bytes touched so far, the last one may be partly used
+	int GetSize() const;
+	int GetBitCount() const;
+	bool IsValid() const;
+
+private:
+	uint8_t* Data;
+	int Capacity;
+	int BitCount;
+	bool bValid;
+};
+
+class BitReader
+{
+public:
+	BitReader(const uint8_t* _Data, const int _Size);
+
+	uint32_t ReadBits(const int Count);
+	bool ReadBool();
+
+	int GetBitCount() const;
+	bool IsValid() const;
+
+private:
+	const uint8_t* Data;
+	int Size;
+	int BitCount;
+	bool bValid;
+};
@@ -0,0 +1,150 @@
+#include "ByteStream.h"
+
+#include <cstring>
+
+ByteWriter::ByteWriter(uint8_t* _Data, const int _Capacity)
+	: Data(_Data), Capacity(_Capacity), Size(0), bValid(true)
+{
+}
+
+void ByteWriter::Write8(const uint8_t Value)
+{
+	if (Reserve(1))
+	{
+		Data[Size++] = Value;
+	}
+}
+
+void ByteWriter::Write16(const uint16_t Value)
+{
+	if (Reserve(2))
+	{
+		Data[Size++] = static_cast<uint8_t>(Value);
+		Data[Size++] = static_cast<uint8_t>(Value >> 8);
+	}
+}
+
+void ByteWriter::Write32(const uint32_t Value)
+{
+	if (Reserve(4))
+	{
+		for (int i = 0; i < 4; ++i)
+		{
+			Data[Size++] = static_cast<uint8_t>(Value >> (8 * i));
+		}
+	}
+}
+
+void ByteWriter::Write64(const uint64_t Value)
+{
+	Write32(static_cast<uint32_t>(Value));
+	Write32(static_cast<uint32_t>(Value >> 32));
+}
+
+void ByteWriter::WriteFloat(const float Value)
+{
+	uint32_t Bits = 0;
+	std::memcpy(&Bits, &Value, sizeof(Bits));
+	Write32(Bits);
+}
+
+const uint8_t* ByteWriter::GetData() const
+{
+	return Data;
+}
+
+int ByteWriter::GetSize() const
+{
+	return Size;
+}
+
+bool ByteWriter::IsValid() const
+{
+	return bValid;
+}
+
+bool ByteWriter::Reserve(const int Bytes)
+{
+	bValid = bValid && Size + Bytes <= Capacity;
+	return bValid;
+}
+
+ByteReader::ByteReader(const uint8_t* _Data, const int _Size)
+	: Data(_Data), Size(_Size), Offset(0), bValid(true)
+{
+}
+
+uint8_t ByteReader::Read8()
+{
+	return Consume(1) ? Data[Offset - 1] : 0;
+}
+
+uint16_t ByteReader::Read16()
+{
+	if (!Consume(2))
+	{
+		return 0;
+	}
+
+	return static_cast<uint16_t>(Data[Offset - 2] | (Data[Offset - 1] << 8));
+}
+
+uint32_t ByteReader::Read32()
+{
+	if (!Consume(4))
+	{
+		return 0;
+	}
+
+	uint32_t Value = 0;
+	for (int i = 0; i < 4; ++i)
+	{
+		Value |= static_cast<uint32_t>(Data[Offset - 4 + i]) << (8 * i);
+	}
+	return Value;
+}
+
+uint64_t ByteReader::Read64()
+{
+	const uint64_t Low = Read32();
+	const uint64_t High = Read32();
+	return Low | (High << 32);
+}
+
+float ByteReader::ReadFloat()
+{
+	const uint32_t Bits = Read32();
+	float Value = 0.f;
+	std::memcpy(&Value, &Bits, sizeof(Value));
+	return Value;
+}
+
+const uint8_t* ByteReader::GetCursor() const
+{
+	return Data + Offset;
+}
+
+int ByteReader::GetRemaining() const
+{
+	return Size - Offset;
+}
+
+void ByteReader::Skip(const int Bytes)
+{
+	Consume(Bytes);
+}
+
+bool ByteReader::IsValid() const
+{
+	return bValid;
+}
+
+bool ByteReader::Consume(const int Bytes)
+{
+	bValid = bValid && Offset + Bytes <= Size;
+	if (bValid)
+	{
+		Offset += Bytes;
+	}
+	return bValid;
+}
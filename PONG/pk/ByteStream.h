@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstdint>
+
+// Little endian serialization into caller owned memory, for datagrams and files alike.
+// Going past the end drops the access and marks the stream invalid, check IsValid once when done.
+class ByteWriter
+{
+public:
+	ByteWriter(uint8_t* _Data, const int _Capacity);
+
+	void Write8(const uint8_t Value);
+	void Write16(const uint16_t Value);
+	void Write32(const uint32_t Value);
+	void Write64(const uint64_t Value);
+	void WriteFloat(const float Value);
+
+	const uint8_t* GetData() const;
+	int GetSize() const;
+	bool IsValid() const;
+
+private:
+	bool Reserve(const int Bytes);
+
+	uint8_t* Data;
+	int Capacity;
+	int Size;
+	bool bValid;
+};
+
+class ByteReader
+{
+public:
+	ByteReader(const uint8_t* _Data, const int _Size);
+
+	uint8_t Read8();
+	uint16_t Read16();
+	uint32_t Read32();
+	uint64_t Read64();
+	float ReadFloat();
+
+	// Raw access to what is left, for payloads read in bulk
+	const uint8_t* GetCursor() const;
+	int GetRemaining() const;
+	void Skip(const int Bytes);
+	bool IsValid() const;
+
+private:
+	bool Consume(const int Bytes);
+
+	const uint8_t* Data;
+	int Size;
+	int Offset;
+	bool bValid;
+};
@@ -0,0 +1,89 @@
+#include "Clock.h"
+
+#include <algorithm>
+#include <chrono>
+
+Clock::Clock()
+	: StartTime(0), LastFrameTime(0), FrameDelta(0), GameTime(0), TimeScale(1.0), FrameCount(0), TickCount(0)
+{
+	Start();
+}
+
+Clock::Nanoseconds Clock::Now()
+{
+	const std::chrono::steady_clock::duration SinceEpoch = std::chrono::steady_clock::now().time_since_epoch();
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(SinceEpoch).count();
+}
+
+float Clock::ToSeconds(const Nanoseconds Time)
+{
+	return static_cast<float>(static_cast<double>(Time) / NanosecondsPerSecond);
+}
+
+Clock::Nanoseconds Clock::FromSeconds(const double Seconds)
+{
+	return static_cast<Nanoseconds>(Seconds * NanosecondsPerSecond);
+}
+
+void Clock::Start()
+{
+	StartTime = Now();
+	LastFrameTime = StartTime;
+	FrameDelta = 0;
+	GameTime = 0;
+	FrameCount = 0;
+	TickCount = 0;
+}
+
+Clock::Nanoseconds Clock::NewFrame()
+{
+	const Nanoseconds CurrentTime = Now();
+	const Nanoseconds RealDelta = CurrentTime - LastFrameTime;
+	LastFrameTime = CurrentTime;
+
+	FrameDelta = static_cast<Nanoseconds>(RealDelta * TimeScale);
+	GameTime += FrameDelta;
+	FrameCount++;
+
+	return FrameDelta;
+}
+
+void Clock::CountTick()
+{
+	TickCount++;
+}
+
+void Clock::SetTimeScale(const double NewScale)
+{
+	TimeScale = std::max(NewScale, 0.0);
+}
+
+double Clock::GetTimeScale() const
+{
+	return TimeScale;
+}
+
+Clock::Nanoseconds Clock::GetFrameDelta() const
+{
+	return FrameDelta;
+}
+
+Clock::Nanoseconds Clock::GetRealElapsed() const
+{
+	return Now() - StartTime;
+}
+
+Clock::Nanoseconds Clock::GetGameTime() const
+{
+	return GameTime;
+}
+
+uint64_t Clock::GetFrameCount() const
+{
+	return FrameCount;
+}
+
+uint64_t Clock::GetTickCount() const
+{
+	return TickCount;
+}
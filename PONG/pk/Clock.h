@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstdint>
+
+// Monotonic game clock with integer nanosecond precision.
+// Frame deltas are scaled by TimeScale, elapsed real time is not.
+class Clock
+{
+public:
+	typedef int64_t Nanoseconds;
+
+	static constexpr Nanoseconds NanosecondsPerSecond = 1000000000;
+
+	Clock();
+
+	static Nanoseconds Now();
+	static float ToSeconds(const Nanoseconds Time);
+	static Nanoseconds FromSeconds(const double Seconds);
+
+	void Start();
+	Nanoseconds NewFrame();
+	void CountTick();
+
+	void SetTimeScale(const double NewScale);
+	double GetTimeScale() const;
+
+	Nanoseconds GetFrameDelta() const;
+	Nanoseconds GetRealElapsed() const;
+	Nanoseconds GetGameTime() const;
+
+	uint64_t GetFrameCount() const;
+	uint64_t GetTickCount() const;
+
+private:
+	Nanoseconds StartTime;
+	Nanoseconds LastFrameTime;
+	Nanoseconds FrameDelta;
+	Nanoseconds GameTime;
+
+	double TimeScale;
+
+	uint64_t FrameCount;
+	uint64_t TickCount;
+};
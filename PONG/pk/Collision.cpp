@@ -0,0 +1,96 @@
+#include "Collision.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace
+{
+	// Entry and exit time of a moving interval against a static one along one axis
+	void SweepAxis(const float Distance, const float Extent, const float Displacement, float& Entry, float& Exit)
+	{
+		if (Displacement == 0.f)
+		{
+			const bool bOverlapping = std::abs(Distance) < Extent;
+			Entry = bOverlapping ? -std::numeric_limits<float>::infinity() : std::numeric_limits<float>::infinity();
+			Exit = std::numeric_limits<float>::infinity();
+			return;
+		}
+
+		const float Near = (Distance - Extent * std::copysign(1.f, Displacement)) / Displacement;
+		const float Far = (Distance + Extent * std::copysign(1.f, Displacement)) / Displacement;
+		Entry = Near;
+		Exit = Far;
+	}
+}
+
+Collision::SweepHit Collision::SweepBox(const glm::vec2& Center, const glm::vec2& HalfSize, const glm::vec2& Displacement,
+	const glm::vec2& OtherCenter, const glm::vec2& OtherHalfSize)
+{
+	SweepHit Hit;
+
+	// Minkowski sum: sweep the center point against the other box grown by our half size
+	const glm::vec2 Distance = OtherCenter - Center;
+	const glm::vec2 Extent = OtherHalfSize + HalfSize;
+
+	float EntryX, ExitX, EntryY, ExitY;
+	SweepAxis(Distance.x, Extent.x, Displacement.x, EntryX, ExitX);
+	SweepAxis(Distance.y, Extent.y, Displacement.y, EntryY, ExitY);
+
+	const float Entry = std::max(EntryX, EntryY);
+	const float Exit = std::min(ExitX, ExitY);
+	if (Entry > Exit || Entry > 1.f || Exit < 0.f)
+	{
+		return Hit;
+	}
+
+	const bool bAlongX = EntryX > EntryY;
+	if (Entry < 0.f)
+	{
+		// Started inside, push out along the axis with the least penetration
+		const float PenetrationX = Extent.x - std::abs(Distance.x);
+		const float PenetrationY = Extent.y - std::abs(Distance.y);
+		const bool bPushX = PenetrationX < PenetrationY;
+
+		Hit.Normal = bPushX ? glm::vec2(-std::copysign(1.f, Distance.x), 0.f) : glm::vec2(0.f, -std::copysign(1.f, Distance.y));
+		if (glm::dot(Displacement, Hit.Normal) >= 0.f)
+		{
+			return SweepHit();
+		}
+
+		Hit.bHit = true;
+		Hit.Time = 0.f;
+		return Hit;
+	}
+
+	Hit.bHit = true;
+	Hit.Time = Entry;
+	Hit.Normal = bAlongX ? glm::vec2(-std::copysign(1.f, Displacement.x), 0.f) : glm::vec2(0.f, -std::copysign(1.f, Displacement.y));
+	return Hit;
+}
+
+Collision::SweepHit Collision::SweepHorizontalLine(const glm::vec2& Center, const glm::vec2& HalfSize, const glm::vec2& Displacement,
+	const float LineY, const float NormalY)
+{
+	SweepHit Hit;
+
+	// Only a box moving against the normal can hit the line
+	if (Displacement.y * NormalY >= 0.f)
+	{
+		return Hit;
+	}
+
+	// Signed gap between the box edge facing the line and the line itself
+	const float Edge = Center.y - HalfSize.y * NormalY;
+	const float Gap = (Edge - LineY) * NormalY;
+	const float Time = (Gap <= 0.f) ? 0.f : Gap / std::abs(Displacement.y);
+	if (Time > 1.f)
+	{
+		return Hit;
+	}
+
+	Hit.bHit = true;
+	Hit.Time = Time;
+	Hit.Normal = glm::vec2(0.f, NormalY);
+	return Hit;
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+// Continuous collision between axis aligned boxes, given as center and half size
+namespace Collision
+{
+	struct SweepHit
+	{
+		bool bHit = false;
+		// Fraction of the displacement travelled before contact, in [0, 1]
+		float Time = 1.f;
+		// Surface normal of the box that was hit, pointing towards the moving box
+		glm::vec2 Normal = glm::vec2(0.f);
+	};
+
+	// Moving box against a static one. Boxes already overlapping hit at time 0,
+	// unless the moving box is leaving the other one.
+	SweepHit SweepBox(const glm::vec2& Center, const glm::vec2& HalfSize, const glm::vec2& Displacement,
+		const glm::vec2& OtherCenter, const glm::vec2& OtherHalfSize);
+
+	// Moving box against the horizontal line y = LineY, Normal.y tells which side is free space
+	SweepHit SweepHorizontalLine(const glm::vec2& Center, const glm::vec2& HalfSize, const glm::vec2& Displacement,
+		const float LineY, const float NormalY);
+}
@@ -3,12 +3,12 @@
 #include "Shader.h"
 #include "Texture.h"
 
-#include <ctime>
-#include <cstdlib>
+#include <cstddef>
 #include <iostream>
 
 #include <glm/gtc/matrix_transform.hpp>
 
+#include "Clock.h"
 #include "Common.h"
 
 void Particle::Set(const glm::vec3& _Position, const glm::vec3& _Direction, const glm::vec4& _Color, const float _Life, const float _Speed)
@@ -45,7 +45,7 @@ int ParticlePattern::Base::GetSpawnAmount() const
 	return SpawnAmount;
 }
 
-void ParticlePattern::Base::Spawn(std::vector<Particle*>& Pool, int& LastInactive, const glm::vec3& Position, const glm::vec3& Direction)
+void ParticlePattern::Base::Spawn(std::vector<Particle*>& Pool, int& LastInactive, Random& Rng, const glm::vec3& Position, const glm::vec3& Direction)
 {
 }
 
@@ -70,7 +70,7 @@ int ParticlePattern::Base::NextInactive(std::vector<Particle*>& Pool, const int
 	return 0;
 }
 
-void ParticlePattern::Base::SpawnParticle(Particle* NewParticle, const glm::vec3& Position, const glm::vec3& Direction) const
+void ParticlePattern::Base::SpawnParticle(Particle* NewParticle, Random& Rng, const glm::vec3& Position, const glm::vec3& Direction) const
 {
 	if (!NewParticle)
 	{
@@ -78,7 +78,7 @@ void ParticlePattern::Base::SpawnParticle(Particle* NewParticle, const glm::vec3
 	}
 
 	float RandomOffsetFactor = 0.f; //((rand() % 100) - 50) / 10.0f;
-	float RandomColor = 0.5f + ((rand() % 100) / 100.0f);
+	float RandomColor = 0.5f + (Rng.Range(100) / 100.0f);
 
 	const glm::vec3 CalcPosition(Position.x + RandomOffsetFactor, Position.y + RandomOffsetFactor, 0.f);
 	const glm::vec4 Color(RandomColor, RandomColor, RandomColor, 1.0f);
@@ -91,13 +91,13 @@ ParticlePattern::Linear::Linear(const float _Speed, const float _Life, int _Spaw
 {
 }
 
-void ParticlePattern::Linear::Spawn(std::vector<Particle*>& Pool, int& LastInactive, const glm::vec3& Position,
+void ParticlePattern::Linear::Spawn(std::vector<Particle*>& Pool, int& LastInactive, Random& Rng, const glm::vec3& Position,
 	const glm::vec3& Direction)
 {
 	for (int i = 0; i < GetSpawnAmount(); ++i)
 	{
 		LastInactive = NextInactive(Pool, LastInactive);
-		SpawnParticle(Pool[LastInactive], Position, Direction);
+		SpawnParticle(Pool[LastInactive], Rng, Position, Direction);
 	}
 }
 
@@ -107,7 +107,7 @@ ParticlePattern::Bounce::Bounce(const float _Speed, const float _Life, int _Spaw
 
 }
 
-void ParticlePattern::Bounce::Spawn(std::vector<Particle*>& Pool, int& LastInactive, const glm::vec3& Position,
+void ParticlePattern::Bounce::Spawn(std::vector<Particle*>& Pool, int& LastInactive, Random& Rng, const glm::vec3& Position,
 	const glm::vec3& Direction)
 {
 	const std::vector<glm::vec3> Compass = {
@@ -143,7 +143,7 @@ void ParticlePattern::Bounce::Spawn(std::vector<Particle*>& Pool, int& LastInact
 	for (int i = 0; i < GetSpawnAmount(); ++i)
 	{
 		LastInactive = NextInactive(Pool, LastInactive);
-		SpawnParticle(Pool[LastInactive], Position, DirectionsToSpawn[i % DirectionsCount]);
+		SpawnParticle(Pool[LastInactive], Rng, Position, DirectionsToSpawn[i % DirectionsCount]);
 	}
 }
 
@@ -151,20 +151,21 @@ Emitter::Emitter(const Shader::SharedPtr& _ParticleShader, const Texture::Shared
 	int _PoolCapacity, const ParticlePattern::Base::SharedPtr& _ParticlePattern,
 	const glm::mat4& _Projection
 )
-	: QuadId(0), ParticleScale(5.0f),
-		RenderProjection(_Projection), LastInactive(0), PoolCapacity(_PoolCapacity),
+	: QuadId(0), QuadBuffer(0), InstanceBuffer(0), bInstanced(true), ParticleScale(5.0f),
+		RenderProjection(_Projection), LastInactive(0), PoolCapacity(_PoolCapacity), Rng(static_cast<uint32_t>(Clock::Now())),
 		ParticleShader(_ParticleShader), ParticleTexture(_ParticleTexture), ParticlePattern(_ParticlePattern)
 {
+	// Without a shader the emitter only simulates particles, no GL resources are created
 	if (ParticleShader != nullptr)
 	{
 		ParticleShader->Use();
 		ParticleShader->SetMatrix("projection", RenderProjection);
+
+		PrepareRenderQuad();
+		Instances.reserve(PoolCapacity);
 	}
 
-	PrepareRenderQuad();
 	InitializePool();
-
-	srand(time(nullptr));
 }
 
 void Emitter::Spawn(const glm::vec3& Position, const glm::vec3& Direction)
@@ -174,7 +175,7 @@ void Emitter::Spawn(const glm::vec3& Position, const glm::vec3& Direction)
 		return;
 	}
 
-	ParticlePattern->Spawn(Pool, LastInactive, Position, Direction);
+	ParticlePattern->Spawn(Pool, LastInactive, Rng, Position, Direction);
 }
 
 void Emitter::Update(const float Delta, const glm::vec3& Position, const glm::vec3& Direction)
@@ -186,7 +187,7 @@ void Emitter::Update(const float Delta, const glm::vec3& Position, const glm::ve
 
 	if (ParticlePattern->ShouldLoop())
 	{
-		ParticlePattern->Spawn(Pool, LastInactive, Position, Direction);
+		ParticlePattern->Spawn(Pool, LastInactive, Rng, Position, Direction);
 	}
 
 	const float ColorDecayFactor = 2.f / ParticlePattern->GetLife();
@@ -206,9 +207,12 @@ void Emitter::Update(const float Delta, const glm::vec3& Position, const glm::ve
 
 void Emitter::Render() const
 {
-	ParticleShader->Use();
+	if (ParticleShader == nullptr)
+	{
+		return;
+	}
 
-	ParticleShader->SetFloat("scale", ParticleScale);
+	Instances.clear();
 	for (const Particle* CurrentParticle : Pool)
 	{
 		if (CurrentParticle->Life <= 0.f)
@@ -216,18 +220,44 @@ void Emitter::Render() const
 			continue;
 		}
 
-		ParticleShader->SetFloat("position", CurrentParticle->Position);
-		ParticleShader->SetFloat("color", CurrentParticle->Color);
+		Instances.push_back(ParticleInstance{ CurrentParticle->Position, ParticleScale, CurrentParticle->Color });
+	}
 
-		glBindVertexArray(QuadId);
+	if (Instances.empty())
+	{
+		return;
+	}
 
-		glActiveTexture(GL_TEXTURE0);
-		ParticleTexture->Bind();
+	ParticleShader->Use();
+	ParticleShader->SetFloat("uvRect", ParticleTexture->GetUVs());
+	glBindVertexArray(QuadId);
+	glActiveTexture(GL_TEXTURE0);
+	ParticleTexture->Bind();
 
-		glDrawArrays(GL_TRIANGLES, 0, 6);
-		glBindVertexArray(0);
+	if (bInstanced)
+	{
+		// Orphaned every frame, the driver can keep drawing the previous frame from the old storage
+		glBindBuffer(GL_ARRAY_BUFFER, InstanceBuffer);
+		glBufferData(GL_ARRAY_BUFFER, PoolCapacity * sizeof(ParticleInstance), nullptr, GL_STREAM_DRAW);
+		glBufferSubData(GL_ARRAY_BUFFER, 0, Instances.size() * sizeof(ParticleInstance), Instances.data());
+		glDrawArraysInstanced(GL_TRIANGLES, 0, 6, static_cast<GLsizei>(Instances.size()));
+	}
+	else
+	{
+		// Without their arrays the instance attributes read the current constant value, set per draw
+		glDisableVertexAttribArray(1);
+		glDisableVertexAttribArray(2);
+		for (const ParticleInstance& Instance : Instances)
+		{
+			glVertexAttrib4f(1, Instance.Position.x, Instance.Position.y, Instance.Position.z, Instance.Scale);
+			glVertexAttrib4f(2, Instance.Color.r, Instance.Color.g, Instance.Color.b, Instance.Color.a);
+			glDrawArrays(GL_TRIANGLES, 0, 6);
+		}
+		glEnableVertexAttribArray(1);
+		glEnableVertexAttribArray(2);
 	}
 
+	glBindVertexArray(0);
 	ParticleTexture->UnBind();
 }
 
@@ -241,6 +271,51 @@ void Emitter::Reset()
 	LastInactive = 0;
 }
 
+int Emitter::GetPoolCapacity() const
+{
+	return PoolCapacity;
+}
+
+int Emitter::CountLive() const
+{
+	int Live = 0;
+	for (const Particle* CurrentParticle : Pool)
+	{
+		Live += (CurrentParticle->Life > 0.f) ? 1 : 0;
+	}
+	return Live;
+}
+
+void Emitter::SaveState(Particle* Particles, int& _LastInactive) const
+{
+	for (int i = 0; i < PoolCapacity; ++i)
+	{
+		Particles[i] = *Pool[i];
+	}
+
+	_LastInactive = LastInactive;
+}
+
+void Emitter::RestoreState(const Particle* Particles, const int _LastInactive)
+{
+	for (int i = 0; i < PoolCapacity; ++i)
+	{
+		*Pool[i] = Particles[i];
+	}
+
+	LastInactive = _LastInactive;
+}
+
+void Emitter::SetInstanced(const bool _bInstanced)
+{
+	bInstanced = _bInstanced;
+}
+
+bool Emitter::IsInstanced() const
+{
+	return bInstanced;
+}
+
 void Emitter::SetParticleScale(const float NewScale)
 {
 	ParticleScale = NewScale;
@@ -251,6 +326,21 @@ float Emitter::GetParticleScale() const
 	return ParticleScale;
 }
 
+void Emitter::SetSeed(const uint32_t Seed)
+{
+	Rng.Seed(Seed);
+}
+
+uint32_t Emitter::GetRandomState() const
+{
+	return Rng.GetState();
+}
+
+void Emitter::SetRandomState(const uint32_t State)
+{
+	Rng.SetState(State);
+}
+
 Emitter::~Emitter()
 {
 	for (int i = 0; i < PoolCapacity; ++i)
@@ -259,6 +349,13 @@ Emitter::~Emitter()
 	}
 
 	Pool.clear();
+
+	if (QuadId != 0)
+	{
+		glDeleteBuffers(1, &InstanceBuffer);
+		glDeleteBuffers(1, &QuadBuffer);
+		glDeleteVertexArrays(1, &QuadId);
+	}
 }
 
 void Emitter::PrepareRenderQuad()
@@ -272,19 +369,29 @@ void Emitter::PrepareRenderQuad()
 		0.5f, -0.5f, 1.f, 0.f
 	};
 
-	unsigned int VAO = 0;
-	glGenVertexArrays(1, &VAO);
-	glBindVertexArray(VAO);
+	glGenVertexArrays(1, &QuadId);
+	glBindVertexArray(QuadId);
 
-	unsigned int VBO;
-	glGenBuffers(1, &VBO);
-	glBindBuffer(GL_ARRAY_BUFFER, VBO);
+	glGenBuffers(1, &QuadBuffer);
+	glBindBuffer(GL_ARRAY_BUFFER, QuadBuffer);
 	glBufferData(GL_ARRAY_BUFFER, sizeof(VertexData), VertexData, GL_STATIC_DRAW);
 
 	glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
 	glEnableVertexAttribArray(0);
 
-	QuadId = VAO;
+	// Never more instances than particles in the pool
+	glGenBuffers(1, &InstanceBuffer);
+	glBindBuffer(GL_ARRAY_BUFFER, InstanceBuffer);
+	glBufferData(GL_ARRAY_BUFFER, PoolCapacity * sizeof(ParticleInstance), nullptr, GL_STREAM_DRAW);
+
+	glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(ParticleInstance), (void*)offsetof(ParticleInstance, Position));
+	glEnableVertexAttribArray(1);
+	glVertexAttribDivisor(1, 1);
+	glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, sizeof(ParticleInstance), (void*)offsetof(ParticleInstance, Color));
+	glEnableVertexAttribArray(2);
+	glVertexAttribDivisor(2, 1);
+
+	glBindVertexArray(0);
 }
 
 void Emitter::InitializePool()
@@ -8,6 +8,7 @@
 
 #include "Shader.h"
 #include "Texture.h"
+#include "Random.h"
 
 struct Particle
 {
@@ -20,6 +21,14 @@ struct Particle
 	void Set(const glm::vec3& _Position, const glm::vec3& _Direction, const glm::vec4& _Color, const float _Life, const float Speed);
 };
 
+// Per particle attributes of an instanced draw
+struct ParticleInstance
+{
+	glm::vec3 Position;
+	float Scale;
+	glm::vec4 Color;
+};
+
 namespace ParticlePattern
 {
 	class Base
@@ -34,13 +43,13 @@ namespace ParticlePattern
 		float GetLife() const;
 		int GetSpawnAmount() const;
 
-		virtual void Spawn(std::vector<Particle*>& Pool, int& LastInactive, const glm::vec3& Position, const glm::vec3& Direction);
+		virtual void Spawn(std::vector<Particle*>& Pool, int& LastInactive, Random& Rng, const glm::vec3& Position, const glm::vec3& Direction);
 
 		virtual ~Base() = default;
 
 	protected:
 		static int NextInactive(std::vector<Particle*>& Pool, const int LastInactive);
-		void SpawnParticle(Particle* NewParticle, const glm::vec3& Position, const glm::vec3& Direction) const;
+		void SpawnParticle(Particle* NewParticle, Random& Rng, const glm::vec3& Position, const glm::vec3& Direction) const;
 
 	private:
 		bool bLoop;
@@ -53,7 +62,7 @@ namespace ParticlePattern
 	{
 	public:
 		Linear(const float _Speed, const float _Life, int _SpawnAmount);
-		virtual void Spawn(std::vector<Particle*>& Pool, int& LastInactive, const glm::vec3& Position, const glm::vec3& Direction) override;
+		virtual void Spawn(std::vector<Particle*>& Pool, int& LastInactive, Random& Rng, const glm::vec3& Position, const glm::vec3& Direction) override;
 
 		virtual ~Linear() override = default;
 	};
@@ -62,7 +71,7 @@ namespace ParticlePattern
 	{
 	public:
 		Bounce(const float _Speed, const float _Life, int _SpawnAmount);
-		virtual void Spawn(std::vector<Particle*>& Pool, int& LastInactive, const glm::vec3& Position, const glm::vec3& Direction) override;
+		virtual void Spawn(std::vector<Particle*>& Pool, int& LastInactive, Random& Rng, const glm::vec3& Position, const glm::vec3& Direction) override;
 
 		virtual ~Bounce() override = default;
 	};
@@ -85,9 +94,24 @@ public:
 	void Render() const;
 	void Reset();
 
+	// One instanced draw for the whole pool, or one draw per live particle to measure against
+	void SetInstanced(const bool _bInstanced);
+	bool IsInstanced() const;
+
 	void SetParticleScale(const float NewScale);
 	float GetParticleScale() const;
 
+	void SetSeed(const uint32_t Seed);
+	uint32_t GetRandomState() const;
+	void SetRandomState(const uint32_t State);
+
+	int CountLive() const;
+
+	// Whole pool by value, Particles must hold GetPoolCapacity entries
+	int GetPoolCapacity() const;
+	void SaveState(Particle* Particles, int& _LastInactive) const;
+	void RestoreState(const Particle* Particles, const int _LastInactive);
+
 	~Emitter();
 
 private:
@@ -96,6 +120,11 @@ private:
 	void InitializePool();
 
 	unsigned int QuadId;
+	unsigned int QuadBuffer;
+	unsigned int InstanceBuffer;
+	bool bInstanced;
+	// Rebuilt by every Render, sized to the pool once
+	mutable std::vector<ParticleInstance> Instances;
 	float ParticleScale;
 	glm::mat4 RenderProjection;
 
@@ -103,6 +132,8 @@ private:
 	int LastInactive;
 	int PoolCapacity;
 
+	Random Rng;
+
 	Shader::SharedPtr ParticleShader;
 	Texture::SharedPtr ParticleTexture;
 
@@ -1,10 +1,22 @@
 #include "Font.h"
 #include "Shader.h"
 
+#include "TextureAtlas.h"
+
 #include <glad/glad.h>
 
+#include <algorithm>
+
+namespace
+{
+    constexpr size_t INITIAL_VERTICES = 6 * 64;
+    constexpr int ATLAS_START_SIZE = 256;
+    // Empty pixels after each glyph, filtering never reaches the next one
+    constexpr int GLYPH_PADDING = 1;
+}
+
 Font::Font(const std::string& _Path, const std::string& _Name, const glm::mat4& _Projection, const Shader::SharedPtr& _TextShader)
-	: Path(_Path), Name(_Name), Size(14), Projection(_Projection), TextShader(_TextShader)
+	: Path(_Path), Name(_Name), Size(14), Characters{}, Projection(_Projection), TextShader(_TextShader), BufferCapacity(INITIAL_VERTICES)
 {
     if (TextShader == nullptr)
     {
@@ -14,6 +26,7 @@ Font::Font(const std::string& _Path, const std::string& _Name, const glm::mat4&
     TextShader->Use();
     TextShader->SetMatrix("projection", Projection);
 
+    Vertices.reserve(INITIAL_VERTICES);
     PrepareRenderQuad();
 }
 
@@ -34,7 +47,7 @@ unsigned int Font::GetSize() const
 
 void Font::Load(unsigned int _Size)
 {
-    Characters.clear();
+    Characters.fill(Character{});
 
     FT_Library FontLibrary;
     if (FT_Init_FreeType(&FontLibrary))
@@ -65,58 +78,96 @@ void Font::Render(const std::string& Text, const glm::vec2& Position, float Scal
         return;
     }
 
+    Vertices.clear();
+    BuildQuads(Text, Position, Scale, Vertices);
+    if (Vertices.empty())
+    {
+        return;
+    }
+
+    // Orphaned on every string, the driver can keep drawing the previous one from the old storage
+    glBindBuffer(GL_ARRAY_BUFFER, BufferId);
+    if (Vertices.size() > BufferCapacity)
+    {
+        BufferCapacity = std::max(Vertices.size(), BufferCapacity * 2);
+    }
+    glBufferData(GL_ARRAY_BUFFER, BufferCapacity * sizeof(glm::vec4), nullptr, GL_DYNAMIC_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, Vertices.size() * sizeof(glm::vec4), Vertices.data());
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    Draw(QuadId, static_cast<int>(Vertices.size()), Color);
+}
+
+void Font::Draw(unsigned int VertexArray, int VertexCount, const float Color[]) const
+{
+    if (!bLoaded || VertexCount <= 0)
+    {
+        return;
+    }
+
     TextShader->Use();
     TextShader->SetColor("textColor", Color);
 
     glActiveTexture(GL_TEXTURE0);
-    glBindVertexArray(QuadId);
+    GlyphAtlas->Bind();
+    glBindVertexArray(VertexArray);
+
+    glDrawArrays(GL_TRIANGLES, 0, VertexCount);
+
+    glBindVertexArray(0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
 
-    // iterate through all characters
+void Font::BuildQuads(const std::string& Text, const glm::vec2& Position, float Scale, std::vector<glm::vec4>& QuadVertices) const
+{
     float x = Position.x;
     float y = Position.y;
 
-    Character MaxChar = Characters['H'];
+    const Character& MaxChar = Characters['H'];
 
     for (const char c : Text)
     {
-        Character Glyph = Characters[c];
-
-        float xpos = x + Glyph.Bearing.x * Scale;
-        float ypos = y + (MaxChar.Bearing.y - Glyph.Bearing.y) * Scale;
-
-        float w = Glyph.Size.x * Scale;
-        float h = Glyph.Size.y * Scale;
-        // update VBO for each character
-        float vertices[6][4] = {
-            { xpos,     ypos + h,   0.0f, 1.0f },
-            { xpos + w, ypos,       1.0f, 0.0f },
-            { xpos,     ypos,       0.0f, 0.0f },
-
-            { xpos,     ypos + h,   0.0f, 1.0f },
-            { xpos + w, ypos + h,   1.0f, 1.0f },
-            { xpos + w, ypos,       1.0f, 0.0f }
-        };
-        // render glyph texture over quad
-        glBindTexture(GL_TEXTURE_2D, Glyph.TextureID);
-        // update content of VBO memory
-        glBindBuffer(GL_ARRAY_BUFFER, BufferId);
-        glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(vertices), vertices);
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
-        // render quad
-        glDrawArrays(GL_TRIANGLES, 0, 6);
+        const unsigned char Code = static_cast<unsigned char>(c);
+        if (Code >= CHARACTER_COUNT)
+        {
+            continue;
+        }
+
+        const Character& Glyph = Characters[Code];
+
+        // Whitespace only advances
+        if (Glyph.Size.x > 0 && Glyph.Size.y > 0)
+        {
+            const float xpos = x + Glyph.Bearing.x * Scale;
+            const float ypos = y + (MaxChar.Bearing.y - Glyph.Bearing.y) * Scale;
+
+            const float w = Glyph.Size.x * Scale;
+            const float h = Glyph.Size.y * Scale;
+
+            const float Left = Glyph.UVs.x;
+            const float Top = Glyph.UVs.y;
+            const float Right = Glyph.UVs.z;
+            const float Bottom = Glyph.UVs.w;
+
+            QuadVertices.push_back(glm::vec4(xpos, ypos + h, Left, Bottom));
+            QuadVertices.push_back(glm::vec4(xpos + w, ypos, Right, Top));
+            QuadVertices.push_back(glm::vec4(xpos, ypos, Left, Top));
+
+            QuadVertices.push_back(glm::vec4(xpos, ypos + h, Left, Bottom));
+            QuadVertices.push_back(glm::vec4(xpos + w, ypos + h, Right, Bottom));
+            QuadVertices.push_back(glm::vec4(xpos + w, ypos, Right, Top));
+        }
 
         x += (Glyph.Advance >> 6) * Scale;
     }
-
-    glBindVertexArray(0);
-    glBindTexture(GL_TEXTURE_2D, 0);
 }
 
 void Font::LoadCharacters(FT_Face& Face)
 {
-    glPixelStorei(GL_UNPACK_ALIGNMENT, 1); // disable byte-alignment restriction
+    // Bitmaps are kept until every glyph size is known, then packed into one texture
+    std::array<std::vector<unsigned char>, CHARACTER_COUNT> Bitmaps;
 
-    for (unsigned char c = 0; c < 128; c++)
+    for (unsigned char c = 0; c < CHARACTER_COUNT; c++)
     {
         // load character glyph 
         if (FT_Load_Char(Face, c, FT_LOAD_RENDER))
@@ -124,36 +175,62 @@ void Font::LoadCharacters(FT_Face& Face)
             continue;
         }
 
-        // generate texture
-        unsigned int texture;
-        glGenTextures(1, &texture);
-        glBindTexture(GL_TEXTURE_2D, texture);
-        glTexImage2D(
-            GL_TEXTURE_2D,
-            0,
-            GL_RED,
-            Face->glyph->bitmap.width,
-            Face->glyph->bitmap.rows,
-            0,
-            GL_RED,
-            GL_UNSIGNED_BYTE,
-            Face->glyph->bitmap.buffer
-        );
-        // set texture options
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-        // now store character for later use
-        Character character = {
-            texture,
-            glm::ivec2(Face->glyph->bitmap.width, Face->glyph->bitmap.rows),
+        const FT_Bitmap& Bitmap = Face->glyph->bitmap;
+        for (unsigned int Row = 0; Row < Bitmap.rows; Row++)
+        {
+            const unsigned char* Source = Bitmap.buffer + Row * Bitmap.pitch;
+            Bitmaps[c].insert(Bitmaps[c].end(), Source, Source + Bitmap.width);
+        }
+
+        Characters[c] = Character{
+            glm::vec4(0.f),
+            glm::ivec2(Bitmap.width, Bitmap.rows),
             glm::ivec2(Face->glyph->bitmap_left, Face->glyph->bitmap_top),
-            Face->glyph->advance.x
+            static_cast<unsigned int>(Face->glyph->advance.x)
         };
+    }
+
+    // Smallest square power of two page holding every glyph
+    int AtlasSize = ATLAS_START_SIZE;
+    std::array<glm::ivec2, CHARACTER_COUNT> Positions;
+    for (bool bPacked = false; !bPacked;)
+    {
+        SkylinePacker Packer(AtlasSize, AtlasSize);
+        bPacked = true;
+        for (size_t c = 0; c < CHARACTER_COUNT && bPacked; c++)
+        {
+            const glm::ivec2& GlyphSize = Characters[c].Size;
+            Positions[c] = glm::ivec2(0);
+            if (GlyphSize.x > 0 && GlyphSize.y > 0)
+            {
+                bPacked = Packer.Insert(GlyphSize.x + GLYPH_PADDING, GlyphSize.y + GLYPH_PADDING, Positions[c]);
+            }
+        }
+
+        if (!bPacked)
+        {
+            AtlasSize *= 2;
+        }
+    }
 
-        Characters.insert(std::pair<char, Character>(c, character));
+    std::vector<unsigned char> Pixels(static_cast<size_t>(AtlasSize) * AtlasSize, 0);
+    const float AtlasScale = 1.f / AtlasSize;
+    for (size_t c = 0; c < CHARACTER_COUNT; c++)
+    {
+        Character& Glyph = Characters[c];
+        const glm::ivec2& Offset = Positions[c];
+        for (int Row = 0; Row < Glyph.Size.y; Row++)
+        {
+            std::copy_n(Bitmaps[c].data() + static_cast<size_t>(Row) * Glyph.Size.x, Glyph.Size.x,
+                Pixels.data() + static_cast<size_t>(Offset.y + Row) * AtlasSize + Offset.x);
+        }
+
+        Glyph.UVs = glm::vec4(Offset.x, Offset.y, Offset.x + Glyph.Size.x, Offset.y + Glyph.Size.y) * AtlasScale;
     }
+
+    GlyphAtlas = std::make_shared<Texture>(AtlasSize, AtlasSize, GL_RED, GL_CLAMP_TO_EDGE, GL_CLAMP_TO_EDGE, GL_LINEAR, GL_LINEAR);
+    GlyphAtlas->Upload(glm::ivec2(0), AtlasSize, AtlasSize, Pixels.data());
+    GlyphAtlas->UnBind();
 }
 
 void Font::PrepareRenderQuad()
@@ -163,7 +240,7 @@ void Font::PrepareRenderQuad()
     glGenBuffers(1, &VBO);
     glBindVertexArray(VAO);
     glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(float) * 6 * 4, nullptr, GL_DYNAMIC_DRAW);
+    glBufferData(GL_ARRAY_BUFFER, BufferCapacity * sizeof(glm::vec4), nullptr, GL_DYNAMIC_DRAW);
     glEnableVertexAttribArray(0);
     glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), 0);
     glBindBuffer(GL_ARRAY_BUFFER, 0);
@@ -1,18 +1,20 @@
 #pragma once
 
+#include <array>
 #include <string>
 #include <stdexcept>
-#include <map>
 #include <memory>
+#include <vector>
 
 #include "Shader.h"
+#include "Texture.h"
 
 #include <glm/glm.hpp>
 #include <ft2build.h>
 #include FT_FREETYPE_H
 
 struct Character {
-	unsigned int TextureID;  // ID handle of the glyph texture
+	glm::vec4    UVs;        // Left, top, right, bottom of the glyph in the atlas
 	glm::ivec2   Size;       // Size of glyph
 	glm::ivec2   Bearing;    // Offset from baseline to left/top of glyph
 	unsigned int Advance;    // Offset to advance to next glyph
@@ -31,6 +33,10 @@ public:
 
 	void Load(unsigned int _Size);
 	void Render(const std::string& Text, const glm::vec2& Position, float Scale, const float Color[]);
+	// Six vertices <vec2 position, vec2 texCoords> per visible glyph, appended
+	void BuildQuads(const std::string& Text, const glm::vec2& Position, float Scale, std::vector<glm::vec4>& QuadVertices) const;
+	// One draw of vertices from BuildQuads already stored in a vertex array
+	void Draw(unsigned int VertexArray, int VertexCount, const float Color[]) const;
 
 	class LoadError : public std::runtime_error
 	{
@@ -38,6 +44,9 @@ public:
 	};
 
 private:
+	// Code points 0..127, anything else renders as nothing
+	static constexpr size_t CHARACTER_COUNT = 128;
+
 	void LoadCharacters(FT_Face& Face);
 	void PrepareRenderQuad();
 
@@ -45,11 +54,15 @@ private:
 	std::string Name;
 	unsigned int Size;
 
-	std::map<char, Character> Characters;
+	std::array<Character, CHARACTER_COUNT> Characters;
+	// Every glyph in one texture, a string is one draw
+	Texture::SharedPtr GlyphAtlas;
 
 	Shader::SharedPtr TextShader;
 	unsigned int QuadId;
 	unsigned int BufferId;
+	size_t BufferCapacity;
+	std::vector<glm::vec4> Vertices;
 
 	glm::mat4 Projection;
 
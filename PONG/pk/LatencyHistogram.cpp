@@ -0,0 +1,48 @@
+#include "LatencyHistogram.h"
+
+#include <algorithm>
+
+LatencyHistogram::LatencyHistogram(const Clock::Nanoseconds _BucketWidth, const int BucketCount)
+	: BucketWidth(std::max<Clock::Nanoseconds>(_BucketWidth, 1)), Buckets(std::max(BucketCount, 1), 0), Count(0), Max(0)
+{
+}
+
+void LatencyHistogram::Add(const Clock::Nanoseconds Latency)
+{
+	const Clock::Nanoseconds Last = static_cast<Clock::Nanoseconds>(Buckets.size()) - 1;
+	Buckets[static_cast<size_t>(std::min(std::max<Clock::Nanoseconds>(Latency / BucketWidth, 0), Last))]++;
+	Count++;
+	Max = std::max(Max, Latency);
+}
+
+void LatencyHistogram::Clear()
+{
+	std::fill(Buckets.begin(), Buckets.end(), 0);
+	Count = 0;
+	Max = 0;
+}
+
+Clock::Nanoseconds LatencyHistogram::Percentile(const double Fraction) const
+{
+	const uint64_t Target = static_cast<uint64_t>(Fraction * Count);
+	uint64_t Seen = 0;
+	for (size_t i = 0; i < Buckets.size(); ++i)
+	{
+		Seen += Buckets[i];
+		if (Seen > Target)
+		{
+			return std::min(static_cast<Clock::Nanoseconds>(i + 1) * BucketWidth, Max);
+		}
+	}
+	return Max;
+}
+
+Clock::Nanoseconds LatencyHistogram::GetMax() const
+{
+	return Max;
+}
+
+uint64_t LatencyHistogram::GetCount() const
+{
+	return Count;
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "Clock.h"
+
+// Fixed width buckets of durations, percentiles without keeping every sample.
+// Anything past the last bucket is counted in it, the exact maximum is kept apart.
+class LatencyHistogram
+{
+public:
+	LatencyHistogram(const Clock::Nanoseconds _BucketWidth, const int BucketCount);
+
+	void Add(const Clock::Nanoseconds Latency);
+	void Clear();
+
+	// Upper edge of the bucket holding that fraction of the samples
+	Clock::Nanoseconds Percentile(const double Fraction) const;
+	Clock::Nanoseconds GetMax() const;
+	uint64_t GetCount() const;
+
+private:
+	Clock::Nanoseconds BucketWidth;
+	std::vector<uint64_t> Buckets;
+	uint64_t Count;
+	Clock::Nanoseconds Max;
+};
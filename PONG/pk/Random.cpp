@@ -0,0 +1,41 @@
+#include "Random.h"
+
+Random::Random(const uint32_t _Seed)
+	: State(1)
+{
+	Seed(_Seed);
+}
+
+void Random::Seed(const uint32_t _Seed)
+{
+	// Xorshift gets stuck on zero
+	State = (_Seed != 0) ? _Seed : 0x9E3779B9u;
+}
+
+uint32_t Random::GetState() const
+{
+	return State;
+}
+
+void Random::SetState(const uint32_t NewState)
+{
+	Seed(NewState);
+}
+
+uint32_t Random::Next()
+{
+	State ^= State << 13;
+	State ^= State >> 17;
+	State ^= State << 5;
+	return State;
+}
+
+int Random::Range(const int Max)
+{
+	if (Max <= 0)
+	{
+		return 0;
+	}
+
+	return static_cast<int>(Next() % static_cast<uint32_t>(Max));
+}
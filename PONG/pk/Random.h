@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstdint>
+
+// Small deterministic generator (xorshift32).
+// Its whole state is one word so it can be seeded, saved and restored cheaply.
+class Random
+{
+public:
+	explicit Random(const uint32_t _Seed = 1);
+
+	void Seed(const uint32_t _Seed);
+	uint32_t GetState() const;
+	void SetState(const uint32_t NewState);
+
+	uint32_t Next();
+	int Range(const int Max);
+
+private:
+	uint32_t State;
+};
@@ -42,6 +42,7 @@ void Renderer::RenderSprite(const Shader::SharedPtr& Shader, const Texture::Shar
 		Shader->Use();
 		Shader->SetFloat("spriteColor", Color);
 		Shader->SetMatrix("model", Model);
+		Shader->SetFloat("uvRect", Texture ? Texture->GetUVs() : glm::vec4(0.f, 0.f, 1.f, 1.f));
 	}
 
 	if (Texture)
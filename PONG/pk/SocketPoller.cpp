@@ -0,0 +1,136 @@
+#include "SocketPoller.h"
+
+#include <algorithm>
+#include <string>
+
+#if defined(__linux__)
+#include <sys/epoll.h>
+#include <unistd.h>
+#elif defined(_WIN32)
+#include <winsock2.h>
+#else
+#include <poll.h>
+#endif
+
+namespace
+{
+	constexpr int MAX_EVENTS = 256;
+
+	int ToMilliseconds(const Clock::Nanoseconds Timeout)
+	{
+		return (Timeout > 0) ? static_cast<int>(Timeout / 1000000) : 0;
+	}
+
+#if defined(__linux__)
+	epoll_event MakeEpollEvent(const int Token, const bool bWritable)
+	{
+		epoll_event Interest = {};
+		Interest.events = EPOLLIN | (bWritable ? static_cast<uint32_t>(EPOLLOUT) : 0u);
+		Interest.data.u64 = static_cast<uint64_t>(static_cast<uint32_t>(Token));
+		return Interest;
+	}
+#endif
+}
+
+SocketPoller::SocketPoller()
+	: Descriptor(-1)
+{
+#if defined(__linux__)
+	Descriptor = epoll_create1(0);
+	if (Descriptor < 0)
+	{
+		throw Error("Poller Error: could not create an epoll instance");
+	}
+#endif
+}
+
+void SocketPoller::Add(const intptr_t Handle, const int Token, const bool bWritable)
+{
+#if defined(__linux__)
+	epoll_event Interest = MakeEpollEvent(Token, bWritable);
+	if (epoll_ctl(Descriptor, EPOLL_CTL_ADD, static_cast<int>(Handle), &Interest) != 0)
+	{
+		throw Error("Poller Error: could not watch socket " + std::to_string(Handle));
+	}
+#endif
+	Sockets.push_back(Watched{ Handle, Token, bWritable });
+}
+
+void SocketPoller::Modify(const intptr_t Handle, const int Token, const bool bWritable)
+{
+	const std::vector<Watched>::iterator Found = std::find_if(Sockets.begin(), Sockets.end(),
+		[Handle](const Watched& Entry) { return Entry.Handle == Handle; });
+	if (Found == Sockets.end())
+	{
+		return;
+	}
+
+	Found->Token = Token;
+	Found->bWritable = bWritable;
+#if defined(__linux__)
+	epoll_event Interest = MakeEpollEvent(Token, bWritable);
+	epoll_ctl(Descriptor, EPOLL_CTL_MOD, static_cast<int>(Handle), &Interest);
+#endif
+}
+
+void SocketPoller::Remove(const intptr_t Handle)
+{
+#if defined(__linux__)
+	epoll_event Ignored = {};
+	epoll_ctl(Descriptor, EPOLL_CTL_DEL, static_cast<int>(Handle), &Ignored);
+#endif
+	Sockets.erase(std::remove_if(Sockets.begin(), Sockets.end(), [Handle](const Watched& Entry) { return Entry.Handle == Handle; }),
+		Sockets.end());
+}
+
+int SocketPoller::Wait(const Clock::Nanoseconds Timeout, std::vector<Event>& Events)
+{
+	Events.clear();
+
+#if defined(__linux__)
+	epoll_event Ready[MAX_EVENTS];
+	const int Count = epoll_wait(Descriptor, Ready, MAX_EVENTS, ToMilliseconds(Timeout));
+	for (int i = 0; i < Count; ++i)
+	{
+		// Errors and hang ups are reported as readable, the next receive tells what happened
+		const bool bReadable = (Ready[i].events & (EPOLLIN | EPOLLERR | EPOLLHUP)) != 0;
+		Events.push_back(Event{ static_cast<int>(Ready[i].data.u64), bReadable, (Ready[i].events & EPOLLOUT) != 0 });
+	}
+#else
+#if defined(_WIN32)
+	typedef WSAPOLLFD PollEntry;
+#else
+	typedef pollfd PollEntry;
+#endif
+	std::vector<PollEntry> Entries(Sockets.size());
+	for (size_t i = 0; i < Sockets.size(); ++i)
+	{
+		Entries[i].fd = static_cast<decltype(Entries[i].fd)>(Sockets[i].Handle);
+		Entries[i].events = POLLIN | (Sockets[i].bWritable ? POLLOUT : 0);
+		Entries[i].revents = 0;
+	}
+
+#if defined(_WIN32)
+	const int Count = WSAPoll(Entries.data(), static_cast<ULONG>(Entries.size()), ToMilliseconds(Timeout));
+#else
+	const int Count = poll(Entries.data(), static_cast<nfds_t>(Entries.size()), ToMilliseconds(Timeout));
+#endif
+	for (size_t i = 0; Count > 0 && i < Entries.size(); ++i)
+	{
+		if (Entries[i].revents != 0)
+		{
+			const bool bReadable = (Entries[i].revents & (POLLIN | POLLERR | POLLHUP)) != 0;
+			Events.push_back(Event{ Sockets[i].Token, bReadable, (Entries[i].revents & POLLOUT) != 0 });
+		}
+	}
+#endif
+
+	return static_cast<int>(Events.size());
+}
+
+SocketPoller::~SocketPoller()
+{
+#if defined(__linux__)
+	close(Descriptor);
+#endif
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+#include "Clock.h"
+
+// Readiness of many sockets at once: epoll on Linux, WSAPoll on Windows and poll elsewhere.
+// Level triggered, a socket stays ready until it is drained (or, for writes, until its buffer fills).
+class SocketPoller
+{
+public:
+	class Error : public std::runtime_error
+	{
+	public:
+		using std::runtime_error::runtime_error;
+	};
+
+	struct Event
+	{
+		// Whatever the socket was added with
+		int Token;
+		bool bReadable;
+		bool bWritable;
+	};
+
+	SocketPoller();
+
+	SocketPoller(const SocketPoller&) = delete;
+	SocketPoller& operator=(const SocketPoller&) = delete;
+
+	// Always watched for reading, for writing only when asked
+	void Add(const intptr_t Handle, const int Token, const bool bWritable = false);
+	void Modify(const intptr_t Handle, const int Token, const bool bWritable);
+	void Remove(const intptr_t Handle);
+
+	// Waits up to Timeout, rounded down to a millisecond, 0 only checks. Returns the number of ready sockets.
+	int Wait(const Clock::Nanoseconds Timeout, std::vector<Event>& Events);
+
+	~SocketPoller();
+
+private:
+	struct Watched
+	{
+		intptr_t Handle;
+		int Token;
+		bool bWritable;
+	};
+
+	// The epoll descriptor on Linux, unused elsewhere
+	int Descriptor;
+	// Everything added, the poll fallbacks rebuild their array from it
+	std::vector<Watched> Sockets;
+};
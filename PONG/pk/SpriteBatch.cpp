@@ -0,0 +1,145 @@
+#include "SpriteBatch.h"
+
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <cstddef>
+
+namespace
+{
+	constexpr size_t INITIAL_CAPACITY = 1024;
+}
+
+SpriteBatch::SpriteBatch(const Shader::SharedPtr& _BatchShader, const glm::mat4& _Projection)
+	: BatchShader(_BatchShader), Projection(_Projection), QuadId(0), QuadBuffer(0), InstanceBuffer(0),
+		InstanceCapacity(INITIAL_CAPACITY), DrawCalls(0), Sprites(0)
+{
+	BatchShader->Use();
+	BatchShader->SetMatrix("projection", Projection);
+
+	Instances.reserve(INITIAL_CAPACITY);
+	PrepareBuffers();
+}
+
+SpriteBatch::~SpriteBatch()
+{
+	glDeleteBuffers(1, &InstanceBuffer);
+	glDeleteBuffers(1, &QuadBuffer);
+	glDeleteVertexArrays(1, &QuadId);
+}
+
+void SpriteBatch::Begin()
+{
+	Instances.clear();
+	Runs.clear();
+	DrawCalls = 0;
+	Sprites = 0;
+}
+
+void SpriteBatch::Draw(const Texture::SharedPtr& SpriteTexture, const glm::vec2& Center, const glm::vec2& Size, const glm::vec3& Color)
+{
+	const unsigned int Current = SpriteTexture ? SpriteTexture->GetId() : 0;
+	if (Runs.empty() || Runs.back().TextureId != Current)
+	{
+		Runs.push_back(Run{ Current, static_cast<int>(Instances.size()), 0 });
+	}
+
+	Runs.back().Count++;
+	Instances.push_back(SpriteInstance{ Center, Size, Color, SpriteTexture ? SpriteTexture->GetUVs() : glm::vec4(0.f, 0.f, 1.f, 1.f) });
+}
+
+void SpriteBatch::Flush()
+{
+	if (Instances.empty())
+	{
+		return;
+	}
+
+	glBindVertexArray(QuadId);
+	glBindBuffer(GL_ARRAY_BUFFER, InstanceBuffer);
+
+	// Orphaning the buffer lets the driver keep drawing from the previous contents while this one is written
+	if (Instances.size() > InstanceCapacity)
+	{
+		InstanceCapacity = std::max(Instances.size(), InstanceCapacity * 2);
+	}
+	glBufferData(GL_ARRAY_BUFFER, InstanceCapacity * sizeof(SpriteInstance), nullptr, GL_STREAM_DRAW);
+	glBufferSubData(GL_ARRAY_BUFFER, 0, Instances.size() * sizeof(SpriteInstance), Instances.data());
+
+	BatchShader->Use();
+	glActiveTexture(GL_TEXTURE0);
+
+	for (const Run& Current : Runs)
+	{
+		PointInstances(Current.First);
+		if (Current.TextureId != 0)
+		{
+			glBindTexture(GL_TEXTURE_2D, Current.TextureId);
+		}
+
+		glDrawArraysInstanced(GL_TRIANGLES, 0, 6, Current.Count);
+		DrawCalls++;
+	}
+
+	glBindVertexArray(0);
+	glBindTexture(GL_TEXTURE_2D, 0);
+
+	Sprites += static_cast<int>(Instances.size());
+	Instances.clear();
+	Runs.clear();
+}
+
+int SpriteBatch::GetDrawCalls() const
+{
+	return DrawCalls;
+}
+
+int SpriteBatch::GetSprites() const
+{
+	return Sprites;
+}
+
+void SpriteBatch::PrepareBuffers()
+{
+	// Same unit quad as Renderer::RenderSprite, scaled and moved per instance
+	float VertexData[] = {
+		-0.5f, 0.5f, 0.f, 1.f,
+		-0.5f, -0.5f, 0.f, 0.f,
+		0.5f, -0.5f, 1.f, 0.f,
+		-0.5f, 0.5f, 0.f, 1.f,
+		0.5f, 0.5f, 1.f, 1.f,
+		0.5f, -0.5f, 1.f, 0.f
+	};
+
+	glGenVertexArrays(1, &QuadId);
+	glBindVertexArray(QuadId);
+
+	glGenBuffers(1, &QuadBuffer);
+	glBindBuffer(GL_ARRAY_BUFFER, QuadBuffer);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(VertexData), VertexData, GL_STATIC_DRAW);
+
+	glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
+	glEnableVertexAttribArray(0);
+
+	glGenBuffers(1, &InstanceBuffer);
+	glBindBuffer(GL_ARRAY_BUFFER, InstanceBuffer);
+	glBufferData(GL_ARRAY_BUFFER, InstanceCapacity * sizeof(SpriteInstance), nullptr, GL_STREAM_DRAW);
+
+	glEnableVertexAttribArray(1);
+	glVertexAttribDivisor(1, 1);
+	glEnableVertexAttribArray(2);
+	glVertexAttribDivisor(2, 1);
+	glEnableVertexAttribArray(3);
+	glVertexAttribDivisor(3, 1);
+	PointInstances(0);
+
+	glBindVertexArray(0);
+}
+
+void SpriteBatch::PointInstances(const int First) const
+{
+	const size_t Base = First * sizeof(SpriteInstance);
+	glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(SpriteInstance), (void*)(Base + offsetof(SpriteInstance, Center)));
+	glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(SpriteInstance), (void*)(Base + offsetof(SpriteInstance, Color)));
+	glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, sizeof(SpriteInstance), (void*)(Base + offsetof(SpriteInstance, UVs)));
+}
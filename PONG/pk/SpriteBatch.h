@@ -0,0 +1,67 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <memory>
+#include <vector>
+
+#include "Shader.h"
+#include "Texture.h"
+
+// Per sprite attributes, streamed to the GPU once per flush
+struct SpriteInstance
+{
+	glm::vec2 Center;
+	glm::vec2 Size;
+	glm::vec3 Color;
+	glm::vec4 UVs;
+};
+
+// Collects the sprites of a frame in one instance buffer and draws them with one instanced call
+// per run of consecutive sprites sharing a texture, sprites from the same atlas page share a run. Submission order is kept, so overlapping sprites
+// layer exactly as they did with one draw each.
+class SpriteBatch
+{
+public:
+	typedef std::unique_ptr<SpriteBatch> UniquePtr;
+
+	SpriteBatch(const Shader::SharedPtr& _BatchShader, const glm::mat4& _Projection);
+	~SpriteBatch();
+
+	SpriteBatch(const SpriteBatch&) = delete;
+	SpriteBatch& operator=(const SpriteBatch&) = delete;
+
+	// Drops anything not flushed and starts counting draw calls again
+	void Begin();
+	void Draw(const Texture::SharedPtr& SpriteTexture, const glm::vec2& Center, const glm::vec2& Size, const glm::vec3& Color);
+	void Flush();
+
+	// Since the last Begin
+	int GetDrawCalls() const;
+	int GetSprites() const;
+
+private:
+	struct Run
+	{
+		unsigned int TextureId;
+		int First;
+		int Count;
+	};
+
+	void PrepareBuffers();
+	// Instance attributes start at the first sprite of the run, GL 3.3 has no base instance
+	void PointInstances(const int First) const;
+
+	Shader::SharedPtr BatchShader;
+	glm::mat4 Projection;
+
+	unsigned int QuadId;
+	unsigned int QuadBuffer;
+	unsigned int InstanceBuffer;
+	size_t InstanceCapacity;
+
+	std::vector<SpriteInstance> Instances;
+	std::vector<Run> Runs;
+	int DrawCalls;
+	int Sprites;
+};
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+// Bounded lock-free queue between exactly one producer thread and one consumer thread.
+// Push and Pop never block nor allocate: a full or empty queue is reported and the caller decides.
+template <typename T>
+class SpscQueue
+{
+public:
+	// Rounded up to a power of two
+	explicit SpscQueue(const size_t Capacity)
+		: Items(RoundUp(Capacity)), Mask(Items.size() - 1), Head(0), Tail(0)
+	{
+	}
+
+	SpscQueue(const SpscQueue&) = delete;
+	SpscQueue& operator=(const SpscQueue&) = delete;
+
+	// Producer only, false when full
+	bool Push(const T& Item)
+	{
+		const size_t Position = Tail.load(std::memory_order_relaxed);
+		if (Position - Head.load(std::memory_order_acquire) == Items.size())
+		{
+			return false;
+		}
+
+		Items[Position & Mask] = Item;
+		Tail.store(Position + 1, std::memory_order_release);
+		return true;
+	}
+
+	// Consumer only, false when empty
+	bool Pop(T& Item)
+	{
+		const size_t Position = Head.load(std::memory_order_relaxed);
+		if (Position == Tail.load(std::memory_order_acquire))
+		{
+			return false;
+		}
+
+		Item = Items[Position & Mask];
+		Head.store(Position + 1, std::memory_order_release);
+		return true;
+	}
+
+private:
+	static size_t RoundUp(const size_t Capacity)
+	{
+		size_t Size = 1;
+		while (Size < Capacity)
+		{
+			Size <<= 1;
+		}
+		return Size;
+	}
+
+	std::vector<T> Items;
+	size_t Mask;
+	// On separate cache lines, each one is written by one side only
+	alignas(64) std::atomic<size_t> Head;
+	alignas(64) std::atomic<size_t> Tail;
+};
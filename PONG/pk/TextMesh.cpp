@@ -0,0 +1,78 @@
+#include "TextMesh.h"
+
+#include <glad/glad.h>
+
+#include "Font.h"
+
+TextMesh::TextMesh(const std::shared_ptr<Font>& _MeshFont)
+	: MeshFont(_MeshFont), Position(0.f), Scale(0.f), VertexArrayId(0), BufferId(0), BufferCapacity(0), VertexCount(0), Rebuilds(0)
+{
+	glGenVertexArrays(1, &VertexArrayId);
+	glGenBuffers(1, &BufferId);
+	glBindVertexArray(VertexArrayId);
+	glBindBuffer(GL_ARRAY_BUFFER, BufferId);
+	glEnableVertexAttribArray(0);
+	glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, sizeof(glm::vec4), (void*)0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glBindVertexArray(0);
+}
+
+TextMesh::~TextMesh()
+{
+	glDeleteBuffers(1, &BufferId);
+	glDeleteVertexArrays(1, &VertexArrayId);
+}
+
+void TextMesh::Set(const std::string& _Text, const glm::vec2& _Position, const float _Scale)
+{
+	if (Rebuilds > 0 && _Text == Text && _Position == Position && _Scale == Scale)
+	{
+		return;
+	}
+
+	Text = _Text;
+	Position = _Position;
+	Scale = _Scale;
+	Rebuild();
+}
+
+void TextMesh::Render(const float Color[]) const
+{
+	MeshFont->Draw(VertexArrayId, VertexCount, Color);
+}
+
+const std::string& TextMesh::GetText() const
+{
+	return Text;
+}
+
+int TextMesh::GetRebuilds() const
+{
+	return Rebuilds;
+}
+
+void TextMesh::Rebuild()
+{
+	Vertices.clear();
+	MeshFont->BuildQuads(Text, Position, Scale, Vertices);
+	VertexCount = static_cast<int>(Vertices.size());
+	Rebuilds++;
+
+	if (Vertices.empty())
+	{
+		return;
+	}
+
+	// Storage only grows, a shorter string reuses it
+	glBindBuffer(GL_ARRAY_BUFFER, BufferId);
+	if (Vertices.size() > BufferCapacity)
+	{
+		BufferCapacity = Vertices.size();
+		glBufferData(GL_ARRAY_BUFFER, BufferCapacity * sizeof(glm::vec4), Vertices.data(), GL_DYNAMIC_DRAW);
+	}
+	else
+	{
+		glBufferSubData(GL_ARRAY_BUFFER, 0, Vertices.size() * sizeof(glm::vec4), Vertices.data());
+	}
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+class Font;
+
+// A string tessellated once and kept on the GPU. Set only rebuilds the vertices when the text,
+// position or scale differ from the last ones, so drawing unchanged text is one draw call with no
+// CPU work and, once the buffers have grown to fit, no allocations either.
+class TextMesh
+{
+public:
+	typedef std::unique_ptr<TextMesh> UniquePtr;
+
+	TextMesh(const std::shared_ptr<Font>& _MeshFont);
+	~TextMesh();
+
+	TextMesh(const TextMesh&) = delete;
+	TextMesh& operator=(const TextMesh&) = delete;
+
+	void Set(const std::string& _Text, const glm::vec2& _Position, const float _Scale);
+	void Render(const float Color[]) const;
+
+	const std::string& GetText() const;
+	// Times the vertices were built since construction
+	int GetRebuilds() const;
+
+private:
+	void Rebuild();
+
+	std::shared_ptr<Font> MeshFont;
+	std::string Text;
+	glm::vec2 Position;
+	float Scale;
+
+	unsigned int VertexArrayId;
+	unsigned int BufferId;
+	size_t BufferCapacity;
+	int VertexCount;
+	int Rebuilds;
+
+	std::vector<glm::vec4> Vertices;
+};
\ No newline at end of file
@@ -4,7 +4,8 @@
 #include <stb_image.h>
 
 Texture::Texture(const std::string& _Path, int _Format, int _WrapS, int _WrapT, int _MinFilter, int _MaxFilter)
-	: Path(_Path), Width(0), Height(0), Channels(0), Format(_Format), WrapS(_WrapS), WrapT(_WrapT), MinFilter(_MinFilter), MaxFilter(_MaxFilter)
+	: Path(_Path), Width(0), Height(0), Channels(0), Format(_Format), WrapS(_WrapS), WrapT(_WrapT), MinFilter(_MinFilter), MaxFilter(_MaxFilter),
+		UVs(0.f, 0.f, 1.f, 1.f)
 {
 	glGenTextures(1, &Id);
 	Bind();
@@ -29,6 +30,29 @@ Texture::Texture(const std::string& _Path, int _Format, int _WrapS, int _WrapT,
 	stbi_image_free(Data);
 }
 
+Texture::Texture(const int _Width, const int _Height, int _Format, int _WrapS, int _WrapT, int _MinFilter, int _MaxFilter)
+	: Width(_Width), Height(_Height), Channels(0), Format(_Format), WrapS(_WrapS), WrapT(_WrapT), MinFilter(_MinFilter), MaxFilter(_MaxFilter),
+		UVs(0.f, 0.f, 1.f, 1.f)
+{
+	glGenTextures(1, &Id);
+	Bind();
+
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, WrapS);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, WrapT);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, MinFilter);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, MaxFilter);
+
+	glTexImage2D(GL_TEXTURE_2D, 0, Format, Width, Height, 0, Format, GL_UNSIGNED_BYTE, nullptr);
+}
+
+Texture::Texture(const SharedPtr& _Page, const std::string& _Path, const glm::ivec2& Offset, const int _Width, const int _Height)
+	: Id(_Page->Id), Path(_Path), Width(_Width), Height(_Height), Channels(0), Format(_Page->Format), WrapS(_Page->WrapS), WrapT(_Page->WrapT),
+		MinFilter(_Page->MinFilter), MaxFilter(_Page->MaxFilter), Page(_Page)
+{
+	const glm::vec2 PageSize(static_cast<float>(Page->Width), static_cast<float>(Page->Height));
+	UVs = glm::vec4(glm::vec2(Offset) / PageSize, glm::vec2(Offset + glm::ivec2(Width, Height)) / PageSize);
+}
+
 unsigned int Texture::GetId() const
 {
 	return Id;
@@ -49,6 +73,20 @@ int Texture::GetHeight() const
 	return Height;
 }
 
+glm::vec4 Texture::GetUVs() const
+{
+	return UVs;
+}
+
+void Texture::Upload(const glm::ivec2& Offset, const int _Width, const int _Height, const unsigned char* Pixels)
+{
+	Bind();
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	glTexSubImage2D(GL_TEXTURE_2D, 0, Offset.x, Offset.y, _Width, _Height, Format, GL_UNSIGNED_BYTE, Pixels);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+	glGenerateMipmap(GL_TEXTURE_2D);
+}
+
 void Texture::Bind() const
 {
 	glBindTexture(GL_TEXTURE_2D, Id);
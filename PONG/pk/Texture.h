@@ -1,5 +1,7 @@
 #pragma once
 
+#include <glm/glm.hpp>
+
 #include <memory>
 #include <stdexcept>
 #include <string>
@@ -10,11 +12,20 @@ public:
 	typedef std::shared_ptr<Texture> SharedPtr;
 
 	Texture(const std::string& _Path, int _Format, int _WrapS, int _WrapT, int _MinFilter, int _MaxFilter);
+	// Empty storage, filled later with Upload
+	Texture(const int _Width, const int _Height, int _Format, int _WrapS, int _WrapT, int _MinFilter, int _MaxFilter);
+	// Sub rectangle of an atlas page, binds the page and samples through GetUVs
+	Texture(const SharedPtr& _Page, const std::string& _Path, const glm::ivec2& Offset, const int _Width, const int _Height);
 
 	unsigned int GetId() const;
 	std::string GetPath() const;
 	int GetWidth() const;
 	int GetHeight() const;
+	// Left, bottom, right, top in texture coordinates, the whole texture unless it lives in an atlas
+	glm::vec4 GetUVs() const;
+
+	// Pixels in Format, rows from the top, mipmaps are rebuilt
+	void Upload(const glm::ivec2& Offset, const int _Width, const int _Height, const unsigned char* Pixels);
 
 	void Bind() const;
 	void UnBind() const;
@@ -36,4 +47,7 @@ private:
 	int WrapT;
 	int MinFilter;
 	int MaxFilter;
+
+	SharedPtr Page;
+	glm::vec4 UVs;
 };
\ No newline at end of file
@@ -0,0 +1,191 @@
+#include "TextureAtlas.h"
+
+#include <glad/glad.h>
+#include <stb_image.h>
+
+#include <algorithm>
+
+namespace
+{
+	constexpr int CHANNELS = 4;
+
+	int RoundUp(const int Value, const int Multiple)
+	{
+		return (Value + Multiple - 1) / Multiple * Multiple;
+	}
+
+	// Deepest mipmap level whose texels still fit in the padding
+	int MaxMipLevel(const int Padding)
+	{
+		int Level = 0;
+		while ((2 << Level) <= Padding)
+		{
+			++Level;
+		}
+		return Level;
+	}
+}
+
+SkylinePacker::SkylinePacker(const int _Width, const int _Height)
+	: Width(_Width), Height(_Height)
+{
+	Skyline.push_back(Segment{ 0, 0, Width });
+}
+
+bool SkylinePacker::Insert(const int RectWidth, const int RectHeight, glm::ivec2& Position)
+{
+	int BestIndex = -1;
+	int BestY = Height;
+	for (size_t i = 0; i < Skyline.size(); ++i)
+	{
+		const int Y = Fit(i, RectWidth, RectHeight);
+		if (Y >= 0 && Y < BestY)
+		{
+			BestIndex = static_cast<int>(i);
+			BestY = Y;
+		}
+	}
+
+	if (BestIndex < 0)
+	{
+		return false;
+	}
+
+	Position = glm::ivec2(Skyline[BestIndex].X, BestY);
+
+	// The new segment covers the rectangle top, segments under it shrink or go
+	const Segment Placed{ Position.x, BestY + RectHeight, RectWidth };
+	Skyline.insert(Skyline.begin() + BestIndex, Placed);
+	for (size_t i = BestIndex + 1; i < Skyline.size();)
+	{
+		Segment& Current = Skyline[i];
+		const int Overlap = Placed.X + Placed.Width - Current.X;
+		if (Overlap <= 0)
+		{
+			break;
+		}
+
+		if (Overlap < Current.Width)
+		{
+			Current.X += Overlap;
+			Current.Width -= Overlap;
+			break;
+		}
+		Skyline.erase(Skyline.begin() + i);
+	}
+
+	for (size_t i = 0; i + 1 < Skyline.size();)
+	{
+		if (Skyline[i].Y == Skyline[i + 1].Y)
+		{
+			Skyline[i].Width += Skyline[i + 1].Width;
+			Skyline.erase(Skyline.begin() + i + 1);
+			continue;
+		}
+		++i;
+	}
+
+	return true;
+}
+
+int SkylinePacker::Fit(const size_t Index, const int RectWidth, const int RectHeight) const
+{
+	const int X = Skyline[Index].X;
+	if (X + RectWidth > Width)
+	{
+		return -1;
+	}
+
+	int Y = 0;
+	int Remaining = RectWidth;
+	for (size_t i = Index; Remaining > 0 && i < Skyline.size(); ++i)
+	{
+		Y = std::max(Y, Skyline[i].Y);
+		Remaining -= Skyline[i].Width;
+	}
+
+	return (Y + RectHeight <= Height) ? Y : -1;
+}
+
+TextureAtlas::TextureAtlas(const int _PageSize, const int _Padding, const int _MinFilter, const int _MaxFilter)
+	: PageSize(_PageSize), Padding(std::max(_Padding, 1)), MinFilter(_MinFilter), MaxFilter(_MaxFilter)
+{
+}
+
+Texture::SharedPtr TextureAtlas::Add(const std::string& Path)
+{
+	int ImageWidth = 0, ImageHeight = 0, Channels = 0;
+	unsigned char* Data = stbi_load(Path.c_str(), &ImageWidth, &ImageHeight, &Channels, CHANNELS);
+	if (!Data)
+	{
+		throw Texture::LoadError("Unable to load texture " + Path);
+	}
+
+	// Sizes rounded to the padding keep every position on the grid
+	const int PaddedWidth = ImageWidth + 2 * Padding;
+	const int PaddedHeight = ImageHeight + 2 * Padding;
+	const int SlotWidth = RoundUp(PaddedWidth, Padding);
+	const int SlotHeight = RoundUp(PaddedHeight, Padding);
+	if (SlotWidth > PageSize || SlotHeight > PageSize)
+	{
+		stbi_image_free(Data);
+		return nullptr;
+	}
+
+	// Edge pixels extruded into the padding, sampling past the border reads the border
+	std::vector<unsigned char> Padded(static_cast<size_t>(PaddedWidth) * PaddedHeight * CHANNELS);
+	for (int y = 0; y < PaddedHeight; ++y)
+	{
+		const int SourceY = std::min(std::max(y - Padding, 0), ImageHeight - 1);
+		for (int x = 0; x < PaddedWidth; ++x)
+		{
+			const int SourceX = std::min(std::max(x - Padding, 0), ImageWidth - 1);
+			std::copy_n(Data + (static_cast<size_t>(SourceY) * ImageWidth + SourceX) * CHANNELS, CHANNELS,
+				Padded.data() + (static_cast<size_t>(y) * PaddedWidth + x) * CHANNELS);
+		}
+	}
+	stbi_image_free(Data);
+
+	glm::ivec2 Position(0);
+	Page* Target = nullptr;
+	for (Page& Candidate : Pages)
+	{
+		if (Candidate.Packer.Insert(SlotWidth, SlotHeight, Position))
+		{
+			Target = &Candidate;
+			break;
+		}
+	}
+
+	if (Target == nullptr)
+	{
+		Target = &AddPage();
+		Target->Packer.Insert(SlotWidth, SlotHeight, Position);
+	}
+
+	Target->PageTexture->Upload(Position, PaddedWidth, PaddedHeight, Padded.data());
+	return std::make_shared<Texture>(Target->PageTexture, Path, Position + glm::ivec2(Padding), ImageWidth, ImageHeight);
+}
+
+bool TextureAtlas::Accepts(const int Format, const int _MinFilter, const int _MaxFilter) const
+{
+	return Format == GL_RGBA && _MinFilter == MinFilter && _MaxFilter == MaxFilter;
+}
+
+int TextureAtlas::GetPageCount() const
+{
+	return static_cast<int>(Pages.size());
+}
+
+TextureAtlas::Page& TextureAtlas::AddPage()
+{
+	Texture::SharedPtr PageTexture = std::make_shared<Texture>(PageSize, PageSize, GL_RGBA, GL_CLAMP_TO_EDGE, GL_CLAMP_TO_EDGE, MinFilter, MaxFilter);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, MaxMipLevel(Padding));
+
+	// Transparent until sprites land on it, the gaps between them are never sampled anyway
+	const std::vector<unsigned char> Clear(static_cast<size_t>(PageSize) * PageSize * CHANNELS, 0);
+	PageTexture->Upload(glm::ivec2(0), PageSize, PageSize, Clear.data());
+
+	Pages.push_back(Page{ PageTexture, SkylinePacker(PageSize, PageSize) });
+	return Pages.back();
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <string>
+#include <vector>
+
+#include "Texture.h"
+
+// Skyline bottom-left rectangle packer: the top edge of everything placed so far is a list of
+// horizontal segments, a new rectangle goes where it ends lowest, leftmost on ties.
+class SkylinePacker
+{
+public:
+	SkylinePacker(const int _Width, const int _Height);
+
+	// False when there is no room left
+	bool Insert(const int RectWidth, const int RectHeight, glm::ivec2& Position);
+
+private:
+	struct Segment
+	{
+		int X;
+		int Y;
+		int Width;
+	};
+
+	// Lowest Y the rectangle can sit at starting on that segment, -1 when it does not fit
+	int Fit(const size_t Index, const int RectWidth, const int RectHeight) const;
+
+	int Width;
+	int Height;
+	std::vector<Segment> Skyline;
+};
+
+// Packs images into shared texture pages at load time, so sprites drawn together need one texture bind.
+// Each image is surrounded by Padding pixels copied from its edges and placed on a Padding aligned
+// grid, mipmaps stop at the level where a texel would cover more than the padding: neither bilinear
+// filtering nor minification ever reads a neighbour.
+class TextureAtlas
+{
+public:
+	TextureAtlas(const int _PageSize, const int _Padding, const int _MinFilter, const int _MaxFilter);
+
+	// Loads an image into the first page with room, a new page when none has.
+	// Null for images larger than a page, those need a texture of their own.
+	Texture::SharedPtr Add(const std::string& Path);
+	// Pages clamp instead of wrapping, sprites only sample inside their own rectangle
+	bool Accepts(const int Format, const int _MinFilter, const int _MaxFilter) const;
+	int GetPageCount() const;
+
+private:
+	struct Page
+	{
+		Texture::SharedPtr PageTexture;
+		SkylinePacker Packer;
+	};
+
+	Page& AddPage();
+
+	int PageSize;
+	int Padding;
+	int MinFilter;
+	int MaxFilter;
+	std::vector<Page> Pages;
+};
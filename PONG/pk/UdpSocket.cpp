@@ -0,0 +1,381 @@
+#include "UdpSocket.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <arpa/inet.h>
+#include <cerrno>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+#ifdef _WIN32
+	typedef SOCKET NativeSocket;
+	const NativeSocket INVALID_NATIVE_SOCKET = INVALID_SOCKET;
+
+	std::atomic<int> WinsockUsers(0);
+
+	void AcquireWinsock()
+	{
+		if (WinsockUsers++ == 0)
+		{
+			WSADATA Data;
+			if (WSAStartup(MAKEWORD(2, 2), &Data) != 0)
+			{
+				WinsockUsers--;
+				throw UdpSocket::Error("Socket Error: WSAStartup failed");
+			}
+		}
+	}
+
+	void ReleaseWinsock()
+	{
+		if (--WinsockUsers == 0)
+		{
+			WSACleanup();
+		}
+	}
+
+	void CloseNative(const NativeSocket Socket)
+	{
+		closesocket(Socket);
+	}
+
+	bool SetNonBlocking(const NativeSocket Socket)
+	{
+		u_long bNonBlocking = 1;
+		return ioctlsocket(Socket, FIONBIO, &bNonBlocking) == 0;
+	}
+#else
+	typedef int NativeSocket;
+	const NativeSocket INVALID_NATIVE_SOCKET = -1;
+
+	void AcquireWinsock()
+	{
+	}
+
+	void ReleaseWinsock()
+	{
+	}
+
+	void CloseNative(const NativeSocket Socket)
+	{
+		close(Socket);
+	}
+
+	bool SetNonBlocking(const NativeSocket Socket)
+	{
+		const int Flags = fcntl(Socket, F_GETFL, 0);
+		return Flags >= 0 && fcntl(Socket, F_SETFL, Flags | O_NONBLOCK) == 0;
+	}
+#endif
+
+#if defined(__linux__)
+	// Datagrams per sendmmsg call
+	constexpr int SEND_BATCH = 64;
+#endif
+
+	bool WouldBlock()
+	{
+#ifdef _WIN32
+		return WSAGetLastError() == WSAEWOULDBLOCK;
+#else
+		return errno == EAGAIN || errno == EWOULDBLOCK;
+#endif
+	}
+
+	sockaddr_in ToNative(const NetAddress& Address)
+	{
+		sockaddr_in Native = {};
+		Native.sin_family = AF_INET;
+		Native.sin_addr.s_addr = htonl(Address.Host);
+		Native.sin_port = htons(Address.Port);
+		return Native;
+	}
+
+	NetAddress FromNative(const sockaddr_in& Native)
+	{
+		NetAddress Address;
+		Address.Host = ntohl(Native.sin_addr.s_addr);
+		Address.Port = ntohs(Native.sin_port);
+		return Address;
+	}
+}
+
+NetAddress NetAddress::Loopback(const uint16_t Port)
+{
+	NetAddress Address;
+	Address.Host = 0x7F000001;
+	Address.Port = Port;
+	return Address;
+}
+
+bool NetAddress::Parse(const std::string& Text, NetAddress& Address)
+{
+	const size_t Colon = Text.rfind(':');
+	if (Colon == std::string::npos)
+	{
+		return false;
+	}
+
+	const std::string HostText = Text.substr(0, Colon);
+	const int PortValue = std::atoi(Text.c_str() + Colon + 1);
+	if (PortValue <= 0 || PortValue > 65535)
+	{
+		return false;
+	}
+
+	unsigned int Parts[4] = {};
+	if (HostText == "localhost")
+	{
+		Address = Loopback(static_cast<uint16_t>(PortValue));
+		return true;
+	}
+
+	char Trailing = 0;
+	if (std::sscanf(HostText.c_str(), "%u.%u.%u.%u%c", &Parts[0], &Parts[1], &Parts[2], &Parts[3], &Trailing) != 4)
+	{
+		return false;
+	}
+
+	uint32_t Host = 0;
+	for (const unsigned int Part : Parts)
+	{
+		if (Part > 255)
+		{
+			return false;
+		}
+		Host = (Host << 8) | Part;
+	}
+
+	Address.Host = Host;
+	Address.Port = static_cast<uint16_t>(PortValue);
+	return true;
+}
+
+std::string NetAddress::ToString() const
+{
+	return std::to_string(Host >> 24) + "." + std::to_string((Host >> 16) & 0xFF) + "."
+		+ std::to_string((Host >> 8) & 0xFF) + "." + std::to_string(Host & 0xFF) + ":" + std::to_string(Port);
+}
+
+bool NetAddress::operator==(const NetAddress& Other) const
+{
+	return Host == Other.Host && Port == Other.Port;
+}
+
+bool NetAddress::operator!=(const NetAddress& Other) const
+{
+	return !(*this == Other);
+}
+
+UdpSocket::UdpSocket(const uint16_t _Port)
+	: Handle(static_cast<intptr_t>(INVALID_NATIVE_SOCKET)), Port(_Port),
+		Latency(0), Jitter(0), LossPercent(0), Losses(0), NetworkRng(static_cast<uint32_t>(Clock::Now()) | 1)
+{
+	AcquireWinsock();
+
+	const NativeSocket Socket = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+	if (Socket == INVALID_NATIVE_SOCKET)
+	{
+		ReleaseWinsock();
+		throw Error("Socket Error: could not create a UDP socket");
+	}
+
+	NetAddress Any;
+	Any.Port = _Port;
+	const sockaddr_in Local = ToNative(Any);
+	if (bind(Socket, reinterpret_cast<const sockaddr*>(&Local), sizeof(Local)) != 0 || !SetNonBlocking(Socket))
+	{
+		CloseNative(Socket);
+		ReleaseWinsock();
+		throw Error("Socket Error: could not bind UDP port " + std::to_string(_Port));
+	}
+
+	sockaddr_in Bound = {};
+	socklen_t BoundSize = sizeof(Bound);
+	if (getsockname(Socket, reinterpret_cast<sockaddr*>(&Bound), &BoundSize) == 0)
+	{
+		Port = ntohs(Bound.sin_port);
+	}
+
+	Handle = static_cast<intptr_t>(Socket);
+}
+
+bool UdpSocket::Send(const NetAddress& To, const uint8_t* Data, const int Size)
+{
+	FlushDelayed();
+
+	if (LossPercent > 0 && NetworkRng.Range(100) < LossPercent)
+	{
+		Losses++;
+		return true;
+	}
+
+	if (Latency == 0 && Jitter == 0)
+	{
+		return SendNow(To, Data, Size);
+	}
+
+	// Jitter in whole microseconds, Random works on ints
+	const Clock::Nanoseconds Spread = (Jitter > 0) ? NetworkRng.Range(static_cast<int>(Jitter / 1000) + 1) * 1000LL : 0;
+	Delayed.push_back(DelayedDatagram{ Clock::Now() + Latency + Spread, To, std::vector<uint8_t>(Data, Data + Size) });
+	return true;
+}
+
+bool UdpSocket::SendNow(const NetAddress& To, const uint8_t* Data, const int Size)
+{
+	const sockaddr_in Native = ToNative(To);
+	const auto Sent = sendto(static_cast<NativeSocket>(Handle), reinterpret_cast<const char*>(Data), Size, 0,
+		reinterpret_cast<const sockaddr*>(&Native), sizeof(Native));
+	return Sent == Size;
+}
+
+int UdpSocket::SendBatch(const OutgoingDatagram* Datagrams, const int Count)
+{
+	FlushDelayed();
+
+	// Simulated datagrams each take their own path through Send
+	if (LossPercent > 0 || Latency > 0 || Jitter > 0)
+	{
+		for (int i = 0; i < Count; ++i)
+		{
+			Send(Datagrams[i].To, Datagrams[i].Data, Datagrams[i].Size);
+		}
+		return Count;
+	}
+
+	int Sent = 0;
+#if defined(__linux__)
+	sockaddr_in Addresses[SEND_BATCH];
+	iovec Buffers[SEND_BATCH];
+	mmsghdr Messages[SEND_BATCH];
+	while (Sent < Count)
+	{
+		const int Chunk = std::min(Count - Sent, SEND_BATCH);
+		for (int i = 0; i < Chunk; ++i)
+		{
+			const OutgoingDatagram& Datagram = Datagrams[Sent + i];
+			Addresses[i] = ToNative(Datagram.To);
+			Buffers[i].iov_base = const_cast<uint8_t*>(Datagram.Data);
+			Buffers[i].iov_len = static_cast<size_t>(Datagram.Size);
+			Messages[i] = {};
+			Messages[i].msg_hdr.msg_name = &Addresses[i];
+			Messages[i].msg_hdr.msg_namelen = sizeof(Addresses[i]);
+			Messages[i].msg_hdr.msg_iov = &Buffers[i];
+			Messages[i].msg_hdr.msg_iovlen = 1;
+		}
+
+		const int Result = sendmmsg(static_cast<NativeSocket>(Handle), Messages, static_cast<unsigned int>(Chunk), 0);
+		if (Result > 0)
+		{
+			Sent += Result;
+		}
+		else if (WouldBlock())
+		{
+			break;
+		}
+		else
+		{
+			// Nothing to retry with UDP, the datagram is dropped like a lost one
+			Sent++;
+		}
+	}
+#else
+	for (; Sent < Count; ++Sent)
+	{
+		const OutgoingDatagram& Datagram = Datagrams[Sent];
+		if (!SendNow(Datagram.To, Datagram.Data, Datagram.Size) && WouldBlock())
+		{
+			break;
+		}
+	}
+#endif
+	return Sent;
+}
+
+int UdpSocket::Receive(uint8_t* Data, const int Capacity, NetAddress& From)
+{
+	FlushDelayed();
+
+	sockaddr_in Native = {};
+	socklen_t NativeSize = sizeof(Native);
+	const auto Received = recvfrom(static_cast<NativeSocket>(Handle), reinterpret_cast<char*>(Data), Capacity, 0,
+		reinterpret_cast<sockaddr*>(&Native), &NativeSize);
+
+	// Would block, or an ICMP port unreachable from a peer that is not up yet
+	if (Received < 0)
+	{
+		return -1;
+	}
+
+	From = FromNative(Native);
+	return static_cast<int>(Received);
+}
+
+void UdpSocket::SetSimulatedLatency(const Clock::Nanoseconds _Latency, const Clock::Nanoseconds _Jitter)
+{
+	Latency = std::max<Clock::Nanoseconds>(_Latency, 0);
+	Jitter = std::max<Clock::Nanoseconds>(_Jitter, 0);
+}
+
+void UdpSocket::SetSimulatedLoss(const int Percent)
+{
+	LossPercent = std::min(std::max(Percent, 0), 100);
+}
+
+uint64_t UdpSocket::GetSimulatedLosses() const
+{
+	return Losses;
+}
+
+void UdpSocket::FlushDelayed()
+{
+	if (Delayed.empty())
+	{
+		return;
+	}
+
+	const Clock::Nanoseconds Now = Clock::Now();
+	const auto Due = [Now](const DelayedDatagram& Datagram) { return Datagram.Release <= Now; };
+	for (const DelayedDatagram& Datagram : Delayed)
+	{
+		if (Due(Datagram))
+		{
+			SendNow(Datagram.To, Datagram.Data.data(), static_cast<int>(Datagram.Data.size()));
+		}
+	}
+	Delayed.erase(std::remove_if(Delayed.begin(), Delayed.end(), Due), Delayed.end());
+}
+
+void UdpSocket::SetBufferSizes(const int SendBytes, const int ReceiveBytes)
+{
+	setsockopt(static_cast<NativeSocket>(Handle), SOL_SOCKET, SO_SNDBUF, reinterpret_cast<const char*>(&SendBytes), sizeof(SendBytes));
+	setsockopt(static_cast<NativeSocket>(Handle), SOL_SOCKET, SO_RCVBUF, reinterpret_cast<const char*>(&ReceiveBytes), sizeof(ReceiveBytes));
+}
+
+uint16_t UdpSocket::GetPort() const
+{
+	return Port;
+}
+
+intptr_t UdpSocket::GetHandle() const
+{
+	return Handle;
+}
+
+UdpSocket::~UdpSocket()
+{
+	CloseNative(static_cast<NativeSocket>(Handle));
+	ReleaseWinsock();
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "Clock.h"
+#include "Random.h"
+
+// IPv4 endpoint, both fields in host byte order
+struct NetAddress
+{
+	uint32_t Host = 0;
+	uint16_t Port = 0;
+
+	static NetAddress Loopback(const uint16_t Port);
+	// Accepts "a.b.c.d:port" and "localhost:port"
+	static bool Parse(const std::string& Text, NetAddress& Address);
+
+	std::string ToString() const;
+	bool operator==(const NetAddress& Other) const;
+	bool operator!=(const NetAddress& Other) const;
+};
+
+// One datagram of a batch, Data is only read during the call
+struct OutgoingDatagram
+{
+	NetAddress To;
+	const uint8_t* Data;
+	int Size;
+};
+
+// Non blocking UDP socket bound to every local interface.
+// Winsock is started with the first socket and cleaned up with the last one.
+// Outgoing datagrams can be delayed and dropped on purpose, to try bad connections on loopback.
+class UdpSocket
+{
+public:
+	typedef std::unique_ptr<UdpSocket> UniquePtr;
+
+	class Error : public std::runtime_error
+	{
+	public:
+		using std::runtime_error::runtime_error;
+	};
+
+	// Port 0 lets the system pick one, see GetPort
+	explicit UdpSocket(const uint16_t Port);
+
+	UdpSocket(const UdpSocket&) = delete;
+	UdpSocket& operator=(const UdpSocket&) = delete;
+
+	// False when the datagram could not be queued, UDP gives no other guarantee anyway
+	bool Send(const NetAddress& To, const uint8_t* Data, const int Size);
+	// Sends in order with as few system calls as the platform allows (sendmmsg on Linux).
+	// Returns how many were handed over, the rest wait for the socket to become writable again.
+	int SendBatch(const OutgoingDatagram* Datagrams, const int Count);
+	// Size of the datagram read into Data, -1 when nothing is waiting
+	int Receive(uint8_t* Data, const int Capacity, NetAddress& From);
+
+	// Delayed datagrams leave on the next Send or Receive after their time
+	void SetSimulatedLatency(const Clock::Nanoseconds _Latency, const Clock::Nanoseconds _Jitter);
+	void SetSimulatedLoss(const int Percent);
+	uint64_t GetSimulatedLosses() const;
+
+	// Kernel buffer sizes in bytes, the system may round or cap them
+	void SetBufferSizes(const int SendBytes, const int ReceiveBytes);
+
+	uint16_t GetPort() const;
+	// Native descriptor, for readiness polling
+	intptr_t GetHandle() const;
+
+	~UdpSocket();
+
+private:
+	bool SendNow(const NetAddress& To, const uint8_t* Data, const int Size);
+	void FlushDelayed();
+
+	struct DelayedDatagram
+	{
+		Clock::Nanoseconds Release;
+		NetAddress To;
+		std::vector<uint8_t> Data;
+	};
+
+	intptr_t Handle;
+	uint16_t Port;
+
+	Clock::Nanoseconds Latency;
+	Clock::Nanoseconds Jitter;
+	int LossPercent;
+	uint64_t Losses;
+	Random NetworkRng;
+	std::vector<DelayedDatagram> Delayed;
+};
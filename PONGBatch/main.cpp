@@ -0,0 +1,295 @@
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Game.h"
+#include "MatchSettings.h"
+#include "PaddleController.h"
+#include "StateChecksum.h"
+#include "pk/Clock.h"
+
+// Batch runner: plays many independent headless AI-vs-AI matches on every core
+// and streams one fixed-size record per match to a binary file.
+
+constexpr int DEFAULT_MATCHES = 10000;
+constexpr int DEFAULT_MAX_TICKS = 240 * 60 * 10;
+constexpr int MATCHES_PER_CHUNK = 64;
+constexpr float DEFAULT_AI_REACTION_DELAY = 0.15f;
+constexpr float DEFAULT_AI_ERROR = 60.f;
+const std::string DEFAULT_OUTPUT = "batch_results.bin";
+
+constexpr uint32_t BATCH_FILE_MAGIC = 0x54414250; // "PBAT"
+constexpr uint32_t BATCH_FILE_VERSION = 2;
+
+struct BatchRecord
+{
+	uint32_t MatchIndex;
+	uint32_t Ticks;
+	uint32_t TotalHits;
+	uint16_t LongestRally;
+	uint8_t PlayerOneScore;
+	uint8_t PlayerTwoScore;
+	// StateChecksum after the last tick, reruns of the same batch must reproduce it.
+	// Only the final value is kept, a divergence confined to one field escapes it about once in 256 matches.
+	uint64_t Checksum;
+};
+static_assert(sizeof(BatchRecord) == 24, "BatchRecord layout is part of the output format");
+
+struct BatchOptions
+{
+	int Matches = DEFAULT_MATCHES;
+	int MaxTicks = DEFAULT_MAX_TICKS;
+	int Threads = 0;
+	uint32_t Seed = 1;
+	std::string Output = DEFAULT_OUTPUT;
+	std::string Verify;
+	float AIReactionDelay = DEFAULT_AI_REACTION_DELAY;
+	float AIError = DEFAULT_AI_ERROR;
+	MatchSettings Settings;
+};
+
+class BatchWriter
+{
+public:
+	BatchWriter(const std::string& Path)
+		: File(Path, std::ios::binary | std::ios::trunc), Written(0)
+	{
+		const uint32_t Header[] = { BATCH_FILE_MAGIC, BATCH_FILE_VERSION, static_cast<uint32_t>(sizeof(BatchRecord)) };
+		File.write(reinterpret_cast<const char*>(Header), sizeof(Header));
+	}
+
+	bool IsOpen() const
+	{
+		return File.is_open();
+	}
+
+	void Write(const std::vector<BatchRecord>& Records)
+	{
+		std::lock_guard<std::mutex> Lock(Mutex);
+		File.write(reinterpret_cast<const char*>(Records.data()), Records.size() * sizeof(BatchRecord));
+		Written += Records.size();
+	}
+
+	void Close()
+	{
+		File.close();
+	}
+
+	size_t GetWritten() const
+	{
+		return Written;
+	}
+
+private:
+	std::ofstream File;
+	std::mutex Mutex;
+	size_t Written;
+};
+
+BatchRecord PlayMatch(const BatchOptions& Options, const uint32_t MatchIndex)
+{
+	Game g(Options.Settings);
+	g.SetSeed(Options.Seed + MatchIndex);
+	g.SetEffectsEnabled(false);
+	g.SetController(true, std::make_shared<AIController>(Options.AIReactionDelay, Options.AIError, g.GetSeed() * 2 + 1));
+	g.SetController(false, std::make_shared<AIController>(Options.AIReactionDelay, Options.AIError, g.GetSeed() * 2 + 2));
+	g.Begin();
+	g.StartMatch();
+
+	const float TickDelta = g.GetTickDelta();
+	int Tick = 0;
+	for (; Tick < Options.MaxTicks && g.GetState() == GameState::MATCH; ++Tick)
+	{
+		g.Tick(TickDelta);
+	}
+
+	const MatchStats& Stats = g.GetStats();
+
+	BatchRecord Record;
+	Record.MatchIndex = MatchIndex;
+	Record.Ticks = static_cast<uint32_t>(Tick);
+	Record.TotalHits = static_cast<uint32_t>(Stats.TotalHits + Stats.CurrentRally);
+	Record.LongestRally = static_cast<uint16_t>(std::min(std::max(Stats.LongestRally, Stats.CurrentRally), 0xFFFF));
+	Record.PlayerOneScore = static_cast<uint8_t>(g.GetPlayerOneScore());
+	Record.PlayerTwoScore = static_cast<uint8_t>(g.GetPlayerTwoScore());
+	Record.Checksum = g.GetChecksum();
+
+	return Record;
+}
+
+// Workers pull chunks of match indices from a shared counter, so shards stay balanced
+// even when match lengths vary a lot
+void RunWorker(const BatchOptions& Options, std::atomic<int>& NextMatch, BatchWriter& Writer)
+{
+	std::vector<BatchRecord> Records;
+	Records.reserve(MATCHES_PER_CHUNK);
+
+	while (true)
+	{
+		const int First = NextMatch.fetch_add(MATCHES_PER_CHUNK);
+		if (First >= Options.Matches)
+		{
+			break;
+		}
+
+		const int Last = std::min(First + MATCHES_PER_CHUNK, Options.Matches);
+		for (int Index = First; Index < Last; ++Index)
+		{
+			Records.push_back(PlayMatch(Options, static_cast<uint32_t>(Index)));
+		}
+
+		Writer.Write(Records);
+		Records.clear();
+	}
+}
+
+bool ReadResults(const std::string& Path, std::vector<BatchRecord>& Records)
+{
+	std::ifstream File(Path, std::ios::binary);
+	uint32_t Header[3];
+	if (!File.read(reinterpret_cast<char*>(Header), sizeof(Header))
+		|| Header[0] != BATCH_FILE_MAGIC || Header[1] != BATCH_FILE_VERSION || Header[2] != sizeof(BatchRecord))
+	{
+		return false;
+	}
+
+	BatchRecord Record;
+	while (File.read(reinterpret_cast<char*>(&Record), sizeof(Record)))
+	{
+		Records.push_back(Record);
+	}
+
+	// Workers finish chunks in any order
+	std::sort(Records.begin(), Records.end(), [](const BatchRecord& A, const BatchRecord& B) { return A.MatchIndex < B.MatchIndex; });
+	return true;
+}
+
+// Compares this run against an earlier one with the same options, match by match
+bool VerifyResults(const std::string& Path, const std::string& ReferencePath)
+{
+	std::vector<BatchRecord> Records, References;
+	if (!ReadResults(Path, Records) || !ReadResults(ReferencePath, References))
+	{
+		std::cout << "Unable to read results to verify\n";
+		return false;
+	}
+
+	if (Records.size() != References.size())
+	{
+		std::cout << "Verify failed: " << Records.size() << " matches against " << References.size() << "\n";
+		return false;
+	}
+
+	for (size_t i = 0; i < Records.size(); ++i)
+	{
+		if (Records[i].Checksum != References[i].Checksum || Records[i].Ticks != References[i].Ticks)
+		{
+			std::cout << "Verify failed: match " << Records[i].MatchIndex << " diverged ("
+				<< StateChecksum::Describe(StateChecksum::Compare(References[i].Checksum, Records[i].Checksum)) << ")\n";
+			return false;
+		}
+	}
+
+	std::cout << "Verified " << Records.size() << " matches against " << ReferencePath << "\n";
+	return true;
+}
+
+bool ParseOptions(int argc, char** argv, BatchOptions& Options)
+{
+	for (int i = 1; i < argc; ++i)
+	{
+		const std::string Arg(argv[i]);
+		if (i + 1 >= argc)
+		{
+			std::cout << "Missing value for " << Arg << "\n";
+			return false;
+		}
+
+		const std::string Value(argv[++i]);
+		if (Arg == "--matches") Options.Matches = std::stoi(Value);
+		else if (Arg == "--max-ticks") Options.MaxTicks = std::stoi(Value);
+		else if (Arg == "--threads") Options.Threads = std::stoi(Value);
+		else if (Arg == "--seed") Options.Seed = static_cast<uint32_t>(std::stoul(Value));
+		else if (Arg == "--output") Options.Output = Value;
+		else if (Arg == "--verify") Options.Verify = Value;
+		else if (Arg == "--player-speed") Options.Settings.PlayerSpeed = std::stof(Value);
+		else if (Arg == "--ball-speed") Options.Settings.BallSpeed = std::stof(Value);
+		else if (Arg == "--ball-max-speed") Options.Settings.BallMaxSpeed = std::stof(Value);
+		else if (Arg == "--ball-speed-increment") Options.Settings.BallSpeedIncrement = std::stof(Value);
+		else if (Arg == "--win-score") Options.Settings.WinScore = std::stoi(Value);
+		else if (Arg == "--ai-delay") Options.AIReactionDelay = std::stof(Value);
+		else if (Arg == "--ai-error") Options.AIError = std::stof(Value);
+		else
+		{
+			std::cout << "Unknown option " << Arg << "\n";
+			return false;
+		}
+	}
+
+	return true;
+}
+
+int main(int argc, char** argv)
+{
+	BatchOptions Options;
+	try
+	{
+		if (!ParseOptions(argc, argv, Options))
+		{
+			std::cout << "Usage: PONGBatch [--matches N] [--max-ticks N] [--threads N] [--seed N] [--output file] [--verify file]\n"
+				<< "                 [--player-speed X] [--ball-speed X] [--ball-max-speed X] [--ball-speed-increment X] [--win-score N]\n"
+				<< "                 [--ai-delay seconds] [--ai-error pixels]\n";
+			return -1;
+		}
+	} catch (const std::exception& Error)
+	{
+		std::cout << "Invalid option value: " << Error.what() << "\n";
+		return -1;
+	}
+
+	const int Threads = (Options.Threads > 0) ? Options.Threads : std::max(1u, std::thread::hardware_concurrency());
+
+	BatchWriter Writer(Options.Output);
+	if (!Writer.IsOpen())
+	{
+		std::cout << "Unable to open " << Options.Output << "\n";
+		return -1;
+	}
+
+	const Clock::Nanoseconds Start = Clock::Now();
+
+	std::atomic<int> NextMatch(0);
+	std::vector<std::thread> Workers;
+	Workers.reserve(Threads);
+	for (int i = 0; i < Threads; ++i)
+	{
+		Workers.emplace_back(RunWorker, std::cref(Options), std::ref(NextMatch), std::ref(Writer));
+	}
+
+	for (std::thread& Worker : Workers)
+	{
+		Worker.join();
+	}
+
+	Writer.Close();
+
+	const double Elapsed = static_cast<double>(Clock::Now() - Start) / Clock::NanosecondsPerSecond;
+	const double MatchesPerSecond = (Elapsed > 0.0) ? Writer.GetWritten() / Elapsed : 0.0;
+
+	std::cout << "Matches: " << Writer.GetWritten() << " on " << Threads << " threads in " << Elapsed << "s ("
+		<< MatchesPerSecond << " matches/s)\n";
+	std::cout << "Results written to " << Options.Output << "\n";
+
+	if (!Options.Verify.empty())
+	{
+		return VerifyResults(Options.Output, Options.Verify) ? 0 : 1;
+	}
+
+	return 0;
+}
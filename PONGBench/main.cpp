@@ -0,0 +1,986 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "BallKernel.h"
+#include "Game.h"
+#include "MatchSettings.h"
+#include "PaddleController.h"
+#include "Player.h"
+#include "Replay.h"
+#include "ServerProtocol.h"
+#include "SnapshotCodec.h"
+#include "StateChecksum.h"
+#include "pk/Clock.h"
+#include "Trajectory.h"
+#include "VectorEnv.h"
+#include "pk/BitStream.h"
+#include "pk/Random.h"
+
+// Micro benchmarks for the simulation hot paths.
+// Each benchmark also checks its fast path against the reference one and fails the run on mismatch.
+
+struct Benchmark
+{
+	std::string Name;
+	std::string Description;
+	std::function<bool()> Run;
+};
+
+double ElapsedSeconds(const Clock::Nanoseconds Start)
+{
+	return static_cast<double>(Clock::Now() - Start) / Clock::NanosecondsPerSecond;
+}
+
+namespace BallKernelBench
+{
+	constexpr int BALLS = 4099; // Not a multiple of any lane width, the scalar tail runs too
+	constexpr int TICKS = 2000;
+	constexpr int HIT_CHANCE = 2; // Percent of balls hitting a paddle each tick
+
+	struct BallSet
+	{
+		std::vector<float> X, Y, DirectionX, DirectionY, Speed;
+
+		BallKernel::BallArrays GetArrays()
+		{
+			return BallKernel::BallArrays{ X.data(), Y.data(), DirectionX.data(), DirectionY.data(), Speed.data() };
+		}
+
+		bool operator==(const BallSet& Other) const
+		{
+			const size_t Bytes = X.size() * sizeof(float);
+			return std::memcmp(X.data(), Other.X.data(), Bytes) == 0
+				&& std::memcmp(Y.data(), Other.Y.data(), Bytes) == 0
+				&& std::memcmp(DirectionX.data(), Other.DirectionX.data(), Bytes) == 0
+				&& std::memcmp(DirectionY.data(), Other.DirectionY.data(), Bytes) == 0
+				&& std::memcmp(Speed.data(), Other.Speed.data(), Bytes) == 0;
+		}
+	};
+
+	BallSet MakeBalls(const BallKernel::Params& Parameters, const uint32_t Seed)
+	{
+		Random Rng(Seed);
+
+		BallSet Balls;
+		for (int i = 0; i < BALLS; ++i)
+		{
+			Balls.X.push_back(Parameters.HalfWidth + 1.f + Rng.Range(static_cast<int>(Parameters.ArenaWidth - Parameters.HalfWidth * 2.f - 2.f)));
+			Balls.Y.push_back(Parameters.HalfHeight + 1.f + Rng.Range(static_cast<int>(Parameters.ArenaHeight - Parameters.HalfHeight * 2.f - 2.f)));
+			Balls.DirectionX.push_back((Rng.Range(2) == 0) ? -1.f : 1.f);
+			Balls.DirectionY.push_back((Rng.Range(2001) - 1000) / 1000.f);
+			Balls.Speed.push_back(Parameters.BaseSpeed + Rng.Range(static_cast<int>(Parameters.MaxSpeed - Parameters.BaseSpeed)));
+		}
+
+		return Balls;
+	}
+
+	// Same hit pattern for both paths, drawn ahead so the timing only covers the kernel
+	std::vector<uint8_t> MakeHits(const uint32_t Seed)
+	{
+		Random Rng(Seed);
+
+		std::vector<uint8_t> Hits(static_cast<size_t>(BALLS) * TICKS);
+		for (uint8_t& Hit : Hits)
+		{
+			Hit = (Rng.Range(100) < HIT_CHANCE) ? 1 : 0;
+		}
+
+		return Hits;
+	}
+
+	typedef void (*UpdateFunction)(const BallKernel::BallArrays&, uint8_t*, const int, const BallKernel::Params&);
+	typedef void (*IncrementFunction)(float*, const uint8_t*, const int, const BallKernel::Params&);
+
+	double Simulate(BallSet& Balls, const std::vector<uint8_t>& Hits, const BallKernel::Params& Parameters,
+		UpdateFunction Update, IncrementFunction Increment, std::vector<uint8_t>& Events)
+	{
+		const BallKernel::BallArrays Arrays = Balls.GetArrays();
+
+		const Clock::Nanoseconds Start = Clock::Now();
+		for (int Tick = 0; Tick < TICKS; ++Tick)
+		{
+			const size_t Offset = static_cast<size_t>(Tick) * BALLS;
+			Increment(Arrays.Speed, Hits.data() + Offset, BALLS, Parameters);
+			Update(Arrays, Events.data() + Offset, BALLS, Parameters);
+		}
+
+		return ElapsedSeconds(Start);
+	}
+
+	bool Run()
+	{
+		const MatchSettings Settings;
+
+		BallKernel::Params Parameters;
+		Parameters.ArenaWidth = static_cast<float>(Settings.ArenaSize.x);
+		Parameters.ArenaHeight = static_cast<float>(Settings.ArenaSize.y);
+		Parameters.CenterX = Parameters.ArenaWidth / 2.f;
+		Parameters.CenterY = Parameters.ArenaHeight / 2.f;
+		Parameters.HalfWidth = Settings.Ball.Size.x / 2.f;
+		Parameters.HalfHeight = Settings.Ball.Size.y / 2.f;
+		Parameters.BaseSpeed = Settings.BallSpeed;
+		Parameters.SpeedIncrement = Settings.BallSpeedIncrement;
+		Parameters.MaxSpeed = Settings.BallMaxSpeed;
+		Parameters.Delta = 1.f / 240.f;
+
+		const std::vector<uint8_t> Hits = MakeHits(7);
+		BallSet ScalarBalls = MakeBalls(Parameters, 42);
+		BallSet SimdBalls = ScalarBalls;
+
+		std::vector<uint8_t> ScalarEvents(Hits.size());
+		std::vector<uint8_t> SimdEvents(Hits.size());
+
+		const double ScalarTime = Simulate(ScalarBalls, Hits, Parameters, BallKernel::UpdateScalar, BallKernel::IncrementSpeedScalar, ScalarEvents);
+		const double SimdTime = Simulate(SimdBalls, Hits, Parameters, BallKernel::Update, BallKernel::IncrementSpeed, SimdEvents);
+
+		const double Steps = static_cast<double>(BALLS) * TICKS;
+		std::cout << "  scalar:          " << Steps / ScalarTime / 1e6 << " M ball steps/s\n";
+		std::cout << "  " << BallKernel::GetInstructionSet() << ":" << std::string(16 - std::strlen(BallKernel::GetInstructionSet()), ' ')
+			<< Steps / SimdTime / 1e6 << " M ball steps/s (x" << ScalarTime / SimdTime << ")\n";
+
+		if (!(ScalarBalls == SimdBalls) || ScalarEvents != SimdEvents)
+		{
+			std::cout << "  MISMATCH: batched kernel diverged from the scalar reference\n";
+			return false;
+		}
+
+		std::cout << "  bit identical to the scalar reference after " << TICKS << " ticks\n";
+		return true;
+	}
+}
+
+namespace BallSweepBench
+{
+	// At 30 Hz a 3000 px/s ball moves 100 px a tick, fifteen times the paddle width
+	constexpr int TICK_RATE = 30;
+	constexpr float FAST_SPEED = 3000.f;
+	constexpr float CONTACT_TOLERANCE = 0.1f;
+
+	std::unique_ptr<Game> MakeGame()
+	{
+		MatchSettings Settings;
+		Settings.BallSpeed = FAST_SPEED;
+		Settings.BallMaxSpeed = FAST_SPEED;
+
+		std::unique_ptr<Game> g = std::make_unique<Game>(Settings);
+		g->SetEffectsEnabled(false);
+		g->SetTickRate(TICK_RATE);
+		g->SetController(true, std::make_shared<ScriptedController>());
+		g->SetController(false, std::make_shared<ScriptedController>());
+		g->Begin();
+		g->StartMatch();
+		return g;
+	}
+
+	// Moves paddle one and the ball, the rest of the match stays as it started
+	void Place(Game& g, const glm::vec2& PaddleLocation, const glm::vec2& BallLocation, const glm::vec2& Direction)
+	{
+		GameKeyframe Keyframe;
+		g.CaptureKeyframe(Keyframe);
+		Keyframe.PlayerOneLocation[0] = PaddleLocation.x;
+		Keyframe.PlayerOneLocation[1] = PaddleLocation.y;
+		Keyframe.BallLocation[0] = BallLocation.x;
+		Keyframe.BallLocation[1] = BallLocation.y;
+		Keyframe.BallDirection[0] = Direction.x;
+		Keyframe.BallDirection[1] = Direction.y;
+		Keyframe.BallSpeed = FAST_SPEED;
+		g.RestoreKeyframe(Keyframe);
+	}
+
+	bool Expect(const bool bCondition, const std::string& What)
+	{
+		if (!bCondition)
+		{
+			std::cout << "  MISMATCH: " << What << "\n";
+		}
+		return bCondition;
+	}
+
+	// Where the ball touched the paddle, recovered from the heading Ball::Bounce gave it
+	float GetContactY(const Game& g)
+	{
+		const BoundingBox Box = g.GetPlayerOne().GetBoundingBox();
+		return g.GetPlayerOne().GetLocation().y + g.GetBall().GetDirection().y * Box.ScaleOffset.y;
+	}
+
+	// Head on at the paddle, the contact lies 60 px into a 100 px step
+	bool PaddleHit()
+	{
+		std::unique_ptr<Game> g = MakeGame();
+		const glm::vec2 HalfBall = glm::vec2(g->GetBall().GetSize()) / 2.f;
+		const glm::vec2 PaddleLocation(50.f, 300.f);
+		Place(*g, PaddleLocation, glm::vec2(0.f), glm::vec2(-1.f, 0.f));
+
+		const BoundingBox Box = g->GetPlayerOne().GetBoundingBox();
+		const float ContactY = PaddleLocation.y + 20.f;
+		Place(*g, PaddleLocation, glm::vec2(Box.Right() + HalfBall.x + 60.f, ContactY), glm::vec2(-1.f, 0.f));
+		g->Tick(g->GetTickDelta());
+
+		bool bSuccess = Expect(g->GetStats().CurrentRally == 1, "fast ball did not hit the paddle");
+		bSuccess = Expect(g->GetBall().GetDirection().x > 0.f, "fast ball did not turn back") && bSuccess;
+		bSuccess = Expect(std::abs(GetContactY(*g) - ContactY) < CONTACT_TOLERANCE, "fast ball touched the paddle at the wrong height") && bSuccess;
+		bSuccess = Expect(g->GetBall().GetLocation().x - HalfBall.x > Box.Right(), "fast ball ended inside or behind the paddle") && bSuccess;
+
+		std::cout << "  paddle hit:      contact y " << GetContactY(*g) << " (expected " << ContactY << ")\n";
+		return bSuccess;
+	}
+
+	// Diagonal into the bottom corner: the wall turns the ball 34 px into the step, the paddle catches it later
+	// in the same step. The paddle sits on the floor, so the ball leaves it shallow enough not to reach the floor again.
+	bool WallThenPaddleHit()
+	{
+		std::unique_ptr<Game> g = MakeGame();
+		const glm::vec2 HalfBall = glm::vec2(g->GetBall().GetSize()) / 2.f;
+		const float Floor = static_cast<float>(g->GetScreenHeight()) - HalfBall.y;
+		const glm::vec2 PaddleLocation(50.f, static_cast<float>(g->GetScreenHeight()) - g->GetPlayerOne().GetSize().y / 2.f);
+		Place(*g, PaddleLocation, glm::vec2(0.f), glm::vec2(-1.f, 0.f));
+
+		const BoundingBox Box = g->GetPlayerOne().GetBoundingBox();
+		const glm::vec2 Start(Box.Right() + HalfBall.x + 50.f, Floor - 34.f);
+		Place(*g, PaddleLocation, Start, glm::vec2(-1.f, 1.f));
+		g->Tick(g->GetTickDelta());
+
+		// 34 px to the floor, the remaining 16 px to the paddle face are climbed back up
+		const float ContactY = Floor - 16.f;
+
+		bool bSuccess = Expect(g->GetStats().CurrentRally == 1, "ball bouncing off the wall did not hit the paddle in the same step");
+		bSuccess = Expect(g->GetBall().GetDirection().x > 0.f, "ball did not turn back from the paddle") && bSuccess;
+		bSuccess = Expect(std::abs(GetContactY(*g) - ContactY) < CONTACT_TOLERANCE, "ball touched the paddle at the wrong height") && bSuccess;
+		bSuccess = Expect(g->GetBall().GetLocation().y <= Floor, "ball left the arena through the floor") && bSuccess;
+
+		std::cout << "  wall and paddle: contact y " << GetContactY(*g) << " (expected " << ContactY << ")\n";
+		return bSuccess;
+	}
+
+	bool Run()
+	{
+		const bool bPaddle = PaddleHit();
+		const bool bWallThenPaddle = WallThenPaddleHit();
+		return bPaddle && bWallThenPaddle;
+	}
+}
+
+namespace InterceptBench
+{
+	constexpr int BALLS = 100000;
+	constexpr float TARGET_X = 750.f;
+	constexpr float TOLERANCE = 0.05f;
+
+	// Walks the flight wall by wall, cost grows with the number of reflections
+	Trajectory::Intercept Reference(const Trajectory::BallState& State, const float TargetX, const Trajectory::Bounds& Limits)
+	{
+		Trajectory::Intercept Result;
+
+		const glm::vec2 Velocity = glm::normalize(State.Direction) * State.Speed;
+		if (Velocity.x == 0.f || (TargetX - State.Location.x) / Velocity.x < 0.f)
+		{
+			return Result;
+		}
+
+		// Double precision, so the reference does not drift over many reflections
+		const double TotalTime = (TargetX - State.Location.x) / static_cast<double>(Velocity.x);
+		double Y = State.Location.y;
+		double VelocityY = Velocity.y;
+		double Time = 0.0;
+		while (true)
+		{
+			const double Wall = (VelocityY > 0.0) ? Limits.MaxY : Limits.MinY;
+			const double ToWall = (VelocityY != 0.0) ? (Wall - Y) / VelocityY : TotalTime;
+			if (Time + ToWall >= TotalTime)
+			{
+				Y += VelocityY * (TotalTime - Time);
+				break;
+			}
+
+			Time += ToWall;
+			Y = Wall;
+			VelocityY = -VelocityY;
+			Result.Bounces++;
+		}
+
+		Result.bReaches = true;
+		Result.Y = static_cast<float>(Y);
+		Result.Time = static_cast<float>(TotalTime);
+		return Result;
+	}
+
+	bool Run()
+	{
+		const MatchSettings Settings;
+		const Trajectory::Bounds Limits = Trajectory::MakeBounds(static_cast<float>(Settings.ArenaSize.y), Settings.Ball.Size.y / 2.f);
+
+		Random Rng(3);
+		std::vector<Trajectory::BallState> States(BALLS);
+		std::vector<float> X(BALLS), Y(BALLS), DirectionX(BALLS), DirectionY(BALLS), Speed(BALLS);
+		for (int i = 0; i < BALLS; ++i)
+		{
+			Trajectory::BallState& State = States[i];
+			State.Location = glm::vec2(static_cast<float>(10 + Rng.Range(400)), Limits.MinY + Rng.Range(static_cast<int>(Limits.MaxY - Limits.MinY)));
+			// Steep directions bounce many times before reaching the target
+			State.Direction = glm::vec2((Rng.Range(2) == 0) ? 1.f : -1.f, (Rng.Range(200001) - 100000) / 1000.f);
+			State.Speed = static_cast<float>(300 + Rng.Range(300));
+
+			X[i] = State.Location.x;
+			Y[i] = State.Location.y;
+			DirectionX[i] = State.Direction.x;
+			DirectionY[i] = State.Direction.y;
+			Speed[i] = State.Speed;
+		}
+
+		std::vector<Trajectory::Intercept> References(BALLS);
+		std::vector<Trajectory::Intercept> Singles(BALLS);
+		std::vector<Trajectory::Intercept> Batch(BALLS);
+
+		Clock::Nanoseconds Start = Clock::Now();
+		for (int i = 0; i < BALLS; ++i)
+		{
+			References[i] = Reference(States[i], TARGET_X, Limits);
+		}
+		const double ReferenceTime = ElapsedSeconds(Start);
+
+		Start = Clock::Now();
+		for (int i = 0; i < BALLS; ++i)
+		{
+			Singles[i] = Trajectory::Predict(States[i], TARGET_X, Limits);
+		}
+		const double SingleTime = ElapsedSeconds(Start);
+
+		const BallKernel::BallArrays Arrays{ X.data(), Y.data(), DirectionX.data(), DirectionY.data(), Speed.data() };
+		Start = Clock::Now();
+		Trajectory::Predict(Arrays, BALLS, TARGET_X, Limits, Batch.data());
+		const double BatchTime = ElapsedSeconds(Start);
+
+		long long TotalBounces = 0;
+		int Mismatches = 0;
+		for (int i = 0; i < BALLS; ++i)
+		{
+			TotalBounces += References[i].Bounces;
+
+			const bool bSame = References[i].bReaches == Singles[i].bReaches && References[i].Bounces == Singles[i].Bounces
+				&& std::abs(References[i].Y - Singles[i].Y) <= TOLERANCE
+				&& Singles[i].bReaches == Batch[i].bReaches && Singles[i].Y == Batch[i].Y && Singles[i].Time == Batch[i].Time;
+			Mismatches += bSame ? 0 : 1;
+		}
+
+		std::cout << "  wall by wall:    " << BALLS / ReferenceTime / 1e6 << " M queries/s (" << static_cast<double>(TotalBounces) / BALLS << " bounces per query)\n";
+		std::cout << "  closed form:     " << BALLS / SingleTime / 1e6 << " M queries/s\n";
+		std::cout << "  closed form SoA: " << BALLS / BatchTime / 1e6 << " M queries/s\n";
+
+		if (Mismatches > 0)
+		{
+			std::cout << "  MISMATCH: " << Mismatches << " predictions differ from the wall by wall reference\n";
+			return false;
+		}
+
+		std::cout << "  all predictions within " << TOLERANCE << " px of the wall by wall reference\n";
+		return true;
+	}
+}
+
+namespace ControllerBench
+{
+	constexpr int DECISIONS = 10000000;
+	constexpr int DECISIONS_PER_TICK = 1000; // The game moves on every so often, so plans get invalidated
+	constexpr int MATCH_TICKS = 240 * 60 * 5;
+	constexpr float REACTION_DELAY = 0.15f;
+	constexpr float ERROR = 60.f;
+
+	std::unique_ptr<Game> MakeGame(const bool bWithAI)
+	{
+		std::unique_ptr<Game> g = std::make_unique<Game>(MatchSettings());
+		g->SetEffectsEnabled(false);
+		if (bWithAI)
+		{
+			g->SetController(true, std::make_shared<AIController>(REACTION_DELAY, ERROR, 1));
+			g->SetController(false, std::make_shared<AIController>(REACTION_DELAY, ERROR, 2));
+		}
+		g->Begin();
+		g->StartMatch();
+		return g;
+	}
+
+	// Plays for a fixed amount of ticks, starting a new match whenever one ends
+	double PlayTicks(Game& g)
+	{
+		const float Delta = g.GetTickDelta();
+		const Clock::Nanoseconds Start = Clock::Now();
+		for (int Tick = 0; Tick < MATCH_TICKS; ++Tick)
+		{
+			if (g.GetState() != GameState::MATCH)
+			{
+				g.Restart();
+				g.StartMatch();
+			}
+			g.Tick(Delta);
+		}
+		return ElapsedSeconds(Start);
+	}
+
+	bool Run()
+	{
+		std::unique_ptr<Game> g = MakeGame(true);
+		AIController Controller(REACTION_DELAY, ERROR, 3);
+
+		const float Delta = g->GetTickDelta();
+		int Moves = 0;
+		const Clock::Nanoseconds Start = Clock::Now();
+		for (int i = 0; i < DECISIONS; ++i)
+		{
+			if (i % DECISIONS_PER_TICK == 0)
+			{
+				g->Tick(Delta);
+			}
+			Moves += (Controller.Decide(g->GetPlayerOne(), *g, Delta) != PaddleCommand::HOLD) ? 1 : 0;
+		}
+		const double DecideTime = ElapsedSeconds(Start);
+
+		// Same simulation with and without AI paddles, the difference is what the decisions cost
+		std::unique_ptr<Game> Idle = MakeGame(false);
+		const double IdleTime = PlayTicks(*Idle);
+		const double AITime = PlayTicks(*g);
+
+		std::cout << "  decisions:       " << DECISIONS / DecideTime / 1e6 << " M decisions/s (" << 100.0 * Moves / DECISIONS << "% moves)\n";
+		std::cout << "  ticks, no AI:    " << MATCH_TICKS / IdleTime / 1e6 << " M ticks/s\n";
+		std::cout << "  ticks, AI:       " << MATCH_TICKS / AITime / 1e6 << " M ticks/s\n";
+		return true;
+	}
+}
+
+namespace ReplaySeekBench
+{
+	constexpr int REPLAY_TICKS = 240 * 60 * 60; // One hour at the default tick rate
+	constexpr int SEEKS = 200;
+	const int KEYFRAME_INTERVALS[] = { 60, 240, 1200, 4800 };
+	const std::string REPLAY_PATH = "pongbench_replay.bin";
+
+	void Record(const int KeyframeInterval)
+	{
+		const MatchSettings Settings;
+
+		Game g(Settings);
+		g.SetSeed(11);
+		g.SetEffectsEnabled(false);
+		g.SetController(true, std::make_shared<AIController>(0.15f, 60.f, 1));
+		g.SetController(false, std::make_shared<AIController>(0.15f, 60.f, 2));
+
+		ReplayRecorder Recorder(REPLAY_PATH, Settings, g, KeyframeInterval, false);
+		g.SetRecorder(&Recorder);
+		g.Begin();
+		g.StartMatch();
+
+		// Back to back matches, like a long play session
+		for (int Tick = 0; Tick < REPLAY_TICKS; ++Tick)
+		{
+			if (g.GetState() != GameState::MATCH)
+			{
+				g.StartMatch();
+			}
+			g.Tick(g.GetTickDelta());
+		}
+
+		Recorder.Close(g);
+	}
+
+	bool Run()
+	{
+		Random Rng(5);
+		std::vector<int> Targets(SEEKS);
+		for (int& Target : Targets)
+		{
+			Target = Rng.Range(REPLAY_TICKS + 1);
+		}
+		std::sort(Targets.begin(), Targets.end());
+
+		bool bSuccess = true;
+		for (const int Interval : KEYFRAME_INTERVALS)
+		{
+			Record(Interval);
+			const Replay::SharedPtr Data = std::make_shared<Replay>(REPLAY_PATH);
+
+			// Reference states from one linear playback
+			std::vector<GameKeyframe> Expected(SEEKS);
+			std::unique_ptr<Game> Linear = Replay::CreateGame(Data);
+			Linear->Begin();
+			Linear->StartMatch();
+			int Played = 0;
+			for (int i = 0; i < SEEKS; ++i)
+			{
+				for (; Played < Targets[i]; ++Played)
+				{
+					Replay::Step(*Linear);
+				}
+				Linear->CaptureKeyframe(Expected[i]);
+			}
+
+			std::unique_ptr<Game> Viewer = Replay::CreateGame(Data);
+			Viewer->Begin();
+			Viewer->StartMatch();
+
+			int Mismatches = 0;
+			double SeekTime = 0.0;
+			for (int i = SEEKS - 1; i >= 0; --i)
+			{
+				const Clock::Nanoseconds Start = Clock::Now();
+				Data->Seek(*Viewer, Targets[i]);
+				SeekTime += ElapsedSeconds(Start);
+
+				GameKeyframe Actual;
+				Viewer->CaptureKeyframe(Actual);
+				Mismatches += (std::memcmp(&Actual, &Expected[i], sizeof(GameKeyframe)) == 0) ? 0 : 1;
+			}
+
+			std::ifstream File(REPLAY_PATH, std::ios::binary | std::ios::ate);
+			std::cout << "  interval " << Interval << ":" << std::string(8 - std::to_string(Interval).size(), ' ')
+				<< File.tellg() / 1024 << " KB, " << SeekTime / SEEKS * 1e6 << " us per seek\n";
+
+			if (Mismatches > 0)
+			{
+				std::cout << "  MISMATCH: " << Mismatches << " seeks differ from linear playback\n";
+				bSuccess = false;
+			}
+		}
+
+		std::remove(REPLAY_PATH.c_str());
+
+		if (bSuccess)
+		{
+			std::cout << "  every seek matches linear playback of the hour long replay\n";
+		}
+		return bSuccess;
+	}
+}
+
+namespace ChecksumBench
+{
+	constexpr int UPDATES = 10000000;
+	constexpr int UPDATES_PER_TICK = 100;
+
+	bool Run()
+	{
+		Game g{ MatchSettings() };
+		g.SetController(true, std::make_shared<AIController>(0.15f, 60.f, 1));
+		g.SetController(false, std::make_shared<AIController>(0.15f, 60.f, 2));
+		g.Begin();
+		g.StartMatch();
+
+		uint64_t Checksum = 0;
+		const Clock::Nanoseconds Start = Clock::Now();
+		for (int i = 0; i < UPDATES; ++i)
+		{
+			if (i % UPDATES_PER_TICK == 0)
+			{
+				g.Tick(g.GetTickDelta());
+			}
+			Checksum = StateChecksum::Update(Checksum, g);
+		}
+		const double Elapsed = ElapsedSeconds(Start);
+
+		std::cout << "  update:          " << Elapsed / UPDATES * 1e9 << " ns per tick (checksum " << std::hex << Checksum << std::dec << ")\n";
+		return true;
+	}
+}
+
+namespace SnapshotBench
+{
+	constexpr int WARMUP_TICKS = 2000;
+	constexpr int COPIES = 20000;
+	constexpr int CONTINUE_TICKS = 3000;
+
+	// Stateless, so a restored game gets the same commands as the original did
+	class FollowController : public PaddleController
+	{
+	public:
+		virtual PaddleCommand Decide(const Player& Paddle, const Game& CurrentGame, const float Delta) override
+		{
+			const float Difference = CurrentGame.GetBall().GetLocation().y - Paddle.GetLocation().y;
+			if (std::abs(Difference) < 20.f)
+			{
+				return PaddleCommand::HOLD;
+			}
+			return (Difference < 0.f) ? PaddleCommand::UP : PaddleCommand::DOWN;
+		}
+	};
+
+	void PlayTicks(Game& g, const int Ticks)
+	{
+		for (int Tick = 0; Tick < Ticks; ++Tick)
+		{
+			if (g.GetState() != GameState::MATCH)
+			{
+				g.StartMatch();
+			}
+			g.Tick(g.GetTickDelta());
+		}
+	}
+
+	bool Measure(const bool bEffects)
+	{
+		Game g{ MatchSettings() };
+		g.SetSeed(3);
+		g.SetEffectsEnabled(bEffects);
+		g.SetController(true, std::make_shared<FollowController>());
+		g.SetController(false, std::make_shared<FollowController>());
+		g.Begin();
+		g.StartMatch();
+		PlayTicks(g, WARMUP_TICKS);
+
+		// Value initialized, pools skipped without effects still compare equal
+		std::unique_ptr<GameSnapshot> Saved = std::make_unique<GameSnapshot>();
+		std::unique_ptr<GameSnapshot> Expected = std::make_unique<GameSnapshot>();
+		std::unique_ptr<GameSnapshot> Actual = std::make_unique<GameSnapshot>();
+
+		Clock::Nanoseconds Start = Clock::Now();
+		for (int i = 0; i < COPIES; ++i)
+		{
+			g.SaveState(*Saved);
+		}
+		const double SaveTime = ElapsedSeconds(Start);
+
+		Start = Clock::Now();
+		for (int i = 0; i < COPIES; ++i)
+		{
+			g.RestoreState(*Saved);
+		}
+		const double RestoreTime = ElapsedSeconds(Start);
+
+		PlayTicks(g, CONTINUE_TICKS);
+		g.SaveState(*Expected);
+
+		g.RestoreState(*Saved);
+		PlayTicks(g, CONTINUE_TICKS);
+		g.SaveState(*Actual);
+
+		const double RoundTrip = (SaveTime + RestoreTime) / COPIES;
+		std::cout << "  " << (bEffects ? "effects:    " : "no effects: ") << sizeof(GameSnapshot) / 1024 << " KB, save "
+			<< SaveTime / COPIES * 1e6 << " us, restore " << RestoreTime / COPIES * 1e6 << " us, "
+			<< static_cast<int>(1.0 / 60.0 / RoundTrip) << " round trips per 60 Hz frame\n";
+
+		if (std::memcmp(Expected.get(), Actual.get(), sizeof(GameSnapshot)) != 0)
+		{
+			std::cout << "  MISMATCH: restored game diverged within " << CONTINUE_TICKS << " ticks\n";
+			return false;
+		}
+		return true;
+	}
+
+	bool Run()
+	{
+		const bool bSuccess = Measure(false) && Measure(true);
+		if (bSuccess)
+		{
+			std::cout << "  restored games continue bit for bit, particles included\n";
+		}
+		return bSuccess;
+	}
+}
+
+namespace SnapshotCodecBench
+{
+	constexpr int TICKS = 60000;
+	// Snapshots still in flight when the receiver's acknowledgement arrives, about 30 ms at 240 Hz
+	constexpr int ACK_DELAY = 2;
+	constexpr int REPEATS = 20;
+	constexpr int MAX_ENCODED = 64;
+	// Float rounding on top of the quantization step
+	constexpr float EPSILON = 1e-4f;
+
+	std::vector<ServerProtocol::Snapshot> Record(const int Interval)
+	{
+		Game g{ MatchSettings() };
+		g.SetSeed(5);
+		g.SetEffectsEnabled(false);
+		g.SetController(true, std::make_shared<SnapshotBench::FollowController>());
+		g.SetController(false, std::make_shared<SnapshotBench::FollowController>());
+		g.Begin();
+
+		std::vector<ServerProtocol::Snapshot> Snapshots;
+		for (int Tick = 0; Tick < TICKS; ++Tick)
+		{
+			if (g.GetState() != GameState::MATCH)
+			{
+				g.StartMatch();
+			}
+			g.Tick(g.GetTickDelta());
+
+			if (Tick % Interval == 0)
+			{
+				Snapshots.push_back(ServerProtocol::Capture(g, static_cast<uint32_t>(Tick), static_cast<uint32_t>(Tick / 2)));
+			}
+		}
+		return Snapshots;
+	}
+
+	bool WithinTolerance(const ServerProtocol::Snapshot& Source, const ServerProtocol::Snapshot& Decoded)
+	{
+		const glm::vec2 Heading = glm::normalize(glm::vec2(Source.BallDirectionX, Source.BallDirectionY));
+		const float Cross = Heading.x * Decoded.BallDirectionY - Heading.y * Decoded.BallDirectionX;
+		const float Dot = Heading.x * Decoded.BallDirectionX + Heading.y * Decoded.BallDirectionY;
+
+		return Source.Tick == Decoded.Tick && Source.ProcessedInputs == Decoded.ProcessedInputs && Source.State == Decoded.State
+			&& Source.PlayerOneScore == Decoded.PlayerOneScore && Source.PlayerTwoScore == Decoded.PlayerTwoScore && Source.Rallies == Decoded.Rallies
+			&& std::abs(Source.PlayerOneY - Decoded.PlayerOneY) <= SnapshotCodec::POSITION_TOLERANCE + EPSILON
+			&& std::abs(Source.PlayerTwoY - Decoded.PlayerTwoY) <= SnapshotCodec::POSITION_TOLERANCE + EPSILON
+			&& std::abs(Source.BallX - Decoded.BallX) <= SnapshotCodec::POSITION_TOLERANCE + EPSILON
+			&& std::abs(Source.BallY - Decoded.BallY) <= SnapshotCodec::POSITION_TOLERANCE + EPSILON
+			&& std::abs(std::atan2(Cross, Dot)) <= SnapshotCodec::HEADING_TOLERANCE + EPSILON
+			&& std::abs(Source.BallSpeed - Decoded.BallSpeed) <= SnapshotCodec::SPEED_TOLERANCE + EPSILON;
+	}
+
+	bool Measure(const int Interval)
+	{
+		const std::vector<ServerProtocol::Snapshot> Source = Record(Interval);
+		const SnapshotCodec Codec{ MatchSettings() };
+		const size_t Count = Source.size();
+
+		std::vector<uint8_t> Encoded(Count * MAX_ENCODED);
+		std::vector<int> Sizes(Count);
+		uint64_t EncodedBytes = 0;
+
+		// The receiver acknowledges every snapshot, each one is encoded against the newest acknowledgement the sender has
+		Clock::Nanoseconds Start = Clock::Now();
+		for (int Repeat = 0; Repeat < REPEATS; ++Repeat)
+		{
+			SnapshotHistory Sent;
+			EncodedBytes = 0;
+			for (size_t i = 0; i < Count; ++i)
+			{
+				QuantizedSnapshot State = Codec.Quantize(Source[i]);
+				State.Sequence = static_cast<uint32_t>(i + 1);
+				const QuantizedSnapshot* Baseline = (i >= ACK_DELAY) ? Sent.Find(State.Sequence - ACK_DELAY) : nullptr;
+
+				BitWriter Writer(&Encoded[i * MAX_ENCODED], MAX_ENCODED);
+				Codec.Encode(Writer, State, Baseline);
+				Sent.Store(State);
+				Sizes[i] = Writer.GetSize();
+				EncodedBytes += Writer.GetSize();
+			}
+		}
+		const double EncodeTime = ElapsedSeconds(Start);
+
+		std::vector<ServerProtocol::Snapshot> Decoded(Count);
+		bool bDecoded = true;
+		Start = Clock::Now();
+		for (int Repeat = 0; Repeat < REPEATS; ++Repeat)
+		{
+			SnapshotHistory Received;
+			for (size_t i = 0; i < Count; ++i)
+			{
+				BitReader Reader(&Encoded[i * MAX_ENCODED], Sizes[i]);
+				QuantizedSnapshot State;
+				bDecoded = Codec.Decode(Reader, Received, State) && bDecoded;
+				Received.Store(State);
+				Decoded[i] = Codec.Dequantize(State);
+			}
+		}
+		const double DecodeTime = ElapsedSeconds(Start);
+
+		uint8_t Raw[ServerProtocol::MAX_DATAGRAM];
+		ByteWriter RawWriter(Raw, sizeof(Raw));
+		ServerProtocol::Write(RawWriter, Source[0]);
+
+		std::cout << "  every " << Interval << (Interval == 1 ? " tick:  " : " ticks: ") << static_cast<double>(EncodedBytes) / Count
+			<< " bytes per snapshot (full " << (Codec.GetFullBits() + 7) / 8 << ", raw " << RawWriter.GetSize() << "), encode "
+			<< Count * REPEATS / EncodeTime / 1e6 << " M/s, decode " << Count * REPEATS / DecodeTime / 1e6 << " M/s\n";
+
+		for (size_t i = 0; i < Count; ++i)
+		{
+			if (!bDecoded || !WithinTolerance(Source[i], Decoded[i]))
+			{
+				std::cout << "  MISMATCH: snapshot " << i << " decoded outside of the tolerance\n";
+				return false;
+			}
+		}
+		return true;
+	}
+
+	bool Run()
+	{
+		const bool bSuccess = Measure(1) && Measure(4);
+		if (bSuccess)
+		{
+			std::cout << "  decoded within " << SnapshotCodec::POSITION_TOLERANCE << " px, " << SnapshotCodec::HEADING_TOLERANCE
+				<< " rad and " << SnapshotCodec::SPEED_TOLERANCE << " px/s of the source\n";
+		}
+		return bSuccess;
+	}
+}
+
+namespace VectorEnvBench
+{
+	constexpr int ENVS = 4096;
+	constexpr int STEPS = 1000;
+	constexpr float REACTION_DELAY = 0.15f;
+	constexpr float ERROR = 60.f;
+	// Observations are normalized by the arena height
+	constexpr float FOLLOW_DEAD_ZONE = 0.02f;
+
+	// Stand-in for a policy: follow the ball with the agent paddle
+	void Act(const VectorEnv::StepResult& Result, std::vector<PaddleCommand>& Actions)
+	{
+		for (size_t i = 0; i < Actions.size(); ++i)
+		{
+			const float* Observation = Result.Observations + i * VectorEnv::ObservationSize;
+			const float Difference = Observation[1] - Observation[5];
+			if (std::abs(Difference) < FOLLOW_DEAD_ZONE)
+			{
+				Actions[i] = PaddleCommand::HOLD;
+				continue;
+			}
+			Actions[i] = (Difference < 0.f) ? PaddleCommand::UP : PaddleCommand::DOWN;
+		}
+	}
+
+	// FNV-1a over the raw bytes of every step result
+	uint64_t HashResult(uint64_t Hash, const VectorEnv::StepResult& Result)
+	{
+		const auto Mix = [&Hash](const void* Data, const size_t Size)
+		{
+			const uint8_t* Bytes = static_cast<const uint8_t*>(Data);
+			for (size_t i = 0; i < Size; ++i)
+			{
+				Hash = (Hash ^ Bytes[i]) * 1099511628211ull;
+			}
+		};
+
+		Mix(Result.Observations, ENVS * VectorEnv::ObservationSize * sizeof(float));
+		Mix(Result.Rewards, ENVS * sizeof(float));
+		Mix(Result.Dones, ENVS * sizeof(uint8_t));
+		return Hash;
+	}
+
+	uint64_t PlayEpisode(VectorEnv& Env, const std::vector<uint32_t>& Seeds, double& Seconds)
+	{
+		std::vector<PaddleCommand> Actions(ENVS, PaddleCommand::HOLD);
+		VectorEnv::StepResult Result = Env.Reset(Seeds.data());
+		uint64_t Hash = HashResult(14695981039346656037ull, Result);
+
+		double Elapsed = 0.0;
+		for (int Step = 0; Step < STEPS; ++Step)
+		{
+			Act(Result, Actions);
+
+			const Clock::Nanoseconds Start = Clock::Now();
+			Result = Env.Step(Actions.data());
+			Elapsed += ElapsedSeconds(Start);
+
+			Hash = HashResult(Hash, Result);
+		}
+
+		Seconds = Elapsed;
+		return Hash;
+	}
+
+	bool Run()
+	{
+		VectorEnv Env(ENVS, MatchSettings(), [](const int EnvIndex)
+		{
+			return std::make_shared<AIController>(REACTION_DELAY, ERROR, static_cast<uint32_t>(EnvIndex));
+		});
+
+		std::vector<uint32_t> Seeds(ENVS);
+		for (int i = 0; i < ENVS; ++i)
+		{
+			Seeds[i] = static_cast<uint32_t>(i) * 2654435761u + 1;
+		}
+
+		double FirstTime = 0.0;
+		double SecondTime = 0.0;
+		const uint64_t First = PlayEpisode(Env, Seeds, FirstTime);
+		const uint64_t Second = PlayEpisode(Env, Seeds, SecondTime);
+
+		// Different seeds must give different serves, or every environment plays the same game
+		const VectorEnv::StepResult Initial = Env.Reset(Seeds.data());
+		int DistinctFromFirst = 0;
+		for (int i = 1; i < ENVS; ++i)
+		{
+			const float* Observation = Initial.Observations + i * VectorEnv::ObservationSize;
+			const bool bSameServe = Observation[2] == Initial.Observations[2] && Observation[3] == Initial.Observations[3];
+			DistinctFromFirst += bSameServe ? 0 : 1;
+		}
+
+		const double StepsPerSecond = static_cast<double>(ENVS) * STEPS * 2 / (FirstTime + SecondTime);
+		std::cout << "  step:            " << StepsPerSecond / 1e6 << " M env-steps/s over " << ENVS << " envs\n";
+		std::cout << "  serves:          " << DistinctFromFirst << " of " << ENVS - 1 << " envs serve unlike env 0\n";
+
+		bool bSuccess = true;
+		if (First != Second)
+		{
+			std::cout << "  MISMATCH: reset with the same seeds played a different run\n";
+			bSuccess = false;
+		}
+		if (DistinctFromFirst == 0)
+		{
+			std::cout << "  MISMATCH: seeds do not change the serve\n";
+			bSuccess = false;
+		}
+		return bSuccess;
+	}
+}
+
+std::vector<Benchmark> GetBenchmarks()
+{
+	return {
+		{ "ball-kernel", "Scalar vs SIMD structure-of-arrays ball update", BallKernelBench::Run },
+		{ "ball-sweep", "Swept ball against a paddle at 3000 px/s and 30 Hz, alone and after a wall bounce", BallSweepBench::Run },
+		{ "intercept", "Closed form intercept prediction vs wall by wall stepping", InterceptBench::Run },
+		{ "controller", "AI paddle decisions per second and their share of a tick", ControllerBench::Run },
+		{ "checksum", "Cost of the rolling state checksum of one tick", ChecksumBench::Run },
+		{ "replay-seek", "Seek time in an hour long replay for several keyframe intervals", ReplaySeekBench::Run },
+		{ "snapshot", "Save and restore of the full simulation state", SnapshotBench::Run },
+		{ "snapshot-codec", "Quantized delta snapshot encoding against an acknowledged baseline", SnapshotCodecBench::Run },
+		{ "vector-env", "Batched env-steps per second over 4096 environments, reproducible from their seeds", VectorEnvBench::Run },
+	};
+}
+
+int main(int argc, char** argv)
+{
+	const std::vector<Benchmark> Benchmarks = GetBenchmarks();
+
+	std::vector<std::string> Selected;
+	for (int i = 1; i < argc; ++i)
+	{
+		const std::string Arg(argv[i]);
+		if (Arg == "--list")
+		{
+			for (const Benchmark& Entry : Benchmarks)
+			{
+				std::cout << Entry.Name << "\t" << Entry.Description << "\n";
+			}
+			return 0;
+		}
+
+		Selected.push_back(Arg);
+	}
+
+	bool bSuccess = true;
+	int Ran = 0;
+	for (const Benchmark& Entry : Benchmarks)
+	{
+		const bool bRequested = Selected.empty() || std::find(Selected.begin(), Selected.end(), Entry.Name) != Selected.end();
+		if (!bRequested)
+		{
+			continue;
+		}
+
+		std::cout << Entry.Name << "\n";
+		bSuccess = Entry.Run() && bSuccess;
+		Ran++;
+	}
+
+	if (Ran == 0)
+	{
+		std::cout << "Usage: PONGBench [--list] [benchmark ...]\n";
+		return -1;
+	}
+
+	return bSuccess ? 0 : 1;
+}
@@ -0,0 +1,429 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "MatchClient.h"
+#include "MatchServer.h"
+#include "MatchSettings.h"
+#include "PaddleController.h"
+#include "SpectatorServer.h"
+#include "pk/Clock.h"
+#include "pk/LatencyHistogram.h"
+#include "pk/SocketPoller.h"
+#include "pk/UdpSocket.h"
+
+// Dedicated match server: many authoritative matches ticked from one thread.
+// The same executable runs bot clients and spectators against it, to check a server on loopback.
+
+constexpr uint16_t DEFAULT_PORT = 7777;
+constexpr int DEFAULT_MATCHES = 256;
+constexpr int DEFAULT_TICK_RATE = 240;
+constexpr int DEFAULT_SNAPSHOT_INTERVAL = 4;
+constexpr double REPORT_INTERVAL = 5.0;
+constexpr double BOTS_TIMEOUT = 600.0;
+constexpr float BOT_REACTION_DELAY = 0.15f;
+constexpr float BOT_ERROR = 60.f;
+constexpr int DEFAULT_MAX_SPECTATORS = 16384;
+constexpr double SUBSCRIBE_INTERVAL = 1.0;
+constexpr int SPECTATOR_RECEIVE_BUFFER = 64 * 1024;
+// Delivery latency histogram, in 10 us buckets up to a second
+constexpr Clock::Nanoseconds LATENCY_BUCKET = 10000;
+constexpr int LATENCY_BUCKETS = 100000;
+
+struct ServerOptions
+{
+	uint16_t Port = DEFAULT_PORT;
+	int Matches = DEFAULT_MATCHES;
+	int TickRate = DEFAULT_TICK_RATE;
+	int SnapshotInterval = DEFAULT_SNAPSHOT_INTERVAL;
+	double Duration = 0.0;
+	int Bots = 0;
+	uint16_t SpectatorPort = 0;
+	int MaxSpectators = DEFAULT_MAX_SPECTATORS;
+	int Spectators = 0;
+	int Watch = 1;
+	std::string Server = "127.0.0.1:7777";
+	int Latency = 0;
+	int Jitter = 0;
+	int Loss = 0;
+	MatchSettings Settings;
+};
+
+double ElapsedSeconds(const Clock::Nanoseconds Start)
+{
+	return static_cast<double>(Clock::Now() - Start) / Clock::NanosecondsPerSecond;
+}
+
+// Sleeps until the next tick is due, never more than one tick behind
+void WaitForTick(Clock::Nanoseconds& NextTick, const Clock::Nanoseconds TickDuration)
+{
+	const Clock::Nanoseconds Now = Clock::Now();
+	if (NextTick > Now)
+	{
+		std::this_thread::sleep_for(std::chrono::nanoseconds(NextTick - Now));
+	}
+	NextTick = std::max(NextTick + TickDuration, Now);
+}
+
+int RunServer(const ServerOptions& Options)
+{
+	UdpSocket Socket(Options.Port);
+	MatchServer Server(Socket, Options.Settings, Options.Matches, Options.TickRate, Options.SnapshotInterval);
+
+	std::cout << "Serving up to " << Options.Matches << " matches on port " << Socket.GetPort() << " at " << Options.TickRate << " ticks/s\n";
+
+	UdpSocket::UniquePtr SpectatorSocket;
+	std::unique_ptr<SpectatorServer> Spectators;
+	if (Options.SpectatorPort != 0)
+	{
+		SpectatorSocket = std::make_unique<UdpSocket>(Options.SpectatorPort);
+		Spectators = std::make_unique<SpectatorServer>(*SpectatorSocket, Options.MaxSpectators);
+		Server.SetSpectators(Spectators.get());
+		std::cout << "Broadcasting to up to " << Options.MaxSpectators << " spectators on port " << SpectatorSocket->GetPort() << "\n";
+	}
+
+	const Clock::Nanoseconds TickDuration = Clock::NanosecondsPerSecond / Options.TickRate;
+	const Clock::Nanoseconds Start = Clock::Now();
+	Clock::Nanoseconds NextTick = Start;
+	Clock::Nanoseconds LastReport = Start;
+	MatchServerStats Reported;
+	SpectatorStats ReportedSpectators;
+	uint64_t ServerTicks = 0;
+	uint64_t ReportedServerTicks = 0;
+
+	while (Options.Duration <= 0.0 || ElapsedSeconds(Start) < Options.Duration)
+	{
+		// Spectators are served while waiting and never past the tick, the sleep only covers the last millisecond
+		if (Spectators != nullptr)
+		{
+			Spectators->WaitUntil(NextTick);
+		}
+		WaitForTick(NextTick, TickDuration);
+		Server.Tick();
+		ServerTicks++;
+		if (Spectators != nullptr)
+		{
+			Spectators->Update();
+		}
+
+		for (const MatchResult& Result : Server.TakeResults())
+		{
+			std::cout << "Match " << Result.Match << " finished " << Result.PlayerOneScore << " - " << Result.PlayerTwoScore
+				<< " after " << Result.Ticks << " ticks\n";
+		}
+
+		const double SinceReport = ElapsedSeconds(LastReport);
+		if (SinceReport >= REPORT_INTERVAL)
+		{
+			const MatchServerStats& Stats = Server.GetStats();
+			const uint64_t MatchTicks = Stats.MatchTicks - Reported.MatchTicks;
+			const Clock::Nanoseconds Busy = Stats.TickTime - Reported.TickTime;
+
+			// Below the target the simulation itself is late, whatever else runs on this thread
+			std::cout << "Tick rate: " << (ServerTicks - ReportedServerTicks) / SinceReport << " of " << Options.TickRate << " ticks/s\n";
+			std::cout << "Active matches: " << Server.GetActiveMatches() << ", " << MatchTicks / SinceReport << " match ticks/s, "
+				<< ((MatchTicks > 0) ? static_cast<double>(Busy) / MatchTicks / 1000.0 : 0.0) << " us per match tick, "
+				<< 100.0 * Busy / (SinceReport * Clock::NanosecondsPerSecond) << "% of a core, slowest tick "
+				<< Clock::ToSeconds(Stats.MaxTickTime) * 1000.0 << " ms, inputs missed " << Stats.MissedInputs - Reported.MissedInputs
+				<< " skipped " << Stats.SkippedInputs - Reported.SkippedInputs << "\n";
+
+			if (Spectators != nullptr)
+			{
+				const SpectatorStats& Fanout = Spectators->GetStats();
+				const uint64_t Sent = Fanout.DatagramsSent - ReportedSpectators.DatagramsSent;
+				const Clock::Nanoseconds FanoutBusy = Fanout.PublishTime - ReportedSpectators.PublishTime + Fanout.FlushTime - ReportedSpectators.FlushTime;
+				std::cout << "Spectators: " << Spectators->GetSubscribers() << ", " << Sent / SinceReport << " datagrams/s, "
+					<< ((Sent > 0) ? static_cast<double>(FanoutBusy) / Sent : 0.0) << " ns per datagram, "
+					<< Fanout.SkippedFrames - ReportedSpectators.SkippedFrames << " frames skipped, "
+					<< Fanout.BlockedFlushes - ReportedSpectators.BlockedFlushes << " flushes blocked, "
+					<< Fanout.DeferredFlushes - ReportedSpectators.DeferredFlushes << " deferred to the next tick\n";
+				ReportedSpectators = Fanout;
+			}
+
+			Reported = Stats;
+			ReportedServerTicks = ServerTicks;
+			LastReport = Clock::Now();
+		}
+	}
+
+	const MatchServerStats& Stats = Server.GetStats();
+	std::cout << "Matches started " << Stats.MatchesStarted << ", finished " << Stats.MatchesFinished << ", abandoned " << Stats.MatchesAbandoned << "\n";
+	return 0;
+}
+
+int RunBots(const ServerOptions& Options)
+{
+	NetAddress Server;
+	if (!NetAddress::Parse(Options.Server, Server))
+	{
+		std::cout << "Invalid server address " << Options.Server << "\n";
+		return -1;
+	}
+
+	std::vector<UdpSocket::UniquePtr> Sockets;
+	std::vector<std::unique_ptr<MatchClient>> Bots;
+	for (int i = 0; i < Options.Bots; ++i)
+	{
+		Sockets.push_back(std::make_unique<UdpSocket>(0));
+		Sockets.back()->SetSimulatedLatency(Options.Latency * Clock::NanosecondsPerSecond / 1000, Options.Jitter * Clock::NanosecondsPerSecond / 1000);
+		Sockets.back()->SetSimulatedLoss(Options.Loss);
+
+		const PaddleController::SharedPtr Controller = std::make_shared<AIController>(BOT_REACTION_DELAY, BOT_ERROR, i + 1);
+		Bots.push_back(std::make_unique<MatchClient>(*Sockets.back(), Server, Options.Settings, Controller));
+	}
+
+	std::cout << Options.Bots << " bots joining " << Server.ToString() << "\n";
+
+	const Clock::Nanoseconds TickDuration = Clock::NanosecondsPerSecond / Options.TickRate;
+	const Clock::Nanoseconds Start = Clock::Now();
+	Clock::Nanoseconds NextTick = Start;
+	Clock::Nanoseconds Busy = 0;
+	uint64_t BotTicks = 0;
+
+	int Finished = 0;
+	while (Finished < Options.Bots && ElapsedSeconds(Start) < BOTS_TIMEOUT)
+	{
+		WaitForTick(NextTick, TickDuration);
+
+		const Clock::Nanoseconds TickStart = Clock::Now();
+		Finished = 0;
+		for (const std::unique_ptr<MatchClient>& Bot : Bots)
+		{
+			if (Bot->IsFinished())
+			{
+				Finished++;
+				continue;
+			}
+
+			Bot->Tick();
+			BotTicks++;
+		}
+		Busy += Clock::Now() - TickStart;
+	}
+
+	// Both bots of a match must have seen the same final score
+	std::map<uint32_t, std::vector<std::pair<int, int>>> Scores;
+	MatchClientStats Total;
+	for (const std::unique_ptr<MatchClient>& Bot : Bots)
+	{
+		const Game& View = Bot->GetView();
+		if (Bot->IsFinished())
+		{
+			Scores[Bot->GetMatch()].push_back(std::make_pair(View.GetPlayerOneScore(), View.GetPlayerTwoScore()));
+		}
+
+		const MatchClientStats& Stats = Bot->GetStats();
+		Total.SnapshotsReceived += Stats.SnapshotsReceived;
+		Total.StaleSnapshots += Stats.StaleSnapshots;
+		Total.Corrections += Stats.Corrections;
+		Total.TotalCorrection += Stats.TotalCorrection;
+		Total.MaxCorrection = std::max(Total.MaxCorrection, Stats.MaxCorrection);
+		Total.InterpolatedTicks += Stats.InterpolatedTicks;
+		Total.ExtrapolatedTicks += Stats.ExtrapolatedTicks;
+	}
+
+	int Agreed = 0;
+	for (const auto& Match : Scores)
+	{
+		Agreed += (Match.second.size() == 2 && Match.second[0] == Match.second[1]) ? 1 : 0;
+	}
+
+	const double ShownTicks = static_cast<double>(std::max<uint64_t>(Total.InterpolatedTicks + Total.ExtrapolatedTicks, 1));
+	std::cout << "Bots finished: " << Finished << " of " << Options.Bots << " in " << ElapsedSeconds(Start) << "s, "
+		<< Agreed << " matches with both sides agreeing on the score\n";
+	std::cout << "Snapshots: " << Total.SnapshotsReceived << " received, " << Total.StaleSnapshots << " stale\n";
+	std::cout << "Prediction: " << Total.Corrections << " corrections, "
+		<< ((Total.Corrections > 0) ? Total.TotalCorrection / Total.Corrections : 0.0) << " px on average, " << Total.MaxCorrection << " px at most\n";
+	std::cout << "Interpolation: " << 100.0 * Total.ExtrapolatedTicks / ShownTicks << "% of ticks extrapolated past the newest snapshot\n";
+	std::cout << "Client cost: " << ((BotTicks > 0) ? static_cast<double>(Busy) / BotTicks / 1000.0 : 0.0) << " us per bot tick\n";
+
+	return (Finished == Options.Bots && Agreed * 2 == Options.Bots) ? 0 : 1;
+}
+
+int RunSpectators(const ServerOptions& Options)
+{
+	NetAddress Server;
+	if (!NetAddress::Parse(Options.Server, Server))
+	{
+		std::cout << "Invalid server address " << Options.Server << "\n";
+		return -1;
+	}
+
+	struct Spectator
+	{
+		UdpSocket::UniquePtr Socket;
+		uint32_t Match = 0;
+		uint32_t LastSequence = 0;
+	};
+
+	SocketPoller Poller;
+	std::vector<Spectator> Spectators(Options.Spectators);
+	for (int i = 0; i < Options.Spectators; ++i)
+	{
+		Spectators[i].Socket = std::make_unique<UdpSocket>(0);
+		Spectators[i].Socket->SetBufferSizes(SPECTATOR_RECEIVE_BUFFER, SPECTATOR_RECEIVE_BUFFER);
+		Spectators[i].Match = 1 + i % std::max(Options.Watch, 1);
+		Poller.Add(Spectators[i].Socket->GetHandle(), i);
+	}
+
+	std::cout << Options.Spectators << " spectators watching " << Options.Watch << " matches on " << Server.ToString() << "\n";
+
+	const auto SubscribeAll = [&Spectators, &Server]()
+	{
+		uint8_t Buffer[ServerProtocol::MAX_DATAGRAM];
+		for (const Spectator& Watcher : Spectators)
+		{
+			ByteWriter Writer(Buffer, sizeof(Buffer));
+			ServerProtocol::WriteHeader(Writer, ServerProtocol::Message::SUBSCRIBE);
+			ServerProtocol::Write(Writer, ServerProtocol::Subscribe{ Watcher.Match });
+			Watcher.Socket->Send(Server, Buffer, Writer.GetSize());
+		}
+	};
+
+	const Clock::Nanoseconds Start = Clock::Now();
+	Clock::Nanoseconds LastSubscribe = 0;
+	Clock::Nanoseconds LastReport = Start;
+	LatencyHistogram Total(LATENCY_BUCKET, LATENCY_BUCKETS);
+	LatencyHistogram Interval(LATENCY_BUCKET, LATENCY_BUCKETS);
+	uint64_t Gaps = 0;
+	uint64_t IntervalGaps = 0;
+
+	std::vector<SocketPoller::Event> Events;
+	const double Duration = (Options.Duration > 0.0) ? Options.Duration : REPORT_INTERVAL * 6;
+	while (ElapsedSeconds(Start) < Duration)
+	{
+		if (Clock::ToSeconds(Clock::Now() - LastSubscribe) >= SUBSCRIBE_INTERVAL)
+		{
+			SubscribeAll();
+			LastSubscribe = Clock::Now();
+		}
+
+		Poller.Wait(Clock::FromSeconds(0.1), Events);
+		for (const SocketPoller::Event& Signal : Events)
+		{
+			Spectator& Watcher = Spectators[Signal.Token];
+			uint8_t Buffer[ServerProtocol::MAX_DATAGRAM];
+			NetAddress From;
+			int Size = 0;
+			while ((Size = Watcher.Socket->Receive(Buffer, sizeof(Buffer), From)) >= 0)
+			{
+				ByteReader Reader(Buffer, Size);
+				ServerProtocol::Message Type;
+				ServerProtocol::Spectate Frame;
+				if (!ServerProtocol::ReadHeader(Reader, Type) || Type != ServerProtocol::Message::SPECTATE || !ServerProtocol::Read(Reader, Frame))
+				{
+					continue;
+				}
+
+				const Clock::Nanoseconds Latency = Clock::Now() - static_cast<Clock::Nanoseconds>(Frame.Published);
+				Total.Add(Latency);
+				Interval.Add(Latency);
+
+				if (Watcher.LastSequence != 0 && Frame.Sequence > Watcher.LastSequence + 1)
+				{
+					Gaps += Frame.Sequence - Watcher.LastSequence - 1;
+					IntervalGaps += Frame.Sequence - Watcher.LastSequence - 1;
+				}
+				Watcher.LastSequence = std::max(Watcher.LastSequence, Frame.Sequence);
+			}
+		}
+
+		const double SinceReport = ElapsedSeconds(LastReport);
+		if (SinceReport >= REPORT_INTERVAL)
+		{
+			std::cout << "Received " << Interval.GetCount() / SinceReport << " frames/s, latency p50 " << Interval.Percentile(0.5) / 1e6
+				<< " ms p99 " << Interval.Percentile(0.99) / 1e6 << " ms max " << Interval.GetMax() / 1e6 << " ms, "
+				<< IntervalGaps << " frames skipped\n";
+			Interval.Clear();
+			IntervalGaps = 0;
+			LastReport = Clock::Now();
+		}
+	}
+
+	const double Elapsed = ElapsedSeconds(Start);
+	std::cout << "Total: " << Total.GetCount() << " frames in " << Elapsed << "s, " << Total.GetCount() / Elapsed << " frames/s, latency p50 "
+		<< Total.Percentile(0.5) / 1e6 << " ms p99 " << Total.Percentile(0.99) / 1e6 << " ms max " << Total.GetMax() / 1e6 << " ms, "
+		<< 100.0 * Gaps / std::max<uint64_t>(Total.GetCount() + Gaps, 1) << "% of frames skipped\n";
+
+	return (Total.GetCount() > 0) ? 0 : 1;
+}
+
+bool ParseOptions(int argc, char** argv, ServerOptions& Options)
+{
+	for (int i = 1; i < argc; ++i)
+	{
+		const std::string Arg(argv[i]);
+		if (i + 1 >= argc)
+		{
+			std::cout << "Missing value for " << Arg << "\n";
+			return false;
+		}
+
+		const std::string Value(argv[++i]);
+		if (Arg == "--port") Options.Port = static_cast<uint16_t>(std::stoi(Value));
+		else if (Arg == "--matches") Options.Matches = std::stoi(Value);
+		else if (Arg == "--tick-rate") Options.TickRate = std::max(std::stoi(Value), 1);
+		else if (Arg == "--snapshot-interval") Options.SnapshotInterval = std::stoi(Value);
+		else if (Arg == "--duration") Options.Duration = std::stod(Value);
+		else if (Arg == "--win-score") Options.Settings.WinScore = std::stoi(Value);
+		else if (Arg == "--spectator-port") Options.SpectatorPort = static_cast<uint16_t>(std::stoi(Value));
+		else if (Arg == "--max-spectators") Options.MaxSpectators = std::stoi(Value);
+		else if (Arg == "--bots") Options.Bots = std::stoi(Value);
+		else if (Arg == "--spectators") Options.Spectators = std::stoi(Value);
+		else if (Arg == "--watch") Options.Watch = std::max(std::stoi(Value), 1);
+		else if (Arg == "--server") Options.Server = Value;
+		else if (Arg == "--latency") Options.Latency = std::stoi(Value);
+		else if (Arg == "--jitter") Options.Jitter = std::stoi(Value);
+		else if (Arg == "--loss") Options.Loss = std::stoi(Value);
+		else
+		{
+			std::cout << "Unknown option " << Arg << "\n";
+			return false;
+		}
+	}
+
+	return true;
+}
+
+int main(int argc, char** argv)
+{
+	ServerOptions Options;
+	try
+	{
+		if (!ParseOptions(argc, argv, Options))
+		{
+			std::cout << "Usage: PONGServer [--port N] [--matches N] [--tick-rate N] [--snapshot-interval N] [--duration seconds] [--win-score N]\n"
+				<< "                  [--spectator-port N] [--max-spectators N]\n"
+				<< "       PONGServer --bots N [--server ip:port] [--tick-rate N] [--latency ms] [--jitter ms] [--loss percent]\n"
+				<< "       PONGServer --spectators N [--server ip:port] [--watch matches] [--duration seconds]\n";
+			return -1;
+		}
+	} catch (const std::exception& Error)
+	{
+		std::cout << "Invalid option value: " << Error.what() << "\n";
+		return -1;
+	}
+
+	try
+	{
+		if (Options.Spectators > 0)
+		{
+			return RunSpectators(Options);
+		}
+		return (Options.Bots > 0) ? RunBots(Options) : RunServer(Options);
+	} catch (const UdpSocket::Error& Error)
+	{
+		std::cout << Error.what() << "\n";
+		return -1;
+	} catch (const SocketPoller::Error& Error)
+	{
+		std::cout << Error.what() << "\n";
+		return -1;
+	}
+}
@@ -0,0 +1,344 @@
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Game.h"
+#include "MatchSettings.h"
+#include "PaddleController.h"
+#include "pk/Clock.h"
+
+// Parameter sweep: plays headless AI-vs-AI matches for every combination of gameplay
+// parameters on every core and writes rally and duration statistics per configuration.
+
+constexpr int DEFAULT_MATCHES = 16;
+constexpr int DEFAULT_MAX_TICKS = 240 * 60 * 10;
+constexpr float DEFAULT_AI_REACTION_DELAY = 0.15f;
+constexpr float DEFAULT_AI_ERROR = 60.f;
+constexpr double REPORT_INTERVAL = 5.0;
+const std::string DEFAULT_OUTPUT = "sweep_results.csv";
+
+// Values of one swept parameter, in sweep order
+struct SweepAxis
+{
+	std::string Name;
+	std::vector<float> Values;
+};
+
+struct SweepOptions
+{
+	std::vector<SweepAxis> Axes;
+	int Matches = DEFAULT_MATCHES;
+	int MaxTicks = DEFAULT_MAX_TICKS;
+	int Threads = 0;
+	uint32_t Seed = 1;
+	std::string Output = DEFAULT_OUTPUT;
+	float AIReactionDelay = DEFAULT_AI_REACTION_DELAY;
+	float AIError = DEFAULT_AI_ERROR;
+	MatchSettings Settings;
+};
+
+struct ConfigurationResult
+{
+	MatchSettings Settings;
+	int Matches = 0;
+	// Matches stopped by --max-ticks before anyone won
+	int Capped = 0;
+	int PlayerOneWins = 0;
+	double MeanDuration = 0.0;
+	double MedianDuration = 0.0;
+	double P90Duration = 0.0;
+	// Paddle hits per point
+	double MeanRally = 0.0;
+	double MeanLongestRally = 0.0;
+	int LongestRally = 0;
+};
+
+// "value", "first,second,..." or "min:max:count", count values evenly spaced with both ends included
+std::vector<float> ParseValues(const std::string& Text)
+{
+	std::vector<float> Values;
+	if (Text.find(':') != std::string::npos)
+	{
+		std::istringstream Stream(Text);
+		std::string Min, Max, Count;
+		std::getline(Stream, Min, ':');
+		std::getline(Stream, Max, ':');
+		std::getline(Stream, Count);
+
+		const float First = std::stof(Min);
+		const float Last = std::stof(Max);
+		const int Steps = std::max(std::stoi(Count), 1);
+		for (int i = 0; i < Steps; ++i)
+		{
+			Values.push_back((Steps > 1) ? First + (Last - First) * i / (Steps - 1) : First);
+		}
+		return Values;
+	}
+
+	std::istringstream Stream(Text);
+	std::string Value;
+	while (std::getline(Stream, Value, ','))
+	{
+		Values.push_back(std::stof(Value));
+	}
+	return Values;
+}
+
+void ApplyValue(MatchSettings& Settings, const std::string& Name, const float Value)
+{
+	if (Name == "player-speed") Settings.PlayerSpeed = Value;
+	else if (Name == "ball-speed") Settings.BallSpeed = Value;
+	else if (Name == "ball-max-speed") Settings.BallMaxSpeed = Value;
+	else if (Name == "ball-speed-increment") Settings.BallSpeedIncrement = Value;
+	else if (Name == "win-score") Settings.WinScore = static_cast<int>(Value);
+}
+
+size_t CountConfigurations(const SweepOptions& Options)
+{
+	size_t Count = 1;
+	for (const SweepAxis& Axis : Options.Axes)
+	{
+		Count *= Axis.Values.size();
+	}
+	return Count;
+}
+
+// The last axis changes fastest
+MatchSettings GetConfiguration(const SweepOptions& Options, size_t Index)
+{
+	MatchSettings Settings = Options.Settings;
+	for (auto Axis = Options.Axes.rbegin(); Axis != Options.Axes.rend(); ++Axis)
+	{
+		ApplyValue(Settings, Axis->Name, Axis->Values[Index % Axis->Values.size()]);
+		Index /= Axis->Values.size();
+	}
+	return Settings;
+}
+
+// One per worker thread: the game and its controllers are built once and restarted for every match,
+// only speeds and win score change between configurations
+class SweepRunner
+{
+public:
+	SweepRunner(const SweepOptions& _Options)
+		: Options(_Options), Simulation(_Options.Settings),
+			PlayerOne(std::make_shared<AIController>(_Options.AIReactionDelay, _Options.AIError, 0)),
+			PlayerTwo(std::make_shared<AIController>(_Options.AIReactionDelay, _Options.AIError, 0))
+	{
+		Simulation.SetEffectsEnabled(false);
+		Simulation.SetController(true, PlayerOne);
+		Simulation.SetController(false, PlayerTwo);
+		Simulation.Begin();
+		Durations.reserve(Options.Matches);
+	}
+
+	ConfigurationResult Run(const MatchSettings& Settings)
+	{
+		ConfigurationResult Result;
+		Result.Settings = Settings;
+		Simulation.ApplySettings(Settings);
+		Durations.clear();
+
+		int Points = 0, Hits = 0, LongestRallies = 0;
+		const float TickDelta = Simulation.GetTickDelta();
+		for (int Match = 0; Match < Options.Matches; ++Match)
+		{
+			// Same seeds as PONGBatch, a one configuration sweep plays the same matches
+			Simulation.SetSeed(Options.Seed + static_cast<uint32_t>(Match));
+			PlayerOne->Reset(Simulation.GetSeed() * 2 + 1);
+			PlayerTwo->Reset(Simulation.GetSeed() * 2 + 2);
+			Simulation.Restart();
+			Simulation.StartMatch();
+
+			int Tick = 0;
+			for (; Tick < Options.MaxTicks && Simulation.GetState() == GameState::MATCH; ++Tick)
+			{
+				Simulation.Tick(TickDelta);
+			}
+
+			const MatchStats& Stats = Simulation.GetStats();
+			const int Longest = std::max(Stats.LongestRally, Stats.CurrentRally);
+			Points += Stats.Rallies;
+			Hits += Stats.TotalHits;
+			LongestRallies += Longest;
+			Result.LongestRally = std::max(Result.LongestRally, Longest);
+			Result.Capped += (Simulation.GetState() == GameState::MATCH) ? 1 : 0;
+			Result.PlayerOneWins += (Simulation.GetPlayerOneScore() > Simulation.GetPlayerTwoScore()) ? 1 : 0;
+			Durations.push_back(Tick * TickDelta);
+		}
+
+		std::sort(Durations.begin(), Durations.end());
+		Result.Matches = Options.Matches;
+		for (const float Duration : Durations)
+		{
+			Result.MeanDuration += Duration;
+		}
+		Result.MeanDuration /= Durations.size();
+		Result.MedianDuration = Durations[Durations.size() / 2];
+		Result.P90Duration = Durations[std::min(Durations.size() - 1, Durations.size() * 9 / 10)];
+		Result.MeanRally = (Points > 0) ? static_cast<double>(Hits) / Points : 0.0;
+		Result.MeanLongestRally = static_cast<double>(LongestRallies) / Options.Matches;
+		return Result;
+	}
+
+private:
+	const SweepOptions& Options;
+	Game Simulation;
+	std::shared_ptr<AIController> PlayerOne;
+	std::shared_ptr<AIController> PlayerTwo;
+	std::vector<float> Durations;
+};
+
+// Workers pull one configuration at a time, results land in their own slot so no lock is needed
+void RunWorker(const SweepOptions& Options, std::atomic<size_t>& NextConfiguration, std::atomic<size_t>& Done,
+	std::vector<ConfigurationResult>& Results)
+{
+	SweepRunner Runner(Options);
+	while (true)
+	{
+		const size_t Index = NextConfiguration.fetch_add(1);
+		if (Index >= Results.size())
+		{
+			break;
+		}
+
+		Results[Index] = Runner.Run(GetConfiguration(Options, Index));
+		Done.fetch_add(1);
+	}
+}
+
+bool WriteResults(const std::string& Path, const std::vector<ConfigurationResult>& Results)
+{
+	std::ofstream File(Path, std::ios::trunc);
+	if (!File.is_open())
+	{
+		return false;
+	}
+
+	File << "configuration,player_speed,ball_speed,ball_max_speed,ball_speed_increment,win_score,matches,capped,player_one_wins,"
+		<< "mean_duration,median_duration,p90_duration,mean_rally,mean_longest_rally,longest_rally\n";
+	for (size_t i = 0; i < Results.size(); ++i)
+	{
+		const ConfigurationResult& Result = Results[i];
+		const MatchSettings& Settings = Result.Settings;
+		File << i << "," << Settings.PlayerSpeed << "," << Settings.BallSpeed << "," << Settings.BallMaxSpeed << ","
+			<< Settings.BallSpeedIncrement << "," << Settings.WinScore << "," << Result.Matches << "," << Result.Capped << ","
+			<< Result.PlayerOneWins << "," << Result.MeanDuration << "," << Result.MedianDuration << "," << Result.P90Duration << ","
+			<< Result.MeanRally << "," << Result.MeanLongestRally << "," << Result.LongestRally << "\n";
+	}
+	return true;
+}
+
+bool ParseOptions(int argc, char** argv, SweepOptions& Options)
+{
+	for (int i = 1; i < argc; ++i)
+	{
+		const std::string Arg(argv[i]);
+		if (i + 1 >= argc)
+		{
+			std::cout << "Missing value for " << Arg << "\n";
+			return false;
+		}
+
+		const std::string Value(argv[++i]);
+		if (Arg == "--matches") Options.Matches = std::stoi(Value);
+		else if (Arg == "--max-ticks") Options.MaxTicks = std::stoi(Value);
+		else if (Arg == "--threads") Options.Threads = std::stoi(Value);
+		else if (Arg == "--seed") Options.Seed = static_cast<uint32_t>(std::stoul(Value));
+		else if (Arg == "--output") Options.Output = Value;
+		else if (Arg == "--ai-delay") Options.AIReactionDelay = std::stof(Value);
+		else if (Arg == "--ai-error") Options.AIError = std::stof(Value);
+		else if (Arg == "--player-speed" || Arg == "--ball-speed" || Arg == "--ball-max-speed" || Arg == "--ball-speed-increment"
+			|| Arg == "--win-score")
+		{
+			SweepAxis Axis{ Arg.substr(2), ParseValues(Value) };
+			if (Axis.Values.empty())
+			{
+				std::cout << "No values for " << Arg << "\n";
+				return false;
+			}
+			Options.Axes.push_back(Axis);
+		}
+		else
+		{
+			std::cout << "Unknown option " << Arg << "\n";
+			return false;
+		}
+	}
+
+	return Options.Matches > 0;
+}
+
+int main(int argc, char** argv)
+{
+	SweepOptions Options;
+	try
+	{
+		if (!ParseOptions(argc, argv, Options))
+		{
+			std::cout << "Usage: PONGSweep [--player-speed V] [--ball-speed V] [--ball-max-speed V] [--ball-speed-increment V] [--win-score V]\n"
+				<< "                 [--matches N] [--max-ticks N] [--threads N] [--seed N] [--output file.csv]\n"
+				<< "                 [--ai-delay seconds] [--ai-error pixels]\n"
+				<< "V is a value, a list like 300,400,500 or a range min:max:count\n";
+			return -1;
+		}
+	} catch (const std::exception& Error)
+	{
+		std::cout << "Invalid option value: " << Error.what() << "\n";
+		return -1;
+	}
+
+	const int Threads = (Options.Threads > 0) ? Options.Threads : std::max(1u, std::thread::hardware_concurrency());
+	const size_t Configurations = CountConfigurations(Options);
+	std::cout << "Sweeping " << Configurations << " configurations, " << Options.Matches << " matches each, on " << Threads << " threads\n";
+
+	const Clock::Nanoseconds Start = Clock::Now();
+
+	std::vector<ConfigurationResult> Results(Configurations);
+	std::atomic<size_t> NextConfiguration(0);
+	std::atomic<size_t> Done(0);
+	std::vector<std::thread> Workers;
+	Workers.reserve(Threads);
+	for (int i = 0; i < Threads; ++i)
+	{
+		Workers.emplace_back(RunWorker, std::cref(Options), std::ref(NextConfiguration), std::ref(Done), std::ref(Results));
+	}
+
+	Clock::Nanoseconds LastReport = Start;
+	while (Done.load() < Configurations)
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+		const Clock::Nanoseconds Now = Clock::Now();
+		if (static_cast<double>(Now - LastReport) / Clock::NanosecondsPerSecond >= REPORT_INTERVAL)
+		{
+			LastReport = Now;
+			std::cout << "  " << Done.load() << " / " << Configurations << " configurations\n";
+		}
+	}
+
+	for (std::thread& Worker : Workers)
+	{
+		Worker.join();
+	}
+
+	const double Elapsed = static_cast<double>(Clock::Now() - Start) / Clock::NanosecondsPerSecond;
+	const double MatchesPerSecond = (Elapsed > 0.0) ? Configurations * Options.Matches / Elapsed : 0.0;
+	std::cout << "Configurations: " << Configurations << " in " << Elapsed << "s (" << MatchesPerSecond << " matches/s)\n";
+
+	if (!WriteResults(Options.Output, Results))
+	{
+		std::cout << "Unable to write " << Options.Output << "\n";
+		return -1;
+	}
+
+	std::cout << "Results written to " << Options.Output << "\n";
+	return 0;
+}
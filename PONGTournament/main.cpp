@@ -0,0 +1,271 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "MatchSettings.h"
+#include "TournamentHost.h"
+#include "pk/Clock.h"
+
+// Tournament runner: a single elimination bracket of AI players, every match ticked
+// in real time at a fixed rate on per-core shards, winners advancing as soon as they win.
+
+constexpr int DEFAULT_PLAYERS = 512;
+constexpr int DEFAULT_TICK_RATE = 1000;
+// Two minutes at the default rate, AIs good enough can rally forever
+constexpr uint32_t DEFAULT_MAX_TICKS = 1000 * 60 * 2;
+constexpr double REPORT_INTERVAL = 5.0;
+constexpr auto AGGREGATOR_SLEEP = std::chrono::milliseconds(1);
+constexpr float MIN_AI_REACTION_DELAY = 0.05f;
+constexpr float MAX_AI_REACTION_DELAY = 0.3f;
+constexpr float MIN_AI_ERROR = 10.f;
+constexpr float MAX_AI_ERROR = 100.f;
+
+struct TournamentOptions
+{
+	int Players = DEFAULT_PLAYERS;
+	int Shards = 0;
+	int TickRate = DEFAULT_TICK_RATE;
+	uint32_t MaxTicks = DEFAULT_MAX_TICKS;
+	uint32_t Seed = 1;
+	MatchSettings Settings;
+};
+
+// Match ids are Round * Players + Slot, the two entrants of a slot come from slots 2 * Slot and 2 * Slot + 1 of the round before
+class Bracket
+{
+public:
+	Bracket(const TournamentOptions& _Options)
+		: Options(_Options), Profiles(_Options.Players), Played(0), Champion(-1)
+	{
+		std::mt19937 Random(Options.Seed);
+		std::uniform_real_distribution<float> Delay(MIN_AI_REACTION_DELAY, MAX_AI_REACTION_DELAY);
+		std::uniform_real_distribution<float> Error(MIN_AI_ERROR, MAX_AI_ERROR);
+		for (AIProfile& Profile : Profiles)
+		{
+			Profile.ReactionDelay = Delay(Random);
+			Profile.Error = Error(Random);
+			Profile.Seed = Random();
+		}
+
+		for (int Size = Options.Players; Size > 1; Size /= 2)
+		{
+			Entrants.push_back(std::vector<int>(Size, -1));
+		}
+		for (int i = 0; i < Options.Players; ++i)
+		{
+			Entrants[0][i] = i;
+		}
+	}
+
+	void Start(TournamentHost& Host)
+	{
+		for (int Slot = 0; Slot < Options.Players / 2; ++Slot)
+		{
+			Schedule(Host, 0, Slot);
+		}
+	}
+
+	void OnResult(TournamentHost& Host, const TournamentResult& Result)
+	{
+		const int Round = static_cast<int>(Result.Id) / Options.Players;
+		const int Slot = static_cast<int>(Result.Id) % Options.Players;
+		const int Winner = (Result.PlayerTwoScore > Result.PlayerOneScore) ? Entrants[Round][Slot * 2 + 1] : Entrants[Round][Slot * 2];
+		Played++;
+
+		// Only a match stopped at --max-ticks can end level, player one goes through
+		if (Result.PlayerOneScore == Result.PlayerTwoScore)
+		{
+			std::cout << "Match " << Result.Id << " tied " << Result.PlayerOneScore << " - " << Result.PlayerTwoScore << " after "
+				<< Result.Ticks << " ticks, player " << Winner << " advances as player one\n";
+		}
+
+		if (Round + 1 == static_cast<int>(Entrants.size()))
+		{
+			Champion = Winner;
+			return;
+		}
+
+		std::vector<int>& Next = Entrants[Round + 1];
+		Next[Slot] = Winner;
+		if (Next[Slot ^ 1] >= 0)
+		{
+			Schedule(Host, Round + 1, Slot / 2);
+		}
+	}
+
+	bool IsOver() const
+	{
+		return Champion >= 0;
+	}
+
+	int GetChampion() const
+	{
+		return Champion;
+	}
+
+	int GetPlayed() const
+	{
+		return Played;
+	}
+
+	const AIProfile& GetProfile(const int Player) const
+	{
+		return Profiles[Player];
+	}
+
+private:
+	void Schedule(TournamentHost& Host, const int Round, const int Slot)
+	{
+		TournamentMatch Match;
+		Match.Id = static_cast<uint32_t>(Round * Options.Players + Slot);
+		Match.Seed = Options.Seed + Match.Id;
+		Match.PlayerOne = Profiles[Entrants[Round][Slot * 2]];
+		Match.PlayerTwo = Profiles[Entrants[Round][Slot * 2 + 1]];
+		Host.Schedule(Match);
+	}
+
+	const TournamentOptions& Options;
+	std::vector<AIProfile> Profiles;
+	std::vector<std::vector<int>> Entrants;
+	int Played;
+	int Champion;
+};
+
+struct ShardSummary
+{
+	Clock::Nanoseconds WorstP99 = 0;
+	Clock::Nanoseconds Max = 0;
+	uint64_t Ticks = 0;
+	uint64_t Overruns = 0;
+};
+
+bool ParseOptions(int argc, char** argv, TournamentOptions& Options)
+{
+	for (int i = 1; i < argc; ++i)
+	{
+		const std::string Arg(argv[i]);
+		if (i + 1 >= argc)
+		{
+			std::cout << "Missing value for " << Arg << "\n";
+			return false;
+		}
+
+		const std::string Value(argv[++i]);
+		if (Arg == "--players") Options.Players = std::stoi(Value);
+		else if (Arg == "--shards") Options.Shards = std::stoi(Value);
+		else if (Arg == "--tick-rate") Options.TickRate = std::stoi(Value);
+		else if (Arg == "--max-ticks") Options.MaxTicks = static_cast<uint32_t>(std::stoul(Value));
+		else if (Arg == "--seed") Options.Seed = static_cast<uint32_t>(std::stoul(Value));
+		else if (Arg == "--win-score") Options.Settings.WinScore = std::stoi(Value);
+		else
+		{
+			std::cout << "Unknown option " << Arg << "\n";
+			return false;
+		}
+	}
+
+	if (Options.Players < 2 || (Options.Players & (Options.Players - 1)) != 0)
+	{
+		std::cout << "--players must be a power of two\n";
+		return false;
+	}
+
+	return Options.TickRate > 0;
+}
+
+int main(int argc, char** argv)
+{
+	TournamentOptions Options;
+	try
+	{
+		if (!ParseOptions(argc, argv, Options))
+		{
+			std::cout << "Usage: PONGTournament [--players N] [--shards N] [--tick-rate N] [--max-ticks N] [--seed N] [--win-score N]\n";
+			return -1;
+		}
+	} catch (const std::exception& Error)
+	{
+		std::cout << "Invalid option value: " << Error.what() << "\n";
+		return -1;
+	}
+
+	const int Shards = (Options.Shards > 0) ? Options.Shards : std::max(1u, std::thread::hardware_concurrency());
+
+	Bracket Tournament(Options);
+	std::vector<ShardSummary> Summaries(Shards);
+	std::vector<TournamentResult> Results;
+	std::vector<ShardReport> Reports;
+
+	const Clock::Nanoseconds Start = Clock::Now();
+	Clock::Nanoseconds LastReport = Start;
+	{
+		TournamentHost Host(Options.Settings, Shards, Options.TickRate, Options.MaxTicks);
+		std::cout << "Tournament of " << Options.Players << " players on " << Host.GetShards() << " shards at "
+			<< Host.GetTickRate() << " ticks/s\n";
+
+		Tournament.Start(Host);
+		while (!Tournament.IsOver())
+		{
+			std::this_thread::sleep_for(AGGREGATOR_SLEEP);
+
+			Host.Update(Results, Reports);
+			for (const TournamentResult& Result : Results)
+			{
+				Tournament.OnResult(Host, Result);
+			}
+			Results.clear();
+
+			for (const ShardReport& Report : Reports)
+			{
+				ShardSummary& Summary = Summaries[Report.Shard];
+				Summary.WorstP99 = std::max(Summary.WorstP99, Report.P99);
+				Summary.Max = std::max(Summary.Max, Report.Max);
+				Summary.Ticks = Report.Ticks;
+				Summary.Overruns = Report.Overruns;
+			}
+
+			const Clock::Nanoseconds Now = Clock::Now();
+			if (static_cast<double>(Now - LastReport) / Clock::NanosecondsPerSecond >= REPORT_INTERVAL)
+			{
+				LastReport = Now;
+				std::cout << "Played " << Tournament.GetPlayed() << ", " << Host.GetPending() << " running\n";
+				for (const ShardReport& Report : Reports)
+				{
+					std::cout << "  shard " << Report.Shard << ": " << Report.Matches << " matches, tick p50 " << Report.Median / 1e3
+						<< " us p99 " << Report.P99 / 1e3 << " us max " << Report.Max / 1e3 << " us, " << Report.Overruns << " overruns so far\n";
+				}
+			}
+
+			// Only the newest report of each shard is printed
+			if (Reports.size() > static_cast<size_t>(Shards))
+			{
+				Reports.erase(Reports.begin(), Reports.end() - Shards);
+			}
+		}
+	}
+
+	const double Elapsed = static_cast<double>(Clock::Now() - Start) / Clock::NanosecondsPerSecond;
+	const AIProfile& Champion = Tournament.GetProfile(Tournament.GetChampion());
+	std::cout << "Champion: player " << Tournament.GetChampion() << " (reaction " << Champion.ReactionDelay << "s, error "
+		<< Champion.Error << "px)\n";
+	std::cout << "Matches: " << Tournament.GetPlayed() << " in " << Elapsed << "s\n";
+
+	uint64_t Ticks = 0, Overruns = 0;
+	for (size_t i = 0; i < Summaries.size(); ++i)
+	{
+		const ShardSummary& Summary = Summaries[i];
+		std::cout << "  shard " << i << ": worst p99 " << Summary.WorstP99 / 1e3 << " us, max " << Summary.Max / 1e3 << " us, "
+			<< Summary.Overruns << " overruns in " << Summary.Ticks << " ticks\n";
+		Ticks += Summary.Ticks;
+		Overruns += Summary.Overruns;
+	}
+
+	const double OverrunRatio = (Ticks > 0) ? static_cast<double>(Overruns) / Ticks : 0.0;
+	std::cout << "Overruns: " << OverrunRatio * 100.0 << "% of ticks missed the " << 1e6 / Options.TickRate << " us budget\n";
+	return 0;
+}